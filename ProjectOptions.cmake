@@ -122,6 +122,15 @@ macro(sail_setup_options)
   endif()
 
   option(sail_BUILD_FUZZ_TESTS "Enable fuzz testing executable" ${DEFAULT_FUZZER})
+  option(sail_BUILD_BENCHMARKS "Build the benchmarks of sail's own command line overhead" ON)
+
+  if(NOT MSVC AND NOT APPLE AND NOT BUILD_SHARED_LIBS)
+    set(DEFAULT_STATIC_RUNTIME ON)
+  else()
+    set(DEFAULT_STATIC_RUNTIME OFF)
+  endif()
+  option(sail_ENABLE_STATIC_RUNTIME "Link libstdc++ and libgcc into sail statically, which shortens its startup"
+         ${DEFAULT_STATIC_RUNTIME})
 
 endmacro()
 
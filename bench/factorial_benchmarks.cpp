@@ -0,0 +1,101 @@
+// Benchmarks of the factorial helpers of the sample library: the batched table lookup against the
+// multiplication loop it replaces, over the same inputs. The results are written in the format of
+// `sail bench`, so that they can be kept and compared like those of sail_benchmarks.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fmt/format.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include <sail/sample_library.hpp>
+
+#include "bench_runner.hpp"
+
+namespace {
+
+// What factorial(int) used to do, widened to 64 bits so that it computes the same values
+[[nodiscard]] std::uint64_t factorial_loop(int input) noexcept {
+  if (input < 0 || input >= static_cast<int>(factorial_table_size)) {
+    return 0;
+  }
+  std::uint64_t result = 1;
+  for (auto factor = static_cast<std::uint64_t>(input); factor > 1; --factor) {
+    result *= factor;
+  }
+  return result;
+}
+
+// Time `body` `runs` times after `warmup` untimed calls, in nanoseconds per element of `count`
+template<typename Body> std::vector<double> time_per_element(unsigned warmup, unsigned runs, std::size_t count, Body body) {
+  std::vector<double> samples;
+  for (unsigned run = 0; run < warmup + runs; ++run) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (run >= warmup) {
+      samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(count));
+    }
+  }
+  return samples;
+}
+
+}// namespace
+
+// NOLINTNEXTLINE(bugprone-exception-escape)
+int main(int argc, const char** argv) {
+  CLI::App app{ "Benchmarks of the sample library's factorial helpers" };
+  unsigned warmup = 3;
+  unsigned runs = 50;
+  std::size_t count = 1U << 16U;
+  std::filesystem::path output;
+  app.add_option("--warmup", warmup, "Untimed runs before each benchmark");
+  app.add_option("--runs", runs, "Timed runs of each benchmark")->check(CLI::PositiveNumber);
+  app.add_option("--count", count, "Inputs per run")->check(CLI::PositiveNumber);
+  app.add_option("--output", output, "Write the results to this JSON file");
+  CLI11_PARSE(app, argc, argv);
+
+  try {
+    // Inputs over the whole table and a little past it, in no order the branch predictor could learn
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(-2, static_cast<int>(factorial_table_size) + 2);
+    std::vector<int> inputs(count);
+    for (auto& input : inputs) {
+      input = distribution(generator);
+    }
+    std::vector<std::uint64_t> looped(count);
+    std::vector<std::uint64_t> looked_up(count);
+
+    std::vector<BenchResult> results;
+    const auto record = [&](const std::string& name, std::vector<double> samples) {
+      BenchResult result{ name, summarize_samples(samples), std::move(samples) };
+      fmt::print("{:<28} {:>12} +/- {:<12} per factorial\n", name, format_nanoseconds(result.statistics.mean),
+        format_nanoseconds(result.statistics.ci_high - result.statistics.mean));
+      results.push_back(std::move(result));
+    };
+    record("factorial loop", time_per_element(warmup, runs, count, [&]() {
+      for (std::size_t index = 0; index < count; ++index) {
+        looped[index] = factorial_loop(inputs[index]);
+      }
+    }));
+    record("factorial table, batched", time_per_element(warmup, runs, count, [&]() { factorial(inputs, looked_up); }));
+
+    if (looped != looked_up) {
+      fmt::print("Error: the table lookup and the loop disagree\n");
+      return EXIT_FAILURE;
+    }
+    if (!output.empty()) {
+      write_bench_results(std::filesystem::absolute(output), results);
+    }
+    return EXIT_SUCCESS;
+  } catch (const std::exception& e) {
+    fmt::print("Error: {}\n", e.what());
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,198 @@
+// Benchmarks of sail's own overhead: process startup, no-op builds, root discovery and manifest
+// parsing. The results are written in the format of `sail bench`, so that a baseline saved by an
+// earlier run can be compared with --baseline, and a regression fails the run.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include "bench_runner.hpp"
+#include "manifest.hpp"
+#include "process.hpp"
+#include "project_root.hpp"
+#include "toml.hpp"
+
+namespace {
+
+struct Settings
+{
+  std::filesystem::path sail;
+  std::filesystem::path work_dir;
+  unsigned warmup = 3;
+  unsigned runs = 20;
+};
+
+void write_text(const std::filesystem::path& path, const std::string& content) {
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream file(path, std::ios::binary);
+  file << content;
+}
+
+// Time `body` `runs` times after `warmup` untimed calls; `prepare` runs untimed before each call
+std::vector<double> time_runs(const Settings& settings, const std::function<void()>& body,
+                              const std::function<void()>& prepare = {}) {
+  std::vector<double> samples;
+  for (unsigned run = 0; run < settings.warmup + settings.runs; ++run) {
+    if (prepare) {
+      prepare();
+    }
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (run >= settings.warmup) {
+      samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count());
+    }
+  }
+  return samples;
+}
+
+// Run sail in `directory`; sail finds the project from the working directory, which children inherit
+void run_sail(const Settings& settings, const std::filesystem::path& directory, const std::vector<std::string>& args) {
+  std::filesystem::current_path(directory);
+  std::vector<std::string> command = { settings.sail.string() };
+  command.insert(command.end(), args.begin(), args.end());
+  const ProcessResult result = run_process(command, ProcessOptions{ ProcessOutput::Capture });
+  if (!result.success()) {
+    throw std::runtime_error(fmt::format("`{}` failed with exit code {}: {}{}", format_command(command), result.exit_code,
+      result.error, result.output));
+  }
+}
+
+// A project with one source, already built, so that every further `sail build` has nothing to do
+std::filesystem::path make_built_project(const Settings& settings, const std::string& name, const std::string& engine) {
+  const std::filesystem::path project = settings.work_dir / name;
+  write_text(project / "Sail.toml", fmt::format("[project]\nname = \"{}\"\nversion = \"0.1.0\"\n\n[dependencies]\n\n"
+                                                "[build]\nengine = \"{}\"\n", name, engine));
+  write_text(project / "src" / "main.cpp", "int main() { return 0; }\n");
+  run_sail(settings, project, { "build" });
+  return project;
+}
+
+// A manifest with `count` dependencies, an even mix of registry versions, git and path dependencies
+std::string synthetic_manifest(unsigned count) {
+  std::string manifest = "[project]\nname = \"many\"\nversion = \"0.1.0\"\n\n[dependencies]\n";
+  for (unsigned i = 0; i < count; ++i) {
+    switch (i % 3) {
+    case 0: manifest += fmt::format("dep_{} = \"1.2.{}\"\n", i, i); break;
+    case 1: manifest += fmt::format("dep_{} = {{ git = \"https://example.com/dep_{}.git\", tag = \"v1.{}\" }}\n", i, i, i); break;
+    default: manifest += fmt::format("dep_{} = {{ path = \"../dep_{}\", targets = [\"dep_{}::dep_{}\"] }}\n", i, i, i, i); break;
+    }
+  }
+  return manifest;
+}
+
+}// namespace
+
+// NOLINTNEXTLINE(bugprone-exception-escape)
+int main(int argc, const char** argv) {
+  CLI::App app{ "Benchmarks of sail's own command line overhead" };
+  Settings settings;
+  std::filesystem::path output;
+  std::filesystem::path baseline_path;
+  app.add_option("--sail", settings.sail, "The sail executable to measure")->required()->check(CLI::ExistingFile);
+  app.add_option("--work-dir", settings.work_dir, "Scratch directory for the generated projects (emptied first)");
+  app.add_option("--warmup", settings.warmup, "Untimed runs before each benchmark");
+  app.add_option("--runs", settings.runs, "Timed runs of each benchmark")->check(CLI::PositiveNumber);
+  app.add_option("--output", output, "Write the results to this JSON file");
+  app.add_option("--baseline", baseline_path, "Compare against results written by an earlier --output; fails on regressions");
+  CLI11_PARSE(app, argc, argv);
+
+  try {
+    settings.sail = std::filesystem::absolute(settings.sail);
+    if (settings.work_dir.empty()) {
+      settings.work_dir = std::filesystem::temp_directory_path() / "sail_benchmarks";
+    }
+    settings.work_dir = std::filesystem::absolute(settings.work_dir);
+    std::filesystem::remove_all(settings.work_dir);
+    std::filesystem::create_directories(settings.work_dir);
+
+    std::vector<BenchResult> results;
+    const auto record = [&](const std::string& name, std::vector<double> samples) {
+      BenchResult result{ name, summarize_samples(samples), std::move(samples) };
+      fmt::print("{:<36} {:>12} +/- {:<12} median {:>12}  ({} outlier(s))\n", name, format_nanoseconds(result.statistics.mean),
+        format_nanoseconds(result.statistics.ci_high - result.statistics.mean), format_nanoseconds(result.statistics.median),
+        result.statistics.outliers);
+      results.push_back(std::move(result));
+    };
+
+    // Startup alone: the command line is parsed and nothing else happens
+    record("startup --version", time_runs(settings, [&]() { run_sail(settings, settings.work_dir, { "--version" }); }));
+
+    // A no-op native build is sail's own overhead end to end. Cold runs drop the parsed manifest
+    // kept in target/manifest.cache first; warm runs find everything in place.
+    const std::filesystem::path native_project = make_built_project(settings, "noop_native", "native");
+    record("build no-op native (cold)", time_runs(settings, [&]() { run_sail(settings, native_project, { "build" }); },
+      [&]() { std::filesystem::remove(native_project / "target" / "manifest.cache"); }));
+    record("build no-op native (warm)", time_runs(settings, [&]() { run_sail(settings, native_project, { "build" }); }));
+
+    // With the CMake engine the no-op also includes cmake --build checking the tree
+    const std::filesystem::path cmake_project = make_built_project(settings, "noop_cmake", "cmake");
+    record("build no-op cmake (warm)", time_runs(settings, [&]() { run_sail(settings, cmake_project, { "build" }); }));
+
+    // Walking up from deep inside a project, as editor integrations do
+    const std::filesystem::path deep_dir = native_project / "src" / "a" / "b" / "c" / "d" / "e" / "f" / "g" / "h";
+    std::filesystem::create_directories(deep_dir);
+    record("root discovery, 9 levels deep", time_runs(settings, [&]() {
+      if (!find_project_root(deep_dir)) {
+        throw std::runtime_error("the project root was not found");
+      }
+    }));
+
+    // The manifest of a very large project, parsed from scratch and loaded from target/manifest.cache
+    const std::string manifest_text = synthetic_manifest(1000);
+    const std::filesystem::path many_project = settings.work_dir / "many_dependencies";
+    write_text(many_project / "Sail.toml", manifest_text);
+    record("manifest parse, 1000 dependencies", time_runs(settings, [&]() {
+      if (manifest_from_toml(parse_toml(manifest_text)).dependencies.size() != 1000) {
+        throw std::runtime_error("the synthetic manifest did not list 1000 dependencies");
+      }
+    }));
+    record("manifest load cached, 1000 deps", time_runs(settings, [&]() {
+      static_cast<void>(load_manifest(many_project));
+    }));
+
+    std::filesystem::current_path(settings.work_dir.parent_path());
+    if (!output.empty()) {
+      write_bench_results(std::filesystem::absolute(output), results);
+    }
+
+    if (baseline_path.empty()) {
+      return EXIT_SUCCESS;
+    }
+    if (!std::filesystem::exists(baseline_path)) {
+      fmt::print("Warning: no baseline at {}; nothing to compare against\n", baseline_path.string());
+      return EXIT_SUCCESS;
+    }
+    size_t regressed = 0;
+    for (const auto& base : read_bench_results(baseline_path)) {
+      const auto current = std::find_if(results.begin(), results.end(), [&](const BenchResult& result) { return result.name == base.name; });
+      if (current == results.end()) {
+        continue;
+      }
+      const BenchComparison comparison = compare_to_baseline(base.statistics, current->statistics, 0.05);
+      const char* verdict = comparison.verdict == BenchVerdict::Regressed ? "REGRESSED"
+        : comparison.verdict == BenchVerdict::Improved ? "improved" : "no change";
+      fmt::print("{:<36} {:+.2f}% (95% CI {:+.2f}% .. {:+.2f}%) {}\n", base.name, comparison.change * 100, comparison.ci_low * 100,
+        comparison.ci_high * 100, verdict);
+      regressed += comparison.verdict == BenchVerdict::Regressed ? 1 : 0;
+    }
+    if (regressed > 0) {
+      fmt::print("Error: {} benchmark(s) regressed against {}\n", regressed, baseline_path.string());
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  } catch (const std::exception& e) {
+    fmt::print("Error: {}\n", e.what());
+    return EXIT_FAILURE;
+  }
+}
@@ -2,6 +2,9 @@
 #include <cstdint>
 #include <fmt/base.h>
 #include <iterator>
+#include <vector>
+
+#include <sail/sample_library.hpp>
 
 [[nodiscard]] auto sum_values(const uint8_t *Data, size_t Size)
 {
@@ -14,10 +17,28 @@
   return value;
 }
 
+// Every factorial variant has to agree on every input, including the ones that do not fit
+void check_factorials(const uint8_t *Data, size_t Size)
+{
+  std::vector<int> inputs;
+  for (std::size_t offset = 0; offset < Size; ++offset) {
+    inputs.push_back(static_cast<int>(static_cast<int8_t>(*std::next(Data, static_cast<long>(offset)))));
+  }
+  std::vector<uint64_t> results(inputs.size());
+  factorial(inputs, results);
+  for (std::size_t index = 0; index < inputs.size(); ++index) {
+    if (results[index] != factorial_checked(inputs[index]).value_or(0)
+        || (factorial(inputs[index]) != 0 && static_cast<uint64_t>(factorial(inputs[index])) != results[index])) {
+      __builtin_trap();
+    }
+  }
+}
+
 // Fuzzer that attempts to invoke undefined behavior for signed integer overflow
 // cppcheck-suppress unusedFunction symbolName=LLVMFuzzerTestOneInput
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size)
 {
   fmt::print("Value sum: {}, len{}\n", sum_values(Data, Size), Size);
+  check_factorials(Data, Size);
   return 0;
 }
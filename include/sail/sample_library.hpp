@@ -3,13 +3,62 @@
 
 #include <sail/sample_library_export.hpp>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+// 0! through 20!; 21! is the first factorial that does not fit in std::uint64_t
+inline constexpr std::size_t factorial_table_size = 21;
+
+[[nodiscard]] constexpr std::array<std::uint64_t, factorial_table_size> make_factorial_table() noexcept
+{
+  std::array<std::uint64_t, factorial_table_size> table{};
+  table[0] = 1;
+  for (std::size_t input = 1; input < table.size(); ++input) { table[input] = table[input - 1] * input; }
+  return table;
+}
+
+// Computed once at compile time, so that the hot path is a single load
+inline constexpr std::array<std::uint64_t, factorial_table_size> factorial_table = make_factorial_table();
+
+// input!, or 0 if input is negative or input! does not fit in int (past 12!)
 [[nodiscard]] SAMPLE_LIBRARY_EXPORT int factorial(int) noexcept;
 
-[[nodiscard]] constexpr int factorial_constexpr(int input) noexcept
+// results[i] = inputs[i]!, or 0 if inputs[i] is negative or its factorial does not fit (past 20!).
+// Only the first min(inputs.size(), results.size()) results are written. The loop is a branchless
+// table lookup, which compilers turn into vector gathers where the target has them.
+SAMPLE_LIBRARY_EXPORT void factorial(std::span<const int> inputs, std::span<std::uint64_t> results) noexcept;
+
+// input!, or std::nullopt if input is negative or input! does not fit in std::uint64_t
+[[nodiscard]] constexpr std::optional<std::uint64_t> factorial_checked(int input) noexcept
 {
-  if (input == 0) { return 1; }
+  if (input < 0 || static_cast<std::size_t>(input) >= factorial_table.size()) { return std::nullopt; }
+  return factorial_table[static_cast<std::size_t>(input)];
+}
+
+#ifdef __SIZEOF_INT128__
+// GCC and Clang provide 128-bit integers as an extension; 34! is the largest factorial they hold
+__extension__ using factorial_uint128 = unsigned __int128;
+
+// input! in 128 bits, or std::nullopt if input is negative or past 34!
+[[nodiscard]] constexpr std::optional<factorial_uint128> factorial_checked_wide(int input) noexcept
+{
+  constexpr int largest = 34;
+  if (input < 0 || input > largest) { return std::nullopt; }
+  factorial_uint128 result = 1;
+  for (int factor = 2; factor <= input; ++factor) { result *= static_cast<factorial_uint128>(factor); }
+  return result;
+}
+#endif
 
-  return input * factorial_constexpr(input - 1);
+// input!, or 0 if input is negative or input! does not fit in int (past 12!), like factorial(int)
+[[nodiscard]] constexpr int factorial_constexpr(int input) noexcept
+{
+  constexpr int largest = 12;
+  if (input < 0 || input > largest) { return 0; }
+  return static_cast<int>(factorial_table[static_cast<std::size_t>(input)]);
 }
 
 #endif
@@ -0,0 +1,306 @@
+#include "artifacts.hpp"
+#include "process.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+
+namespace {
+
+// Bump whenever the artifact layout or the way artifacts are built changes
+constexpr std::string_view artifact_format = "sail-artifact-1";
+
+// Lists the CMake packages of an artifact, one per line; its presence marks a complete artifact
+constexpr std::string_view packages_file = "sail-packages.txt";
+
+std::string unique_suffix() {
+  std::random_device random;
+  return fmt::format("{:08x}", random());
+}
+
+// Run a command with its output kept off the terminal; true if it succeeded
+bool run_quietly(const std::vector<std::string>& command) {
+  return run_process(command, ProcessOptions{ ProcessOutput::Capture }).success();
+}
+
+// Compiler identity as reported by the compiler itself, so upgrades invalidate artifacts
+std::string compiler_identity() {
+  std::string compiler = get_env("CXX");
+  if (compiler.empty()) {
+    compiler = "c++";
+  }
+  return compiler + "\n" + run_capture({ compiler, "--version" }, std::chrono::seconds(30)).value_or("");
+}
+
+// The profile's flags for the compiler `compiler_identity()` reported
+ProfileFlags artifact_profile_flags(const ArtifactBuildRequest& request, const std::string& compiler) {
+  const bool clang = compiler.find("clang") != std::string::npos;
+  return profile_flags(request.profile, request.pgo, request.pgo_dir, clang, request.build_mode == "Release");
+}
+
+std::string artifact_key(const ResolvedDependency& dependency, const ArtifactBuildRequest& request,
+                         const std::string& compiler, const ProfileFlags& flags, const std::vector<std::string>& earlier_keys) {
+  uint64_t hash = fnv1a_hash(artifact_format);
+  hash = fnv1a_hash(dependency.commit, hash);
+  hash = fnv1a_hash(request.build_mode, hash);
+  hash = fnv1a_hash(compiler, hash);
+  for (const auto& flag : flags.compile) {
+    hash = fnv1a_hash("compile " + flag + "\n", hash);
+  }
+  for (const auto& flag : flags.link) {
+    hash = fnv1a_hash("link " + flag + "\n", hash);
+  }
+  for (const auto& [option, value] : dependency.options) {
+    hash = fnv1a_hash(option + "=" + value + "\n", hash);
+  }
+  for (const char* variable : { "CC", "CFLAGS", "CXXFLAGS", "LDFLAGS", "CMAKE_TOOLCHAIN_FILE" }) {
+    hash = fnv1a_hash(fmt::format("{}={}\n", variable, get_env(variable)), hash);
+  }
+  // Dependencies found through earlier artifacts are part of the binaries
+  for (const auto& key : earlier_keys) {
+    hash = fnv1a_hash(key, hash);
+  }
+  return fmt::format("{}-{:016x}", dependency.name, hash);
+}
+
+std::vector<std::string> read_packages(const std::filesystem::path& artifact_dir) {
+  std::vector<std::string> packages;
+  const auto content = read_file(artifact_dir / packages_file);
+  if (!content) {
+    return packages;
+  }
+  std::istringstream lines(*content);
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (!line.empty()) {
+      packages.push_back(line);
+    }
+  }
+  return packages;
+}
+
+// Names of the CMake config packages an install tree provides, e.g. fmt from lib/cmake/fmt/fmt-config.cmake
+std::vector<std::string> find_installed_packages(const std::filesystem::path& install_dir) {
+  std::vector<std::string> packages;
+  std::error_code error;
+  for (auto it = std::filesystem::recursive_directory_iterator(install_dir, error);
+       !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+    if (it.depth() > 4 || !it->is_regular_file()) {
+      continue;
+    }
+    const std::string filename = it->path().filename().string();
+    for (const std::string_view suffix : { "Config.cmake", "-config.cmake" }) {
+      if (filename.size() > suffix.size() && filename.compare(filename.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        packages.push_back(filename.substr(0, filename.size() - suffix.size()));
+      }
+    }
+  }
+  std::sort(packages.begin(), packages.end());
+  packages.erase(std::unique(packages.begin(), packages.end()), packages.end());
+  return packages;
+}
+
+// Move a finished artifact into the cache. Returns false if it is not there afterwards.
+bool publish_artifact(const std::filesystem::path& staged_dir, const std::filesystem::path& artifact_dir) {
+  std::error_code error;
+  std::filesystem::rename(staged_dir, artifact_dir, error);
+  if (error) {
+    // Another sail process finished the same artifact first
+    std::filesystem::remove_all(staged_dir, error);
+  }
+  return std::filesystem::exists(artifact_dir / packages_file);
+}
+
+// `variable` from the environment, which CMake starts its flags from, followed by `flags`
+std::string flags_over_environment(const char* variable, const std::vector<std::string>& flags) {
+  std::string combined = get_env(variable);
+  for (const auto& flag : flags) {
+    combined += (combined.empty() ? "" : " ") + flag;
+  }
+  return combined;
+}
+
+// Configure, build and install the dependency into the cache
+bool build_artifact(const ResolvedDependency& dependency, const ArtifactBuildRequest& request, const ProfileFlags& flags,
+                    const std::vector<std::filesystem::path>& prefix_path, const std::filesystem::path& artifact_dir,
+                    const std::filesystem::path& scratch_dir) {
+  fmt::print("Building {} ({}, cached for other projects)\n", dependency.name, request.build_mode);
+
+  const std::filesystem::path build_dir = scratch_dir / "build";
+  const std::filesystem::path install_dir = scratch_dir / "install";
+  std::string prefixes;
+  for (const auto& prefix : prefix_path) {
+    prefixes += (prefixes.empty() ? "" : ";") + prefix.generic_string();
+  }
+
+  // Configured for the final location, so any absolute paths in the install tree point into the cache
+  std::vector<std::string> configure_cmd = { "cmake" };
+  if (!request.generator.empty()) {
+    configure_cmd.insert(configure_cmd.end(), { "-G", request.generator });
+  }
+  configure_cmd.push_back("-DCMAKE_BUILD_TYPE=" + request.build_mode);
+  configure_cmd.push_back("-DCMAKE_INSTALL_PREFIX=" + artifact_dir.generic_string());
+  configure_cmd.push_back("-DCMAKE_PREFIX_PATH=" + prefixes);
+  if (!request.compiler_launcher.empty()) {
+    configure_cmd.push_back("-DCMAKE_CXX_COMPILER_LAUNCHER=" + request.compiler_launcher);
+  }
+  // Sanitizers, hardening and the rest of the profile have to reach the dependency's binaries too
+  if (!flags.compile.empty()) {
+    configure_cmd.push_back("-DCMAKE_C_FLAGS=" + flags_over_environment("CFLAGS", flags.compile));
+    configure_cmd.push_back("-DCMAKE_CXX_FLAGS=" + flags_over_environment("CXXFLAGS", flags.compile));
+  }
+  if (!flags.link.empty()) {
+    const std::string link_flags = flags_over_environment("LDFLAGS", flags.link);
+    for (const char* variable : { "CMAKE_EXE_LINKER_FLAGS", "CMAKE_SHARED_LINKER_FLAGS", "CMAKE_MODULE_LINKER_FLAGS" }) {
+      configure_cmd.push_back(fmt::format("-D{}={}", variable, link_flags));
+    }
+  }
+  for (const auto& [option, value] : dependency.options) {
+    configure_cmd.push_back(fmt::format("-D{}={}", option, value));
+  }
+  configure_cmd.insert(configure_cmd.end(), { "-S", dependency.source_dir.string(), "-B", build_dir.string() });
+
+  const std::vector<std::string> build_cmd = { "cmake", "--build", build_dir.string(), "--config", request.build_mode,
+    "--parallel", std::to_string(request.jobs) };
+  const std::vector<std::string> install_cmd = { "cmake", "--install", build_dir.string(), "--config", request.build_mode,
+    "--prefix", install_dir.string() };
+
+  for (const auto& command : { configure_cmd, build_cmd, install_cmd }) {
+    if (!run_quietly(command)) {
+      return false;
+    }
+  }
+
+  // Installs without a CMake package are still recorded, so the build is not attempted every time
+  std::filesystem::create_directories(install_dir);
+  std::string packages;
+  for (const auto& package : find_installed_packages(install_dir)) {
+    packages += package + "\n";
+  }
+  write_file_if_changed(install_dir / packages_file, packages);
+  return publish_artifact(install_dir, artifact_dir);
+}
+
+std::string remote_url(const std::string& remote, const std::string& key) {
+  const std::string_view base = std::string_view(remote).substr(0, remote.find_last_not_of('/') + 1);
+  return fmt::format("{}/{}.tar.gz", base, key);
+}
+
+bool is_s3(const std::string& url) {
+  return url.compare(0, 5, "s3://") == 0;
+}
+
+bool download_artifact(const std::string& remote, const std::string& key, const std::filesystem::path& artifact_dir,
+                       const std::filesystem::path& scratch_dir) {
+  const std::string url = remote_url(remote, key);
+  const std::filesystem::path archive = scratch_dir / "artifact.tar.gz";
+  const std::filesystem::path unpack_dir = scratch_dir / "unpacked";
+  std::filesystem::create_directories(unpack_dir);
+  const std::vector<std::string> download_cmd = is_s3(url)
+    ? std::vector<std::string>{ "aws", "s3", "cp", "--quiet", url, archive.string() }
+    : std::vector<std::string>{ "curl", "-fsSL", "-o", archive.string(), url };
+  if (!run_quietly(download_cmd)) {
+    return false;
+  }
+  if (!run_quietly({ "cmake", "-E", "chdir", unpack_dir.string(), "cmake", "-E", "tar", "xzf", archive.string() })
+      || !std::filesystem::exists(unpack_dir / packages_file)) {
+    return false;
+  }
+  fmt::print("Downloaded {} from {}\n", key, remote);
+  return publish_artifact(unpack_dir, artifact_dir);
+}
+
+// Best effort: a failed upload only means other machines build the artifact themselves
+void upload_artifact(const std::string& remote, const std::string& key, const std::filesystem::path& artifact_dir,
+                     const std::filesystem::path& scratch_dir) {
+  const std::string url = remote_url(remote, key);
+  const std::filesystem::path archive = scratch_dir / "artifact.tar.gz";
+  const std::vector<std::string> pack_cmd = { "cmake", "-E", "chdir", artifact_dir.string(), "cmake", "-E", "tar", "czf",
+    archive.string(), "." };
+  const std::vector<std::string> upload_cmd = is_s3(url)
+    ? std::vector<std::string>{ "aws", "s3", "cp", "--quiet", archive.string(), url }
+    : std::vector<std::string>{ "curl", "-fsS", "-T", archive.string(), url };
+  if (!run_quietly(pack_cmd) || !run_quietly(upload_cmd)) {
+    fmt::print("Warning: Failed to upload {} to {}\n", key, remote);
+  }
+}
+
+}// namespace
+
+std::filesystem::path artifact_cache_directory() {
+  return sail_home() / "cache" / "artifacts";
+}
+
+std::vector<std::filesystem::path> artifact_libraries(const std::filesystem::path& artifact_dir) {
+  std::vector<std::filesystem::path> libraries;
+  for (const char* directory : { "lib", "lib64" }) {
+    std::error_code error;
+    for (auto it = std::filesystem::directory_iterator(artifact_dir / directory, error);
+         !error && it != std::filesystem::directory_iterator(); it.increment(error)) {
+      const std::string extension = it->path().extension().string();
+      if (it->is_regular_file() && (extension == ".a" || extension == ".so" || extension == ".dylib" || extension == ".lib")) {
+        libraries.push_back(it->path());
+      }
+    }
+  }
+  std::sort(libraries.begin(), libraries.end());
+  return libraries;
+}
+
+void prepare_dependency_artifacts(std::vector<ResolvedDependency>& dependencies, const ArtifactBuildRequest& request) {
+  const bool any_prebuilt = std::any_of(dependencies.begin(), dependencies.end(), [](const ResolvedDependency& dependency) {
+    return dependency.prebuilt;
+  });
+  if (!any_prebuilt) {
+    return;
+  }
+
+  const std::filesystem::path cache_dir = artifact_cache_directory();
+  const std::string remote = get_env("SAIL_ARTIFACT_REMOTE");
+  const bool push = get_env("SAIL_ARTIFACT_PUSH") == "1";
+  const std::string compiler = compiler_identity();
+  const ProfileFlags flags = artifact_profile_flags(request, compiler);
+  std::vector<std::string> earlier_keys;
+  std::vector<std::filesystem::path> prefix_path;
+
+  for (auto& dependency : dependencies) {
+    if (!dependency.prebuilt) {
+      continue;
+    }
+    const std::string key = artifact_key(dependency, request, compiler, flags, earlier_keys);
+    const std::filesystem::path artifact_dir = cache_dir / key;
+
+    if (!std::filesystem::exists(artifact_dir / packages_file)) {
+      const std::filesystem::path scratch_dir = cache_dir / (key + ".tmp-" + unique_suffix());
+      std::filesystem::create_directories(scratch_dir);
+      bool available = !remote.empty() && download_artifact(remote, key, artifact_dir, scratch_dir);
+      if (!available) {
+        available = build_artifact(dependency, request, flags, prefix_path, artifact_dir, scratch_dir);
+        if (available && !remote.empty() && push) {
+          upload_artifact(remote, key, artifact_dir, scratch_dir);
+        }
+      }
+      std::error_code error;
+      std::filesystem::remove_all(scratch_dir, error);
+      if (!available) {
+        fmt::print("Warning: Could not prebuild {}; building it as part of the project\n", dependency.name);
+        continue;
+      }
+    }
+
+    std::error_code error;
+    std::filesystem::last_write_time(artifact_dir, std::filesystem::file_time_type::clock::now(), error);
+    dependency.artifact_dir = artifact_dir;
+    dependency.packages = read_packages(artifact_dir);
+    if (!dependency.packages.empty()) {
+      earlier_keys.push_back(key);
+      prefix_path.push_back(artifact_dir);
+    }
+  }
+}
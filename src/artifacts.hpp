@@ -0,0 +1,43 @@
+#ifndef SAIL_ARTIFACTS_HPP
+#define SAIL_ARTIFACTS_HPP
+
+#include "dependencies.hpp"
+#include "profiles.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// How prebuilt dependencies are compiled; everything that changes the binaries is part of the cache key
+struct ArtifactBuildRequest
+{
+  // "Debug" or "Release"
+  std::string build_mode;
+  // Generator for the dependency's own build; empty lets CMake pick
+  std::string generator;
+  std::string compiler_launcher;
+  unsigned jobs = 1;
+  // The active profile and --pgo step, whose flags the dependencies are compiled and linked with too
+  ProfileSection profile;
+  PgoMode pgo = PgoMode::None;
+  std::filesystem::path pgo_dir;
+};
+
+// Where artifacts are cached: <sail_home>/cache/artifacts
+[[nodiscard]] std::filesystem::path artifact_cache_directory();
+
+// Build each prebuilt-eligible dependency once and install it into
+// <sail_home>/cache/artifacts/<key>, where the key hashes the commit, build mode, options, compiler
+// and compiler flags, including those of the profile. Cached artifacts are reused by every project. When SAIL_ARTIFACT_REMOTE is set
+// (an http(s):// or s3:// prefix), missing artifacts are downloaded from it first, and uploaded to it
+// after a local build if SAIL_ARTIFACT_PUSH=1. Every use of an artifact moves its modification
+// time, which `sail clean --gc` evicts by.
+// Sets artifact_dir and packages on the dependencies it handled. A dependency that fails to build
+// this way is left to be built from source, with a warning.
+void prepare_dependency_artifacts(std::vector<ResolvedDependency>& dependencies, const ArtifactBuildRequest& request);
+
+// The libraries an artifact installs into lib/ or lib64/, for linking it without CMake: static
+// archives and shared libraries by their unversioned names, sorted
+[[nodiscard]] std::vector<std::filesystem::path> artifact_libraries(const std::filesystem::path& artifact_dir);
+
+#endif
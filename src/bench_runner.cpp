@@ -0,0 +1,311 @@
+#include "bench_runner.hpp"
+#include "process.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <map>
+#include <sstream>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace {
+
+// Quantile of sorted samples, interpolating between the two nearest ranks
+double quantile(const std::vector<double>& sorted, double fraction) {
+  const double position = fraction * static_cast<double>(sorted.size() - 1);
+  const auto lower = static_cast<size_t>(position);
+  const size_t upper = std::min(lower + 1, sorted.size() - 1);
+  return sorted[lower] + (sorted[upper] - sorted[lower]) * (position - static_cast<double>(lower));
+}
+
+// Child processes inherit the affinity, so pinning sail pins the benchmarks
+bool pin_to_cpu(unsigned cpu) {
+#ifdef _WIN32
+  return cpu < 64 && SetProcessAffinityMask(GetCurrentProcess(), DWORD_PTR{ 1 } << cpu) != 0;
+#elif defined(__linux__)
+  if (cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+  static_cast<void>(cpu);
+  return false;
+#endif
+}
+
+// The value after `"key": ` in a line written by write_bench_results
+std::optional<double> number_field(std::string_view line, std::string_view key) {
+  const size_t found = line.find(fmt::format("\"{}\": ", key));
+  if (found == std::string_view::npos) {
+    return std::nullopt;
+  }
+  const std::string value(line.substr(found + key.size() + 4, 32));
+  char* end = nullptr;
+  const double number = std::strtod(value.c_str(), &end);
+  return end == value.c_str() ? std::nullopt : std::optional<double>(number);
+}
+
+std::optional<std::string> name_field(std::string_view line) {
+  constexpr std::string_view key = "\"name\": \"";
+  const size_t found = line.find(key);
+  if (found == std::string_view::npos) {
+    return std::nullopt;
+  }
+  std::string name;
+  for (size_t pos = found + key.size(); pos < line.size(); ++pos) {
+    if (line[pos] == '"') {
+      return name;
+    }
+    if (line[pos] == '\\' && pos + 1 < line.size()) {
+      ++pos;
+    }
+    name += line[pos];
+  }
+  return std::nullopt;
+}
+
+}// namespace
+
+std::string format_nanoseconds(double nanoseconds) {
+  if (nanoseconds < 1e3) {
+    return fmt::format("{:.1f} ns", nanoseconds);
+  }
+  if (nanoseconds < 1e6) {
+    return fmt::format("{:.2f} us", nanoseconds / 1e3);
+  }
+  if (nanoseconds < 1e9) {
+    return fmt::format("{:.2f} ms", nanoseconds / 1e6);
+  }
+  return fmt::format("{:.3f} s", nanoseconds / 1e9);
+}
+
+BenchStatistics summarize_samples(std::vector<double> samples) {
+  BenchStatistics statistics;
+  if (samples.empty()) {
+    return statistics;
+  }
+  std::sort(samples.begin(), samples.end());
+  // Quartiles of fewer than four samples say nothing about outliers
+  if (samples.size() >= 4) {
+    const double first_quartile = quantile(samples, 0.25);
+    const double third_quartile = quantile(samples, 0.75);
+    const double fence = 1.5 * (third_quartile - first_quartile);
+    const auto kept_end = std::remove_if(samples.begin(), samples.end(), [&](double sample) {
+      return sample < first_quartile - fence || sample > third_quartile + fence;
+    });
+    statistics.outliers = static_cast<size_t>(samples.end() - kept_end);
+    samples.erase(kept_end, samples.end());
+  }
+
+  const auto count = static_cast<double>(samples.size());
+  statistics.samples = samples.size();
+  statistics.min = samples.front();
+  statistics.max = samples.back();
+  statistics.median = quantile(samples, 0.5);
+  double sum = 0;
+  for (const double sample : samples) {
+    sum += sample;
+  }
+  statistics.mean = sum / count;
+  double squares = 0;
+  for (const double sample : samples) {
+    squares += (sample - statistics.mean) * (sample - statistics.mean);
+  }
+  statistics.stddev = samples.size() > 1 ? std::sqrt(squares / (count - 1)) : 0.0;
+  const double half_width = samples.size() > 1 ? t_quantile_95(count - 1) * statistics.stddev / std::sqrt(count) : 0.0;
+  statistics.ci_low = statistics.mean - half_width;
+  statistics.ci_high = statistics.mean + half_width;
+  return statistics;
+}
+
+double t_quantile_95(double degrees_of_freedom) {
+  constexpr std::array<double, 30> table = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+  // Rounding the degrees of freedom down keeps the interval on the wide side
+  if (degrees_of_freedom < 1) {
+    return table.front();
+  }
+  if (degrees_of_freedom <= static_cast<double>(table.size())) {
+    return table[static_cast<size_t>(degrees_of_freedom) - 1];
+  }
+  // Beyond 30 the quantile approaches the normal one as 1/df
+  return 1.960 + (table.back() - 1.960) * static_cast<double>(table.size()) / degrees_of_freedom;
+}
+
+BenchComparison compare_to_baseline(const BenchStatistics& baseline, const BenchStatistics& current, double noise_threshold) {
+  BenchComparison comparison;
+  if (baseline.mean <= 0 || baseline.samples == 0 || current.samples == 0) {
+    return comparison;
+  }
+  const double baseline_variance = baseline.stddev * baseline.stddev / static_cast<double>(baseline.samples);
+  const double current_variance = current.stddev * current.stddev / static_cast<double>(current.samples);
+  const double standard_error = std::sqrt(baseline_variance + current_variance);
+  double half_width = 0;
+  if (standard_error > 0) {
+    // Welch-Satterthwaite; a single sample contributes no variance and no degrees of freedom
+    double denominator = 0;
+    if (baseline.samples > 1) {
+      denominator += baseline_variance * baseline_variance / static_cast<double>(baseline.samples - 1);
+    }
+    if (current.samples > 1) {
+      denominator += current_variance * current_variance / static_cast<double>(current.samples - 1);
+    }
+    const double degrees_of_freedom = denominator > 0 ? std::pow(standard_error, 4) / denominator : 1.0;
+    half_width = t_quantile_95(degrees_of_freedom) * standard_error;
+  }
+  const double difference = current.mean - baseline.mean;
+  comparison.change = difference / baseline.mean;
+  comparison.ci_low = (difference - half_width) / baseline.mean;
+  comparison.ci_high = (difference + half_width) / baseline.mean;
+  if (comparison.ci_low > noise_threshold) {
+    comparison.verdict = BenchVerdict::Regressed;
+  } else if (comparison.ci_high < -noise_threshold) {
+    comparison.verdict = BenchVerdict::Improved;
+  }
+  return comparison;
+}
+
+void write_bench_results(const std::filesystem::path& path, const std::vector<BenchResult>& results) {
+  std::string json = "{\n\"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchResult& result = results[i];
+    const BenchStatistics& statistics = result.statistics;
+    std::string samples;
+    for (const double sample : result.samples) {
+      samples += fmt::format("{}{:.0f}", samples.empty() ? "" : ", ", sample);
+    }
+    json += fmt::format("{{\"name\": {}, \"samples\": {}, \"outliers\": {}, \"mean_ns\": {:.1f}, \"median_ns\": {:.1f}, "
+                        "\"stddev_ns\": {:.1f}, \"min_ns\": {:.1f}, \"max_ns\": {:.1f}, \"ci_low_ns\": {:.1f}, \"ci_high_ns\": {:.1f}, "
+                        "\"samples_ns\": [{}]}}{}\n",
+      json_quote(result.name), statistics.samples, statistics.outliers, statistics.mean, statistics.median, statistics.stddev,
+      statistics.min, statistics.max, statistics.ci_low, statistics.ci_high, samples, i + 1 < results.size() ? "," : "");
+  }
+  json += "]\n}\n";
+  std::filesystem::create_directories(path.parent_path());
+  write_file_if_changed(path, json);
+}
+
+std::vector<BenchResult> read_bench_results(const std::filesystem::path& path) {
+  std::vector<BenchResult> results;
+  std::istringstream lines(read_file(path).value_or(std::string()));
+  std::string line;
+  while (std::getline(lines, line)) {
+    auto name = name_field(line);
+    const auto samples = number_field(line, "samples");
+    const auto mean = number_field(line, "mean_ns");
+    const auto stddev = number_field(line, "stddev_ns");
+    if (!name || !samples || !mean || !stddev) {
+      continue;
+    }
+    BenchResult result;
+    result.name = std::move(*name);
+    result.statistics.samples = static_cast<size_t>(*samples);
+    result.statistics.outliers = static_cast<size_t>(number_field(line, "outliers").value_or(0));
+    result.statistics.mean = *mean;
+    result.statistics.stddev = *stddev;
+    result.statistics.median = number_field(line, "median_ns").value_or(*mean);
+    result.statistics.min = number_field(line, "min_ns").value_or(*mean);
+    result.statistics.max = number_field(line, "max_ns").value_or(*mean);
+    result.statistics.ci_low = number_field(line, "ci_low_ns").value_or(*mean);
+    result.statistics.ci_high = number_field(line, "ci_high_ns").value_or(*mean);
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+int run_benches(const BenchRunRequest& request) {
+  std::map<std::string, BenchStatistics> baseline;
+  if (!request.baseline.empty()) {
+    const std::filesystem::path baseline_path = request.results_dir / (request.baseline + ".json");
+    if (!std::filesystem::exists(baseline_path)) {
+      fmt::print("Error: No baseline '{}' in target/bench; save one with sail bench --save-baseline {}\n", request.baseline, request.baseline);
+      return EXIT_FAILURE;
+    }
+    for (auto& result : read_bench_results(baseline_path)) {
+      baseline.emplace(std::move(result.name), result.statistics);
+    }
+  }
+  if (request.cpu && !pin_to_cpu(*request.cpu)) {
+    fmt::print("Warning: Could not pin the benchmarks to CPU {}; running them unpinned\n", *request.cpu);
+  }
+
+  fmt::print("Running {} benchmark(s), {} warmup and {} timed run(s) each\n", request.names.size(), request.warmup, request.repetitions);
+  std::vector<BenchResult> results;
+  size_t failed = 0;
+  size_t regressed = 0;
+  for (const auto& name : request.names) {
+    std::vector<std::string> command = { get_executable_path(request.target_dir / "benches", name).string() };
+    command.insert(command.end(), request.args.begin(), request.args.end());
+
+    std::vector<double> samples;
+    ProcessResult result;
+    for (unsigned run = 0; run < request.warmup + request.repetitions; ++run) {
+      result = run_process(command, ProcessOptions{ ProcessOutput::Capture });
+      if (!result.success()) {
+        break;
+      }
+      if (run >= request.warmup) {
+        samples.push_back(std::chrono::duration<double, std::nano>(result.elapsed).count());
+      }
+    }
+    // Frameworks such as Google Benchmark print their own per-function report
+    if (!result.output.empty()) {
+      fmt::print("{}{}", result.output, result.output.back() == '\n' ? "" : "\n");
+    }
+    if (!result.success()) {
+      ++failed;
+      fmt::print("bench {} ... FAILED, exit code {}{}\n", name, result.exit_code, result.error.empty() ? "" : ": " + result.error);
+      continue;
+    }
+
+    BenchResult bench{ name, summarize_samples(samples), {} };
+    const BenchStatistics& statistics = bench.statistics;
+    std::sort(samples.begin(), samples.end());
+    bench.samples = samples;
+    fmt::print("bench {} ... {} +/- {} (median {}, {} run(s), {} outlier(s) rejected)\n", name, format_nanoseconds(statistics.mean),
+      format_nanoseconds(statistics.ci_high - statistics.mean), format_nanoseconds(statistics.median), statistics.samples,
+      statistics.outliers);
+    const auto base = baseline.find(name);
+    if (base != baseline.end()) {
+      const BenchComparison comparison = compare_to_baseline(base->second, statistics);
+      const char* verdict = comparison.verdict == BenchVerdict::Regressed ? "regressed"
+        : comparison.verdict == BenchVerdict::Improved ? "improved" : "no change";
+      fmt::print("  vs {}: {:+.2f}% (95% CI {:+.2f}% .. {:+.2f}%), {}\n", request.baseline, comparison.change * 100,
+        comparison.ci_low * 100, comparison.ci_high * 100, verdict);
+      regressed += comparison.verdict == BenchVerdict::Regressed ? 1 : 0;
+    } else if (!request.baseline.empty()) {
+      fmt::print("  not in baseline {}\n", request.baseline);
+    }
+    results.push_back(std::move(bench));
+  }
+
+  write_bench_results(request.results_dir / "latest.json", results);
+  if (!request.save_baseline.empty()) {
+    write_bench_results(request.results_dir / (request.save_baseline + ".json"), results);
+    fmt::print("Saved baseline {} in target/bench/{}.json\n", request.save_baseline, request.save_baseline);
+  }
+  if (failed > 0) {
+    fmt::print("Error: {} benchmark(s) failed\n", failed);
+  }
+  if (regressed > 0) {
+    fmt::print("Error: {} benchmark(s) regressed against {}\n", regressed, request.baseline);
+  }
+  return failed == 0 && regressed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
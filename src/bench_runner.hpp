@@ -0,0 +1,91 @@
+#ifndef SAIL_BENCH_RUNNER_HPP
+#define SAIL_BENCH_RUNNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Summary of the timed runs of one benchmark, in nanoseconds
+struct BenchStatistics
+{
+  // Runs that were kept, and those rejected as outliers
+  std::size_t samples = 0;
+  std::size_t outliers = 0;
+  double mean = 0;
+  double median = 0;
+  double stddev = 0;
+  double min = 0;
+  double max = 0;
+  // 95% confidence interval of the mean
+  double ci_low = 0;
+  double ci_high = 0;
+};
+
+// Reject the samples outside the Tukey fences (1.5 interquartile ranges beyond the quartiles),
+// which catches the runs a context switch or a page cache miss stretched, and summarize the rest
+[[nodiscard]] BenchStatistics summarize_samples(std::vector<double> samples);
+
+// Two-sided 95% quantile of Student's t distribution for the given degrees of freedom
+[[nodiscard]] double t_quantile_95(double degrees_of_freedom);
+
+// A duration in nanoseconds with a unit that keeps it readable, such as "12.34 ms"
+[[nodiscard]] std::string format_nanoseconds(double nanoseconds);
+
+enum class BenchVerdict : std::uint8_t { Unchanged, Improved, Regressed };
+
+// Change of the mean against a baseline, relative to the baseline's mean, with the 95% confidence
+// interval from Welch's t-test. Only an interval entirely beyond the noise threshold counts as a change.
+struct BenchComparison
+{
+  double change = 0;
+  double ci_low = 0;
+  double ci_high = 0;
+  BenchVerdict verdict = BenchVerdict::Unchanged;
+};
+
+[[nodiscard]] BenchComparison compare_to_baseline(const BenchStatistics& baseline, const BenchStatistics& current,
+                                                  double noise_threshold = 0.02);
+
+struct BenchResult
+{
+  std::string name;
+  BenchStatistics statistics;
+  // Every timed run, outliers included, in nanoseconds
+  std::vector<double> samples;
+};
+
+// Results are kept as JSON in target/bench/<name>.json, one benchmark per line so that sail can
+// read them back without a JSON library
+void write_bench_results(const std::filesystem::path& path, const std::vector<BenchResult>& results);
+[[nodiscard]] std::vector<BenchResult> read_bench_results(const std::filesystem::path& path);
+
+struct BenchRunRequest
+{
+  // target/release, which holds the programs in benches/
+  std::filesystem::path target_dir;
+  // target/bench, where the results go
+  std::filesystem::path results_dir;
+  // Names of the bench programs, sorted
+  std::vector<std::string> names;
+  unsigned warmup = 1;
+  unsigned repetitions = 10;
+  // Pin sail, and so every benchmark it starts, to this CPU
+  std::optional<unsigned> cpu;
+  // Passed to every bench program
+  std::vector<std::string> args;
+  // Store the results as this baseline as well as in latest.json
+  std::string save_baseline;
+  // Compare against this stored baseline
+  std::string baseline;
+};
+
+// Run the bench programs one after the other: the warmup runs, then the timed ones. Each program
+// is timed as a whole, so programs that use Google Benchmark or nanobench work as they are; their
+// own report, from the last run, is printed as well. Returns EXIT_FAILURE if a program failed or
+// regressed against the baseline.
+[[nodiscard]] int run_benches(const BenchRunRequest& request);
+
+#endif
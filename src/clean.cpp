@@ -0,0 +1,270 @@
+#include "clean.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+// Strip the first of `suffixes` that `name` ends with; std::nullopt if none does
+std::optional<std::string> strip_suffix(const std::string& name, std::initializer_list<std::string_view> suffixes) {
+  for (const std::string_view suffix : suffixes) {
+    if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+      return name.substr(0, name.size() - suffix.size());
+    }
+  }
+  return std::nullopt;
+}
+
+bool exists_no_throw(const std::filesystem::path& path) {
+  std::error_code error;
+  return std::filesystem::exists(path, error);
+}
+
+Reclaimed count_tree(const std::filesystem::path& path) {
+  Reclaimed counted;
+  std::error_code error;
+  if (std::filesystem::is_regular_file(std::filesystem::symlink_status(path, error))) {
+    return Reclaimed{ 1, std::filesystem::file_size(path, error) };
+  }
+  for (auto it = std::filesystem::recursive_directory_iterator(path, error); !error && it != std::filesystem::recursive_directory_iterator();
+       it.increment(error)) {
+    if (it->is_regular_file(error) && !it->is_symlink(error)) {
+      counted.files += 1;
+      counted.bytes += it->file_size(error);
+    }
+  }
+  return counted;
+}
+
+// The native engine's objects: obj/<path under src>.o, and obj/tests/<file>.o or obj/benches/<file>.o
+// for the programs, which are linked as recorded in obj/<kind>/<name>.link.fingerprint
+Reclaimed remove_orphaned_native_objects(const std::filesystem::path& project_root, const std::filesystem::path& obj_dir) {
+  Reclaimed reclaimed;
+  std::vector<std::filesystem::path> orphans;
+  std::error_code error;
+  for (auto it = std::filesystem::recursive_directory_iterator(obj_dir, error); !error && it != std::filesystem::recursive_directory_iterator();
+       it.increment(error)) {
+    const std::filesystem::path relative = it->path().lexically_relative(obj_dir);
+    const std::string top = relative.begin()->string();
+    // Generated unity sources, module BMIs and the precompiled header have no source of their own
+    if (it->is_directory(error)) {
+      if (it.depth() == 0 && (top == "unity" || top == "modules" || top == "pch")) {
+        it.disable_recursion_pending();
+      }
+      continue;
+    }
+    const bool in_programs = top == "tests" || top == "benches";
+    const std::string name = it->path().filename().string();
+    std::vector<std::filesystem::path> sources;
+    if (const auto source = strip_suffix(name, { ".o", ".d" })) {
+      const std::filesystem::path source_relative = relative.parent_path() / *source;
+      sources.push_back(project_root / "src" / source_relative);
+      if (in_programs) {
+        sources.push_back(project_root / source_relative);
+      }
+    } else if (const auto program = strip_suffix(name, { ".link.fingerprint" }); program && in_programs && it.depth() == 1) {
+      sources.push_back(project_root / top / (*program + ".cpp"));
+    }
+    if (!sources.empty() && std::none_of(sources.begin(), sources.end(), exists_no_throw)) {
+      orphans.push_back(it->path());
+    }
+  }
+  for (const auto& orphan : orphans) {
+    reclaimed += remove_counted(orphan);
+  }
+  return reclaimed;
+}
+
+// CMake's objects: [<dir>/]CMakeFiles/<target>.dir/<path under the source dir>.o, .obj and their
+// depfiles. Only objects of sources under a project's own src/, tests/ or benches/ are considered, so
+// dependencies built in the tree are never touched.
+Reclaimed remove_orphaned_cmake_objects(const std::filesystem::path& project_root, const std::filesystem::path& build_dir) {
+  Reclaimed reclaimed;
+  std::vector<std::filesystem::path> orphans;
+  std::error_code error;
+  for (auto it = std::filesystem::recursive_directory_iterator(build_dir, error); !error && it != std::filesystem::recursive_directory_iterator();
+       it.increment(error)) {
+    if (!it->is_regular_file(error)) {
+      continue;
+    }
+    const auto source_name = strip_suffix(it->path().filename().string(), { ".o.d", ".obj.d", ".o", ".obj" });
+    if (!source_name) {
+      continue;
+    }
+    const std::filesystem::path relative = it->path().lexically_relative(build_dir);
+    const std::vector<std::filesystem::path> parts(relative.begin(), relative.end());
+    const auto cmake_files = std::find(parts.begin(), parts.end(), std::filesystem::path("CMakeFiles"));
+    if (cmake_files == parts.end() || parts.end() - cmake_files < 4 || (cmake_files + 1)->extension() != ".dir") {
+      continue;
+    }
+    std::filesystem::path source_dir = project_root;
+    for (auto part = parts.begin(); part != cmake_files; ++part) {
+      source_dir /= *part;
+    }
+    const std::filesystem::path& top = *(cmake_files + 2);
+    if ((top != "src" && top != "tests" && top != "benches") || !std::filesystem::is_directory(source_dir / top, error)) {
+      continue;
+    }
+    std::filesystem::path source = source_dir;
+    for (auto part = cmake_files + 2; part + 1 != parts.end(); ++part) {
+      source /= *part;
+    }
+    if (!exists_no_throw(source / *source_name)) {
+      orphans.push_back(it->path());
+    }
+  }
+  for (const auto& orphan : orphans) {
+    reclaimed += remove_counted(orphan);
+  }
+  return reclaimed;
+}
+
+}// namespace
+
+std::optional<std::uint64_t> parse_byte_size(std::string_view text) {
+  size_t digits = 0;
+  while (digits < text.size() && (std::isdigit(static_cast<unsigned char>(text[digits])) != 0 || text[digits] == '.')) {
+    ++digits;
+  }
+  if (digits == 0) {
+    return std::nullopt;
+  }
+  const std::string number(text.substr(0, digits));
+  char* end = nullptr;
+  const double value = std::strtod(number.c_str(), &end);
+  if (end != number.c_str() + number.size()) {
+    return std::nullopt;
+  }
+  std::string unit(text.substr(digits));
+  std::transform(unit.begin(), unit.end(), unit.begin(), [](unsigned char character) { return static_cast<char>(std::toupper(character)); });
+  constexpr std::array<std::string_view, 5> prefixes{ "", "K", "M", "G", "T" };
+  for (size_t power = 0; power < prefixes.size(); ++power) {
+    const std::string prefix(prefixes[power]);
+    if (unit == prefix || unit == prefix + "B" || (!prefix.empty() && unit == prefix + "IB")) {
+      return static_cast<std::uint64_t>(value * static_cast<double>(1ULL << (10U * power)));
+    }
+  }
+  return std::nullopt;
+}
+
+std::string format_bytes(std::uint64_t bytes) {
+  constexpr std::array<std::string_view, 4> units{ "KiB", "MiB", "GiB", "TiB" };
+  if (bytes < 1024) {
+    return fmt::format("{} B", bytes);
+  }
+  auto value = static_cast<double>(bytes) / 1024;
+  size_t unit = 0;
+  while (value >= 1024 && unit + 1 < units.size()) {
+    value /= 1024;
+    ++unit;
+  }
+  return fmt::format("{:.2f} {}", value, units[unit]);
+}
+
+Reclaimed remove_counted(const std::filesystem::path& path) {
+  const Reclaimed counted = count_tree(path);
+  std::error_code error;
+  std::filesystem::remove_all(path, error);
+  return error ? Reclaimed{} : counted;
+}
+
+Reclaimed remove_orphaned_objects(const std::filesystem::path& project_root, const std::filesystem::path& mode_dir) {
+  Reclaimed reclaimed;
+  std::error_code error;
+  if (std::filesystem::is_directory(mode_dir / "obj", error)) {
+    reclaimed += remove_orphaned_native_objects(project_root, mode_dir / "obj");
+  }
+  if (std::filesystem::is_directory(mode_dir / "build", error)) {
+    reclaimed += remove_orphaned_cmake_objects(project_root, mode_dir / "build");
+  }
+  for (const std::string_view kind : { "tests", "benches" }) {
+    std::vector<std::filesystem::path> orphans;
+    for (const auto& entry : std::filesystem::directory_iterator(mode_dir / kind, error)) {
+      const std::filesystem::path program = entry.path().filename();
+      const std::string name = program.extension() == EXECUTABLE_EXTENSION && !EXECUTABLE_EXTENSION.empty()
+        ? program.stem().string() : program.string();
+      if (entry.is_regular_file(error) && !exists_no_throw(project_root / kind / (name + ".cpp"))) {
+        orphans.push_back(entry.path());
+      }
+    }
+    for (const auto& orphan : orphans) {
+      reclaimed += remove_counted(orphan);
+    }
+  }
+  return reclaimed;
+}
+
+Reclaimed evict_least_recently_used(const std::filesystem::path& cache_dir, std::uint64_t max_bytes, EvictionUnit unit) {
+  struct Entry
+  {
+    std::filesystem::path path;
+    std::filesystem::file_time_type used;
+    std::uint64_t bytes = 0;
+  };
+  std::vector<Entry> entries;
+  std::uint64_t total = 0;
+  std::error_code error;
+  const auto add = [&](const std::filesystem::path& path, std::uint64_t bytes) {
+    std::error_code time_error;
+    entries.push_back(Entry{ path, std::filesystem::last_write_time(path, time_error), bytes });
+    total += bytes;
+  };
+  if (unit == EvictionUnit::Entries) {
+    // An artifact still being built or downloaded is left alone; the sail building it removes it afterwards
+    const auto in_progress = std::filesystem::file_time_type::clock::now() - std::chrono::hours(1);
+    for (const auto& entry : std::filesystem::directory_iterator(cache_dir, error)) {
+      std::error_code time_error;
+      if (entry.path().filename().string().find(".tmp-") != std::string::npos
+          && std::filesystem::last_write_time(entry.path(), time_error) > in_progress) {
+        continue;
+      }
+      add(entry.path(), count_tree(entry.path()).bytes);
+    }
+  } else {
+    for (auto it = std::filesystem::recursive_directory_iterator(cache_dir, error); !error && it != std::filesystem::recursive_directory_iterator();
+         it.increment(error)) {
+      if (it->is_regular_file(error) && !it->is_symlink(error)) {
+        add(it->path(), it->file_size(error));
+      }
+    }
+  }
+
+  std::sort(entries.begin(), entries.end(), [](const Entry& left, const Entry& right) { return left.used < right.used; });
+  Reclaimed reclaimed;
+  for (const auto& entry : entries) {
+    if (total <= max_bytes) {
+      break;
+    }
+    const Reclaimed removed = remove_counted(entry.path);
+    reclaimed += removed;
+    total -= std::min(total, entry.bytes);
+  }
+  return reclaimed;
+}
+
+std::filesystem::path sccache_directory() {
+  if (const std::string configured = get_env("SCCACHE_DIR"); !configured.empty()) {
+    return configured;
+  }
+#ifdef _WIN32
+  const std::string local_app_data = get_env("LOCALAPPDATA");
+  return local_app_data.empty() ? std::filesystem::path() : std::filesystem::path(local_app_data) / "Mozilla" / "sccache" / "cache";
+#elif defined(__APPLE__)
+  const std::string home = get_env("HOME");
+  return home.empty() ? std::filesystem::path() : std::filesystem::path(home) / "Library" / "Caches" / "Mozilla.sccache";
+#else
+  if (const std::string xdg_cache = get_env("XDG_CACHE_HOME"); !xdg_cache.empty()) {
+    return std::filesystem::path(xdg_cache) / "sccache";
+  }
+  const std::string home = get_env("HOME");
+  return home.empty() ? std::filesystem::path() : std::filesystem::path(home) / ".cache" / "sccache";
+#endif
+}
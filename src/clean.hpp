@@ -0,0 +1,53 @@
+#ifndef SAIL_CLEAN_HPP
+#define SAIL_CLEAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// What a clean step removed
+struct Reclaimed
+{
+  std::size_t files = 0;
+  std::uint64_t bytes = 0;
+
+  Reclaimed& operator+=(const Reclaimed& other) noexcept {
+    files += other.files;
+    bytes += other.bytes;
+    return *this;
+  }
+};
+
+// Parse a size such as "512M", "10G" or "1.5GiB"; the suffixes are binary multiples. std::nullopt if malformed.
+[[nodiscard]] std::optional<std::uint64_t> parse_byte_size(std::string_view text);
+
+// A size with a unit that keeps it readable, such as "1.50 GiB"
+[[nodiscard]] std::string format_bytes(std::uint64_t bytes);
+
+// Remove a file or a whole tree, counting the files and bytes it held
+Reclaimed remove_counted(const std::filesystem::path& path);
+
+// Remove what the sources of the project no longer account for from target/<mode>: objects and
+// depfiles under obj/ (native engine) or build/ (CMake engine) whose source under src/, tests/ or
+// benches/ is gone, and the test and bench programs of deleted sources
+Reclaimed remove_orphaned_objects(const std::filesystem::path& project_root, const std::filesystem::path& mode_dir);
+
+// How a cache is made up for eviction
+enum class EvictionUnit : std::uint8_t {
+  // Every directory directly in the cache is one entry, such as an artifact
+  Entries,
+  // Every file anywhere in the cache stands alone
+  Files,
+};
+
+// Remove the least recently used entries of `cache_dir` until it holds at most `max_bytes`. Use is
+// read from modification times, which the cache's owner moves whenever it uses an entry.
+Reclaimed evict_least_recently_used(const std::filesystem::path& cache_dir, std::uint64_t max_bytes, EvictionUnit unit);
+
+// Where sccache keeps its local disk cache: SCCACHE_DIR or the platform's default; empty if unknown
+[[nodiscard]] std::filesystem::path sccache_directory();
+
+#endif
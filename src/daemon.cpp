@@ -0,0 +1,579 @@
+#include "daemon.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fmt/format.h>
+#include <string_view>
+#include <system_error>
+
+#ifndef _WIN32
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;  // NOLINT(readability-redundant-declaration)
+#endif
+
+std::filesystem::path daemon_socket_path(const std::filesystem::path& project_root) {
+  return project_root / "target" / "daemon.sock";
+}
+
+#ifdef _WIN32
+
+std::optional<int> forward_to_daemon(const std::filesystem::path& /*socket_path*/, const std::vector<std::string>& /*args*/) {
+  return std::nullopt;
+}
+
+bool stop_daemon(const std::filesystem::path& /*socket_path*/) {
+  return false;
+}
+
+int serve_daemon(const std::filesystem::path& /*socket_path*/, const DaemonHandlers& /*handlers*/) {
+  fmt::print("Error: sail daemon needs Unix domain sockets and is not available on Windows\n");
+  return EXIT_FAILURE;
+}
+
+#else
+
+namespace {
+
+// A request is a 32-bit length and that many bytes of NUL-terminated fields: the kind ("run" or
+// "stop"), then for "run" the working directory, the number of arguments, the arguments and the
+// environment. The client's stdin, stdout and stderr travel with it as SCM_RIGHTS. The answer is
+// the 32-bit exit code.
+struct Request
+{
+  std::vector<std::string> fields;
+  std::vector<int> fds;
+};
+
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif
+
+// How long a client has to send its request after connecting; it sends it all at once
+constexpr std::chrono::seconds request_timeout{ 2 };
+
+volatile std::sig_atomic_t stop_requested = 0;
+// Written to on SIGCHLD, so that poll() returns as soon as a worker exits
+std::array<int, 2> wake_pipe = { -1, -1 };
+
+extern "C" void request_stop(int /*signal*/) {
+  stop_requested = 1;
+}
+
+extern "C" void wake_on_child_exit(int /*signal*/) {
+  const int saved_errno = errno;
+  const char byte = 0;
+  static_cast<void>(write(wake_pipe[1], &byte, 1));
+  errno = saved_errno;
+}
+
+void set_cloexec(int fd) {
+  fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+}
+
+bool send_all(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t sent = send(fd, data, size, send_flags);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    size -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+bool read_all(int fd, char* data, size_t size) {
+  while (size > 0) {
+    const ssize_t received = read(fd, data, size);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    data += received;
+    size -= static_cast<size_t>(received);
+  }
+  return true;
+}
+
+bool fill_address(sockaddr_un& address, const std::filesystem::path& socket_path) {
+  const std::string path = socket_path.string();
+  address = sockaddr_un{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+// Connect to the socket; -1 if nobody listens there
+int connect_to(const std::filesystem::path& socket_path) {
+  sockaddr_un address{};
+  if (!fill_address(address, socket_path)) {
+    return -1;
+  }
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  set_cloexec(fd);
+#ifdef SO_NOSIGPIPE
+  const int enabled = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enabled, sizeof(enabled));
+#endif
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool send_request(int fd, const std::vector<std::string>& fields, bool with_stdio) {
+  std::string payload;
+  for (const auto& field : fields) {
+    payload += field;
+    payload += '\0';
+  }
+  const auto length = static_cast<std::uint32_t>(payload.size());
+  std::string message(sizeof(length), '\0');
+  std::memcpy(message.data(), &length, sizeof(length));
+  message += payload;
+
+  iovec chunk{ message.data(), message.size() };
+  msghdr header{};
+  header.msg_iov = &chunk;
+  header.msg_iovlen = 1;
+  alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(int) * 3)> control{};
+  if (with_stdio) {
+    header.msg_control = control.data();
+    header.msg_controllen = control.size();
+    cmsghdr* rights = CMSG_FIRSTHDR(&header);
+    rights->cmsg_level = SOL_SOCKET;
+    rights->cmsg_type = SCM_RIGHTS;
+    rights->cmsg_len = CMSG_LEN(sizeof(int) * 3);
+    const std::array<int, 3> stdio = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+    std::memcpy(CMSG_DATA(rights), stdio.data(), sizeof(int) * 3);
+  }
+  ssize_t sent = -1;
+  do {
+    sent = sendmsg(fd, &header, send_flags);
+  } while (sent < 0 && errno == EINTR);
+  if (sent < 0) {
+    return false;
+  }
+  return send_all(fd, message.data() + sent, message.size() - static_cast<size_t>(sent));
+}
+
+std::optional<Request> receive_request(int fd) {
+  Request request;
+  std::uint32_t length = 0;
+  iovec chunk{ &length, sizeof(length) };
+  msghdr header{};
+  header.msg_iov = &chunk;
+  header.msg_iovlen = 1;
+  alignas(cmsghdr) std::array<char, CMSG_SPACE(sizeof(int) * 3)> control{};
+  header.msg_control = control.data();
+  header.msg_controllen = control.size();
+  ssize_t received = -1;
+  do {
+    received = recvmsg(fd, &header, 0);
+  } while (received < 0 && errno == EINTR);
+  if (received <= 0) {
+    return std::nullopt;
+  }
+  for (cmsghdr* rights = CMSG_FIRSTHDR(&header); rights != nullptr; rights = CMSG_NXTHDR(&header, rights)) {
+    if (rights->cmsg_level == SOL_SOCKET && rights->cmsg_type == SCM_RIGHTS) {
+      request.fds.resize((rights->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+      std::memcpy(request.fds.data(), CMSG_DATA(rights), request.fds.size() * sizeof(int));
+    }
+  }
+  for (const int passed : request.fds) {
+    set_cloexec(passed);
+  }
+  const auto close_fds = [&]() {
+    for (const int passed : request.fds) {
+      close(passed);
+    }
+  };
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (!read_all(fd, reinterpret_cast<char*>(&length) + received, sizeof(length) - static_cast<size_t>(received))
+      || length > (1U << 24U)) {
+    close_fds();
+    return std::nullopt;
+  }
+  std::string payload(length, '\0');
+  if (!read_all(fd, payload.data(), payload.size())) {
+    close_fds();
+    return std::nullopt;
+  }
+  for (size_t start = 0; start < payload.size();) {
+    const size_t end = payload.find('\0', start);
+    request.fields.push_back(payload.substr(start, end - start));
+    start = end == std::string::npos ? payload.size() : end + 1;
+  }
+  const bool valid = !request.fields.empty()
+    && (request.fields[0] == "stop" || (request.fields[0] == "run" && request.fields.size() >= 3 && request.fds.size() == 3));
+  if (!valid) {
+    close_fds();
+    return std::nullopt;
+  }
+  return request;
+}
+
+// Whether the process at the other end of a connection runs as the same user as the daemon, which
+// carries out commands as that user
+bool is_own_user(int fd) {
+#ifdef __linux__
+  ucred credentials{};
+  socklen_t size = sizeof(credentials);
+  return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &size) == 0 && credentials.uid == geteuid();
+#else
+  uid_t uid = 0;
+  gid_t gid = 0;
+  return getpeereid(fd, &uid, &gid) == 0 && uid == geteuid();
+#endif
+}
+
+void send_exit_code(int fd, int exit_code) {
+  const std::int32_t code = exit_code;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  static_cast<void>(send_all(fd, reinterpret_cast<const char*>(&code), sizeof(code)));
+}
+
+int exit_code_of(int status) {
+  if (WIFEXITED(status)) {
+    return WEXITSTATUS(status);
+  }
+  return WIFSIGNALED(status) ? 128 + WTERMSIG(status) : EXIT_FAILURE;
+}
+
+// The forked child that carries out one "run" request; never returns
+[[noreturn]] void run_worker(const Request& request, const std::vector<int>& daemon_fds, const DaemonHandlers& handlers) {
+  setpgid(0, 0);
+  std::signal(SIGINT, SIG_DFL);
+  std::signal(SIGTERM, SIG_DFL);
+  std::signal(SIGPIPE, SIG_DFL);
+  std::signal(SIGCHLD, SIG_DFL);
+  for (const int fd : daemon_fds) {
+    close(fd);
+  }
+  for (int target = 0; target < 3; ++target) {
+    dup2(request.fds[static_cast<size_t>(target)], target);
+  }
+  for (const int passed : request.fds) {
+    if (passed > STDERR_FILENO) {
+      close(passed);
+    }
+  }
+
+  // Fields: "run", the working directory, the argument count, the arguments, the environment
+  const size_t arg_count = std::strtoul(request.fields[2].c_str(), nullptr, 10);
+  const size_t args_end = std::min(request.fields.size(), 3 + arg_count);
+  const std::vector<std::string> args(request.fields.begin() + 3, request.fields.begin() + static_cast<std::ptrdiff_t>(args_end));
+  std::vector<std::string> environment(request.fields.begin() + static_cast<std::ptrdiff_t>(args_end), request.fields.end());
+  std::vector<char*> environment_pointers;
+  for (auto& variable : environment) {
+    environment_pointers.push_back(variable.data());
+  }
+  environment_pointers.push_back(nullptr);
+  environ = environment_pointers.data();
+
+  int exit_code = EXIT_FAILURE;
+  if (chdir(request.fields[1].c_str()) != 0) {
+    fmt::print(stderr, "Error: the sail daemon could not enter {}: {}\n", request.fields[1], std::strerror(errno));
+  } else {
+    try {
+      exit_code = handlers.run(args);
+    } catch (const std::exception& e) {
+      fmt::print(stderr, "Error: {}\n", e.what());
+    }
+  }
+  std::fflush(nullptr);
+  _exit(exit_code);
+}
+
+}// namespace
+
+std::optional<int> forward_to_daemon(const std::filesystem::path& socket_path, const std::vector<std::string>& args) {
+  const int fd = connect_to(socket_path);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+  std::error_code error;
+  std::vector<std::string> fields = { "run", std::filesystem::current_path(error).string(), std::to_string(args.size()) };
+  fields.insert(fields.end(), args.begin(), args.end());
+  for (char** variable = environ; *variable != nullptr; ++variable) {
+    fields.emplace_back(*variable);
+  }
+  if (error || !send_request(fd, fields, true)) {
+    close(fd);
+    return std::nullopt;
+  }
+  std::int32_t exit_code = EXIT_FAILURE;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const bool answered = read_all(fd, reinterpret_cast<char*>(&exit_code), sizeof(exit_code));
+  close(fd);
+  if (!answered) {
+    fmt::print(stderr, "Error: the sail daemon stopped before the command finished\n");
+    return EXIT_FAILURE;
+  }
+  return exit_code;
+}
+
+bool stop_daemon(const std::filesystem::path& socket_path) {
+  const int fd = connect_to(socket_path);
+  if (fd < 0) {
+    return false;
+  }
+  std::int32_t exit_code = EXIT_FAILURE;
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  const bool stopped = send_request(fd, { "stop" }, false) && read_all(fd, reinterpret_cast<char*>(&exit_code), sizeof(exit_code));
+  close(fd);
+  return stopped;
+}
+
+// cppcheck-suppress normalCheckLevelMaxBranches
+int serve_daemon(const std::filesystem::path& socket_path, const DaemonHandlers& handlers) {
+  sockaddr_un address{};
+  if (!fill_address(address, socket_path)) {
+    fmt::print("Error: {} is too long a path for a socket; move the project to a shorter path to use sail daemon\n",
+      socket_path.string());
+    return EXIT_FAILURE;
+  }
+  std::error_code error;
+  if (std::filesystem::exists(socket_path, error)) {
+    const int probe = connect_to(socket_path);
+    if (probe >= 0) {
+      close(probe);
+      fmt::print("Error: a sail daemon is already listening at {}\n", socket_path.string());
+      return EXIT_FAILURE;
+    }
+    std::filesystem::remove(socket_path, error);
+  }
+  std::filesystem::create_directories(socket_path.parent_path(), error);
+
+  const int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listen_fd, 16) != 0) {
+    fmt::print("Error: could not listen at {}: {}\n", socket_path.string(), std::strerror(errno));
+    if (listen_fd >= 0) {
+      close(listen_fd);
+    }
+    return EXIT_FAILURE;
+  }
+  set_cloexec(listen_fd);
+
+  // No SA_RESTART, so that poll() returns as soon as a signal asks the daemon to stop
+  stop_requested = 0;
+  struct sigaction stop_action{};
+  stop_action.sa_handler = request_stop;
+  sigemptyset(&stop_action.sa_mask);
+  sigaction(SIGINT, &stop_action, nullptr);
+  sigaction(SIGTERM, &stop_action, nullptr);
+  std::signal(SIGPIPE, SIG_IGN);
+  if (pipe(wake_pipe.data()) != 0) {
+    fmt::print("Error: could not create a pipe: {}\n", std::strerror(errno));
+    close(listen_fd);
+    return EXIT_FAILURE;
+  }
+  for (const int fd : wake_pipe) {
+    set_cloexec(fd);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+  struct sigaction child_action{};
+  child_action.sa_handler = wake_on_child_exit;
+  sigemptyset(&child_action.sa_mask);
+  child_action.sa_flags = SA_NOCLDSTOP;
+  sigaction(SIGCHLD, &child_action, nullptr);
+
+  // Running workers and the connection of the client each one answers; -1 once the client went away
+  std::map<pid_t, int> workers;
+  // Connections whose request has not arrived yet, and until when it may
+  std::map<int, std::chrono::steady_clock::time_point> pending;
+  const auto reap = [&](bool wait) {
+    for (auto worker = workers.begin(); worker != workers.end();) {
+      int status = 0;
+      if (waitpid(worker->first, &status, wait ? 0 : WNOHANG) != worker->first) {
+        ++worker;
+        continue;
+      }
+      if (worker->second >= 0) {
+        send_exit_code(worker->second, exit_code_of(status));
+        close(worker->second);
+      }
+      worker = workers.erase(worker);
+    }
+  };
+
+  // Carry out a request that arrived on `connection`; false once it asked the daemon to stop
+  const auto carry_out = [&](int connection, const Request& request) {
+    if (request.fields[0] == "stop") {
+      send_exit_code(connection, EXIT_SUCCESS);
+      close(connection);
+      return false;
+    }
+
+    try {
+      if (handlers.prepare) {
+        handlers.prepare();
+      }
+    } catch (const std::exception& e) {
+      fmt::print("Warning: {}\n", e.what());
+    }
+    std::vector<int> daemon_fds = { listen_fd, wake_pipe[0], wake_pipe[1], connection };
+    for (const auto& [pid, fd] : workers) {
+      if (fd >= 0) {
+        daemon_fds.push_back(fd);
+      }
+    }
+    for (const auto& [fd, deadline] : pending) {
+      daemon_fds.push_back(fd);
+    }
+    std::fflush(nullptr);
+    const pid_t pid = fork();
+    if (pid == 0) {
+      run_worker(request, daemon_fds, handlers);
+    }
+    for (const int passed : request.fds) {
+      close(passed);
+    }
+    if (pid > 0) {
+      // Also done here, so that the group exists before the parent may have to kill it
+      setpgid(pid, pid);
+    }
+    if (pid < 0) {
+      fmt::print("Warning: could not start a worker: {}\n", std::strerror(errno));
+      send_exit_code(connection, EXIT_FAILURE);
+      close(connection);
+      return true;
+    }
+    workers[pid] = connection;
+    return true;
+  };
+
+  fmt::print("sail daemon listening at {} (Ctrl+C or sail daemon --stop to stop)\n", socket_path.string());
+  std::fflush(stdout);
+  bool serving = true;
+  while (serving && stop_requested == 0) {
+    reap(false);
+    const auto now = std::chrono::steady_clock::now();
+    for (auto connection = pending.begin(); connection != pending.end();) {
+      if (connection->second > now) {
+        ++connection;
+        continue;
+      }
+      close(connection->first);
+      connection = pending.erase(connection);
+    }
+
+    std::vector<pollfd> watched = { pollfd{ listen_fd, POLLIN, 0 }, pollfd{ wake_pipe[0], POLLIN, 0 } };
+    std::vector<pid_t> watched_workers;
+    for (const auto& [pid, fd] : workers) {
+      if (fd >= 0) {
+        watched.push_back(pollfd{ fd, POLLIN, 0 });
+        watched_workers.push_back(pid);
+      }
+    }
+    const size_t first_pending = watched.size();
+    for (const auto& [fd, deadline] : pending) {
+      watched.push_back(pollfd{ fd, POLLIN, 0 });
+    }
+    if (poll(watched.data(), watched.size(), 1000) <= 0) {
+      continue;
+    }
+    if (watched[1].revents != 0) {
+      std::array<char, 64> drained{};
+      while (read(wake_pipe[0], drained.data(), drained.size()) > 0) {
+      }
+    }
+
+    // A client sends nothing after its request, so a readable connection means it went away
+    for (size_t i = 2; i < first_pending; ++i) {
+      if (watched[i].revents != 0) {
+        const pid_t pid = watched_workers[i - 2];
+        kill(-pid, SIGTERM);
+        close(workers[pid]);
+        workers[pid] = -1;
+      }
+    }
+
+    // Requests are only read once they have started to arrive, so a client that connects and sends
+    // nothing holds up no one else; one that stops halfway is cut off by the receive timeout
+    for (size_t i = first_pending; i < watched.size() && serving; ++i) {
+      if (watched[i].revents == 0) {
+        continue;
+      }
+      const int connection = watched[i].fd;
+      pending.erase(connection);
+      const auto request = receive_request(connection);
+      if (!request) {
+        close(connection);
+        continue;
+      }
+      serving = carry_out(connection, *request);
+    }
+
+    if ((watched[0].revents & POLLIN) == 0 || !serving) {
+      continue;
+    }
+    const int connection = accept(listen_fd, nullptr, nullptr);
+    if (connection < 0) {
+      continue;
+    }
+    set_cloexec(connection);
+    if (!is_own_user(connection)) {
+      close(connection);
+      continue;
+    }
+    timeval timeout{};
+    timeout.tv_sec = request_timeout.count();
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    pending[connection] = std::chrono::steady_clock::now() + request_timeout;
+  }
+
+  for (const auto& [fd, deadline] : pending) {
+    close(fd);
+  }
+  for (const auto& [pid, fd] : workers) {
+    kill(-pid, SIGTERM);
+  }
+  reap(true);
+  std::signal(SIGCHLD, SIG_DFL);
+  for (int& fd : wake_pipe) {
+    close(fd);
+    fd = -1;
+  }
+  close(listen_fd);
+  std::filesystem::remove(socket_path, error);
+  std::signal(SIGINT, SIG_DFL);
+  std::signal(SIGTERM, SIG_DFL);
+  fmt::print("sail daemon stopped\n");
+  return EXIT_SUCCESS;
+}
+
+#endif
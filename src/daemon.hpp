@@ -0,0 +1,39 @@
+#ifndef SAIL_DAEMON_HPP
+#define SAIL_DAEMON_HPP
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Where `sail daemon` listens for the project at `project_root`: target/daemon.sock
+[[nodiscard]] std::filesystem::path daemon_socket_path(const std::filesystem::path& project_root);
+
+// Hand a command line (without the program name) to the daemon listening at `socket_path`, along
+// with sail's working directory, environment and standard input, output and error, and wait for
+// it to be carried out. Returns its exit code, or std::nullopt if no daemon is listening there, in
+// which case the caller runs the command itself. A daemon that goes away mid-command counts as a failure.
+[[nodiscard]] std::optional<int> forward_to_daemon(const std::filesystem::path& socket_path, const std::vector<std::string>& args);
+
+// Ask the daemon at `socket_path` to stop; returns false if none was listening
+bool stop_daemon(const std::filesystem::path& socket_path);
+
+struct DaemonHandlers
+{
+  // Runs in the daemon before each command, to bring the state it keeps for every command up to date
+  std::function<void()> prepare;
+  // Carries out a forwarded command line in a child forked from the daemon for it, so it starts with
+  // all of the daemon's state. The child has the client's working directory, environment and stdio,
+  // and its own process group, which is killed if the client goes away. Returns the exit code.
+  std::function<int(const std::vector<std::string>&)> run;
+};
+
+// Listen at `socket_path` until stop_daemon() or SIGINT/SIGTERM, running every forwarded command
+// line with `handlers`; several run at once if several clients connect. Only clients running as the
+// daemon's user are served, and one that does not send its request in time is dropped. A stale socket left by a
+// daemon that died is replaced. Returns EXIT_FAILURE, after saying why, if it cannot listen there:
+// another daemon is listening, the path is too long for a socket, or the platform is Windows.
+[[nodiscard]] int serve_daemon(const std::filesystem::path& socket_path, const DaemonHandlers& handlers);
+
+#endif
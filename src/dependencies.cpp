@@ -0,0 +1,387 @@
+#include "dependencies.hpp"
+#include "process.hpp"
+#include "toml.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fmt/format.h>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+
+namespace {
+
+// Well-known packages that can be requested by name and version alone
+struct RegistryEntry
+{
+  std::string_view name;
+  std::string_view repository;
+  std::string_view tag_format;
+  std::string_view target;
+};
+
+constexpr std::array<RegistryEntry, 9> registry{ {
+  { "benchmark", "https://github.com/google/benchmark.git", "v{}", "benchmark::benchmark" },
+  { "catch2", "https://github.com/catchorg/Catch2.git", "v{}", "Catch2::Catch2WithMain" },
+  { "cli11", "https://github.com/CLIUtils/CLI11.git", "v{}", "CLI11::CLI11" },
+  { "fmt", "https://github.com/fmtlib/fmt.git", "{}", "fmt::fmt" },
+  { "ftxui", "https://github.com/ArthurSonzogni/FTXUI.git", "v{}", "ftxui::component" },
+  { "googletest", "https://github.com/google/googletest.git", "v{}", "GTest::gtest_main" },
+  { "nanobench", "https://github.com/martinus/nanobench.git", "v{}", "nanobench" },
+  { "nlohmann_json", "https://github.com/nlohmann/json.git", "v{}", "nlohmann_json::nlohmann_json" },
+  { "spdlog", "https://github.com/gabime/spdlog.git", "v{}", "spdlog::spdlog" },
+} };
+
+std::string to_lower(std::string_view text) {
+  std::string lower(text);
+  std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char character) {
+    return static_cast<char>(std::tolower(character));
+  });
+  return lower;
+}
+
+bool is_commit_hash(std::string_view text) {
+  return text.size() == 40 && std::all_of(text.begin(), text.end(), [](unsigned char character) {
+    return std::isxdigit(character) != 0;
+  });
+}
+
+// Turn registry shorthand into an explicit git dependency
+DependencySpec expand_registry_dependency(const DependencySpec& dependency) {
+  const std::string lower_name = to_lower(dependency.name);
+  const auto entry = std::find_if(registry.begin(), registry.end(), [&](const RegistryEntry& candidate) {
+    return candidate.name == lower_name;
+  });
+  if (entry == registry.end()) {
+    throw std::runtime_error(fmt::format(
+      "Dependency '{}' is not in sail's registry; use {{ git = \"<url>\", tag = \"<tag>\" }} or {{ path = \"<dir>\" }}",
+      dependency.name));
+  }
+  DependencySpec expanded = dependency;
+  expanded.git = entry->repository;
+  expanded.tag = fmt::format(fmt::runtime(entry->tag_format), dependency.version);
+  if (expanded.targets.empty()) {
+    expanded.targets.emplace_back(entry->target);
+  }
+  return expanded;
+}
+
+// Ask the remote which commit a tag, branch or HEAD points at
+std::string resolve_remote_commit(const DependencySpec& dependency) {
+  if (is_commit_hash(dependency.rev)) {
+    return to_lower(dependency.rev);
+  }
+
+  std::vector<std::string> command = { "git", "ls-remote", dependency.git };
+  if (!dependency.tag.empty()) {
+    command.push_back("refs/tags/" + dependency.tag);
+    command.push_back(fmt::format("refs/tags/{}^{{}}", dependency.tag));
+  } else if (!dependency.branch.empty()) {
+    command.push_back("refs/heads/" + dependency.branch);
+  } else {
+    command.emplace_back("HEAD");
+  }
+  const auto output = run_capture(command);
+  if (!output) {
+    throw std::runtime_error(fmt::format("Failed to query {} for dependency '{}'", dependency.git, dependency.name));
+  }
+
+  // Annotated tags list the tag object first and the commit it points at as "<tag>^{}"
+  std::string commit;
+  std::istringstream lines(*output);
+  std::string line;
+  while (std::getline(lines, line)) {
+    const size_t tab = line.find('\t');
+    if (tab == std::string::npos) {
+      continue;
+    }
+    const std::string hash = line.substr(0, tab);
+    if (commit.empty() || line.compare(line.size() - 3, 3, "^{}") == 0) {
+      commit = hash;
+    }
+  }
+  if (!is_commit_hash(commit)) {
+    throw std::runtime_error(fmt::format("Could not find {} in {} for dependency '{}'",
+      dependency.tag.empty() ? (dependency.branch.empty() ? std::string("HEAD") : dependency.branch) : dependency.tag,
+      dependency.git,
+      dependency.name));
+  }
+  return commit;
+}
+
+std::string unique_suffix() {
+  std::random_device random;
+  return fmt::format("{:08x}", random());
+}
+
+// Check the commit out into the shared cache. The checkout is prepared in a scratch directory and
+// renamed into place, so a directory named after a commit is always complete.
+void fetch_into_cache(const DependencySpec& dependency, const std::string& commit, const std::filesystem::path& cache_dir) {
+  fmt::print("Fetching {} ({} @ {})\n", dependency.name, dependency.git, commit.substr(0, 12));
+
+  const std::filesystem::path scratch_dir = cache_dir.string() + ".tmp-" + unique_suffix();
+  std::filesystem::create_directories(scratch_dir);
+  const auto git = [&](std::initializer_list<std::string> arguments) {
+    std::vector<std::string> command = { "git", "-C", scratch_dir.string() };
+    command.insert(command.end(), arguments);
+    return command;
+  };
+  // Fetch the commit itself, so a branch that moved or a tag that was re-pointed since Sail.lock was
+  // written still yields the locked commit. Servers that refuse fetching by SHA get the ref instead.
+  const std::string ref = !dependency.tag.empty() ? dependency.tag : dependency.branch;
+  const bool fetched = run_capture(git({ "init", "--quiet" }))
+    && (run_capture(git({ "fetch", "--quiet", "--depth", "1", dependency.git, commit }))
+        || (!ref.empty() && run_capture(git({ "fetch", "--quiet", "--depth", "1", dependency.git, ref }))))
+    && run_capture(git({ "-c", "advice.detachedHead=false", "checkout", "--quiet", "FETCH_HEAD" }));
+  const auto fetched_commit = fetched ? run_capture(git({ "rev-parse", "HEAD" })) : std::nullopt;
+  if (!fetched_commit || fetched_commit->compare(0, commit.size(), commit) != 0) {
+    std::error_code error;
+    std::filesystem::remove_all(scratch_dir, error);
+    throw std::runtime_error(fmt::format("Failed to fetch dependency '{}' from {}", dependency.name, dependency.git));
+  }
+
+  std::filesystem::remove_all(scratch_dir / ".git");
+  std::error_code error;
+  std::filesystem::rename(scratch_dir, cache_dir, error);
+  if (error) {
+    // Another sail process finished the same checkout first
+    std::filesystem::remove_all(scratch_dir, error);
+    if (!std::filesystem::exists(cache_dir)) {
+      throw std::runtime_error(fmt::format("Failed to store dependency '{}' in {}", dependency.name, cache_dir.string()));
+    }
+  }
+}
+
+// Where a dependency comes from. A Sail.lock entry only applies while this is unchanged.
+std::string source_id(const DependencySpec& spec) {
+  if (!spec.path.empty()) {
+    return "path+" + spec.path;
+  }
+  std::string id = "git+" + spec.git;
+  if (!spec.tag.empty()) {
+    id += "?tag=" + spec.tag;
+  } else if (!spec.branch.empty()) {
+    id += "?branch=" + spec.branch;
+  } else if (!spec.rev.empty()) {
+    id += "?rev=" + spec.rev;
+  }
+  return id;
+}
+
+struct LockedPackage
+{
+  std::string source;
+  std::string commit;
+};
+
+// Entries of an existing Sail.lock by name; a missing or unreadable lock pins nothing
+std::map<std::string, LockedPackage, std::less<>> read_lockfile(const std::filesystem::path& lock_path) {
+  std::map<std::string, LockedPackage, std::less<>> packages;
+  const auto content = read_file(lock_path);
+  if (!content) {
+    return packages;
+  }
+  TomlValue document;
+  try {
+    document = parse_toml(*content, lock_path.string());
+  } catch (const TomlParseError&) {
+    fmt::print("Warning: Ignoring unreadable Sail.lock\n");
+    return packages;
+  }
+  const TomlValue* entries = document.find("package");
+  if (entries == nullptr || entries->type != TomlValue::Type::Array) {
+    return packages;
+  }
+  for (const auto& entry : entries->array) {
+    const TomlValue* name = entry.find("name");
+    const TomlValue* source = entry.find("source");
+    const TomlValue* commit = entry.find("commit");
+    if (name == nullptr || source == nullptr || name->type != TomlValue::Type::String
+        || source->type != TomlValue::Type::String) {
+      continue;
+    }
+    packages[name->string] = LockedPackage{ source->string,
+      commit != nullptr && commit->type == TomlValue::Type::String ? commit->string : std::string() };
+  }
+  return packages;
+}
+
+// Quote a TOML basic string
+std::string toml_quote(std::string_view text) {
+  std::string quoted = "\"";
+  for (const char character : text) {
+    switch (character) {
+    case '"': quoted += "\\\""; break;
+    case '\\': quoted += "\\\\"; break;
+    case '\n': quoted += "\\n"; break;
+    case '\t': quoted += "\\t"; break;
+    default: quoted += character; break;
+    }
+  }
+  quoted += '"';
+  return quoted;
+}
+
+}// namespace
+
+std::filesystem::path sail_home() {
+  const std::string home_override = get_env("SAIL_HOME");
+  if (!home_override.empty()) {
+    return home_override;
+  }
+#ifdef _WIN32
+  const std::string home = get_env("USERPROFILE");
+#else
+  const std::string home = get_env("HOME");
+#endif
+  if (home.empty()) {
+    throw std::runtime_error("Cannot locate the home directory; set SAIL_HOME");
+  }
+  return std::filesystem::path(home) / ".sail";
+}
+
+std::vector<ResolvedDependency> resolve_dependencies(const Manifest& manifest,
+                                                     const std::filesystem::path& project_root,
+                                                     bool locked) {
+  std::vector<ResolvedDependency> resolved;
+  const std::filesystem::path lock_path = project_root / "Sail.lock";
+  if (manifest.dependencies.empty() && !std::filesystem::exists(lock_path)) {
+    return resolved;
+  }
+
+  const auto locked_packages = read_lockfile(lock_path);
+  std::string lock_content = "# Generated by sail from [dependencies] in Sail.toml. Do not edit.\nversion = 1\n";
+  for (const auto& declared : manifest.dependencies) {
+    ResolvedDependency dependency;
+    dependency.name = declared.name;
+    dependency.targets = declared.targets;
+    dependency.options = declared.options;
+
+    const DependencySpec spec = declared.git.empty() && declared.path.empty() ? expand_registry_dependency(declared) : declared;
+    const std::string source = source_id(spec);
+    lock_content += fmt::format("\n[[package]]\nname = {}\nsource = {}\n", toml_quote(declared.name), toml_quote(source));
+
+    if (!spec.path.empty()) {
+      dependency.source_dir = std::filesystem::weakly_canonical(project_root / spec.path);
+      if (!std::filesystem::exists(dependency.source_dir / "CMakeLists.txt")) {
+        throw std::runtime_error(fmt::format("Path dependency '{}' has no CMakeLists.txt in {}",
+          declared.name, dependency.source_dir.string()));
+      }
+      resolved.push_back(std::move(dependency));
+      continue;
+    }
+
+    if (dependency.targets.empty()) {
+      dependency.targets = spec.targets;
+    }
+    const auto pinned = locked_packages.find(declared.name);
+    if (pinned != locked_packages.end() && pinned->second.source == source && is_commit_hash(pinned->second.commit)) {
+      dependency.commit = pinned->second.commit;
+    } else if (locked) {
+      throw std::runtime_error(fmt::format("Sail.lock has no entry for '{}' as declared in Sail.toml and --locked was given",
+        declared.name));
+    } else {
+      dependency.commit = resolve_remote_commit(spec);
+    }
+    lock_content += fmt::format("commit = {}\n", toml_quote(dependency.commit));
+
+    dependency.prebuilt = manifest.build.prebuilt && declared.prebuilt;
+    dependency.source_dir = sail_home() / "cache" / "git" / dependency.commit;
+    if (!std::filesystem::exists(dependency.source_dir)) {
+      std::filesystem::create_directories(dependency.source_dir.parent_path());
+      fetch_into_cache(spec, dependency.commit, dependency.source_dir);
+    }
+    resolved.push_back(std::move(dependency));
+  }
+
+  if (locked) {
+    if (read_file(lock_path) != lock_content) {
+      throw std::runtime_error("Sail.lock is out of date with Sail.toml and --locked was given");
+    }
+  } else {
+    write_file_if_changed(lock_path, lock_content);
+  }
+  return resolved;
+}
+
+namespace {
+
+// CMake code making the dependencies' targets available
+std::string dependency_setup_code(const std::vector<ResolvedDependency>& dependencies) {
+  std::string content;
+  // Prebuilt packages may find_dependency() each other, so all of them are searchable
+  for (const auto& dependency : dependencies) {
+    if (!dependency.packages.empty()) {
+      content += fmt::format("list(PREPEND CMAKE_PREFIX_PATH {})\n", cmake_quote(dependency.artifact_dir.generic_string()));
+    }
+  }
+  // A unity build is the project's choice; dependencies are compiled the way their authors wrote them
+  content += "set(CMAKE_UNITY_BUILD OFF)\n";
+  for (const auto& dependency : dependencies) {
+    content += fmt::format("\n# {}\n", dependency.name);
+    if (!dependency.packages.empty()) {
+      for (const auto& package : dependency.packages) {
+        content += fmt::format("find_package({} CONFIG REQUIRED PATHS {} NO_DEFAULT_PATH)\n",
+          package, cmake_quote(dependency.artifact_dir.generic_string()));
+      }
+    } else {
+      for (const auto& [option, value] : dependency.options) {
+        content += fmt::format("set({} {} CACHE INTERNAL \"\")\n", option, cmake_quote(value));
+      }
+      content += fmt::format("add_subdirectory({} \"${{CMAKE_BINARY_DIR}}/_deps/{}\" EXCLUDE_FROM_ALL)\n",
+        cmake_quote(dependency.source_dir.generic_string()), dependency.name);
+    }
+  }
+  content += "\nunset(CMAKE_UNITY_BUILD)\n";
+  return content;
+}
+
+// CMake code collecting the targets to link in SAIL_DEPENDENCY_TARGETS
+std::string dependency_targets_code(const std::vector<ResolvedDependency>& dependencies) {
+  std::string content = "set(SAIL_DEPENDENCY_TARGETS)\n";
+  for (const auto& dependency : dependencies) {
+    if (!dependency.targets.empty()) {
+      for (const auto& target : dependency.targets) {
+        content += fmt::format("list(APPEND SAIL_DEPENDENCY_TARGETS {})\n", target);
+      }
+      continue;
+    }
+    // Without explicit targets, link the conventional <name>::<name> or plain <name>
+    content += fmt::format(R"(if(TARGET {0}::{0})
+  list(APPEND SAIL_DEPENDENCY_TARGETS {0}::{0})
+elseif(TARGET {0})
+  list(APPEND SAIL_DEPENDENCY_TARGETS {0})
+else()
+  message(FATAL_ERROR "Dependency '{0}' has no target named {0}::{0} or {0}; list its targets in Sail.toml")
+endif()
+)", dependency.name);
+  }
+  return content;
+}
+
+}// namespace
+
+void write_dependencies_manifest(const std::filesystem::path& manifest_path,
+                                 const std::vector<ResolvedDependency>& dependencies) {
+  write_file_if_changed(manifest_path, "# Generated by sail from [dependencies] in Sail.toml. Do not edit.\n"
+    + dependency_setup_code(dependencies) + "\n" + dependency_targets_code(dependencies));
+}
+
+void write_shared_dependencies_manifest(const std::filesystem::path& manifest_path,
+                                        const std::vector<ResolvedDependency>& dependencies) {
+  write_file_if_changed(manifest_path, "# Generated by sail from the [dependencies] of the workspace members. Do not edit.\n"
+    + dependency_setup_code(dependencies));
+}
+
+void write_dependency_targets_manifest(const std::filesystem::path& manifest_path,
+                                       const std::vector<ResolvedDependency>& dependencies) {
+  write_file_if_changed(manifest_path, "# Generated by sail from [dependencies] in Sail.toml. Do not edit.\n"
+    + dependency_targets_code(dependencies));
+}
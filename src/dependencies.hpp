@@ -0,0 +1,52 @@
+#ifndef SAIL_DEPENDENCIES_HPP
+#define SAIL_DEPENDENCIES_HPP
+
+#include "manifest.hpp"
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A dependency whose sources are available on disk
+struct ResolvedDependency
+{
+  std::string name;
+  std::filesystem::path source_dir;
+  // Commit the sources were checked out at; empty for path dependencies
+  std::string commit;
+  std::vector<std::string> targets;
+  std::vector<std::pair<std::string, std::string>> options;
+  // Whether the dependency may be consumed as a prebuilt artifact instead of add_subdirectory()
+  bool prebuilt = false;
+  // Install prefix of the prebuilt artifact and the CMake packages found in it; empty when built from source
+  std::filesystem::path artifact_dir;
+  std::vector<std::string> packages;
+};
+
+// Root of sail's per-user state: SAIL_HOME, or ~/.sail
+[[nodiscard]] std::filesystem::path sail_home();
+
+// Make every dependency of the manifest available. Git sources are fetched once into
+// <sail_home>/cache/git/<commit> and shared by all projects; path dependencies are used in place.
+// Commits are pinned in <project_root>/Sail.lock: entries whose source is unchanged in Sail.toml are
+// used without asking the remote, and the lock is rewritten when anything else changes. With
+// `locked`, a lock that would change is an error instead.
+// Throws std::runtime_error if a dependency cannot be resolved or fetched.
+[[nodiscard]] std::vector<ResolvedDependency> resolve_dependencies(const Manifest& manifest,
+                                                                   const std::filesystem::path& project_root,
+                                                                   bool locked = false);
+
+// Write target/<mode>/dependencies.cmake, which adds each dependency to the generated build and
+// collects the targets to link in SAIL_DEPENDENCY_TARGETS. Only rewritten when its content changes.
+void write_dependencies_manifest(const std::filesystem::path& manifest_path,
+                                 const std::vector<ResolvedDependency>& dependencies);
+
+// The two halves of write_dependencies_manifest for workspaces: the workspace root adds every
+// dependency once, and each member only collects the targets it links
+void write_shared_dependencies_manifest(const std::filesystem::path& manifest_path,
+                                        const std::vector<ResolvedDependency>& dependencies);
+void write_dependency_targets_manifest(const std::filesystem::path& manifest_path,
+                                       const std::vector<ResolvedDependency>& dependencies);
+
+#endif
@@ -0,0 +1,51 @@
+#include "distributed.hpp"
+#include "util.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fmt/format.h>
+#include <stdexcept>
+
+DistributedCompilation resolve_distributed(const DistributedSection& distributed, const std::string& cache_launcher,
+                                           unsigned local_cores) {
+  const auto backend = find_program(distributed.backend);
+  if (!backend) {
+    throw std::runtime_error(fmt::format("[build] distributed uses {}, which was not found on PATH", distributed.backend));
+  }
+
+  DistributedCompilation compilation;
+  compilation.jobs = distributed.jobs.value_or(4 * local_cores);
+  const bool behind_ccache = (distributed.backend == "distcc" || distributed.backend == "icecc")
+    && !cache_launcher.empty() && std::filesystem::path(cache_launcher).stem() == "ccache";
+  if (behind_ccache) {
+    compilation.launcher = cache_launcher;
+    compilation.environment.emplace_back("CCACHE_PREFIX", backend->string());
+  } else {
+    compilation.launcher = backend->string();
+  }
+  if (distributed.hosts) {
+    compilation.environment.emplace_back("DISTCC_HOSTS", *distributed.hosts);
+  }
+  if (distributed.endpoint) {
+    compilation.environment.emplace_back("RECC_SERVER", *distributed.endpoint);
+  }
+  if (distributed.instance) {
+    compilation.environment.emplace_back("RECC_INSTANCE", *distributed.instance);
+  }
+  return compilation;
+}
+
+std::string distributed_cmake_code(unsigned local_cores) {
+  return fmt::format("set_property(GLOBAL APPEND PROPERTY JOB_POOLS sail_link={})\n"
+                     "set(CMAKE_JOB_POOL_LINK sail_link)\n", local_cores);
+}
+
+void export_environment(const std::vector<std::pair<std::string, std::string>>& environment) {
+  for (const auto& [name, value] : environment) {
+#ifdef _WIN32
+    _putenv_s(name.c_str(), value.c_str());
+#else
+    setenv(name.c_str(), value.c_str(), 1);  // NOLINT(concurrency-mt-unsafe)
+#endif
+  }
+}
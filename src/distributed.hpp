@@ -0,0 +1,37 @@
+#ifndef SAIL_DISTRIBUTED_HPP
+#define SAIL_DISTRIBUTED_HPP
+
+#include "manifest.hpp"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// How compile jobs reach the pool of [build] distributed
+struct DistributedCompilation
+{
+  // Goes in front of every compile command, in place of the compiler cache launcher
+  std::string launcher;
+  // Variables the backend reads its settings from, set for the whole build
+  std::vector<std::pair<std::string, std::string>> environment;
+  // Compile jobs in flight: [build.distributed] jobs, or four per local core
+  unsigned jobs = 0;
+};
+
+// Put the backend in front of the compiler. distcc and icecc go behind ccache, as its CCACHE_PREFIX,
+// when the cache launcher is ccache, so that cached objects are still not compiled at all; otherwise
+// they replace the cache launcher. sccache distributes through its own sccache-dist scheduler and
+// recc through a Remote Execution API endpoint. Both keep their own cache, and recc uploads only
+// the inputs the remote's content store is missing. Throws std::runtime_error if the backend is
+// not on PATH.
+[[nodiscard]] DistributedCompilation resolve_distributed(const DistributedSection& distributed, const std::string& cache_launcher,
+                                                         unsigned local_cores);
+
+// CMake code for the project include: links stay within the local cores while compiles go wide.
+// Only the Ninja generators know job pools; the others ignore it.
+[[nodiscard]] std::string distributed_cmake_code(unsigned local_cores);
+
+// Set the variables for every program sail starts from now on
+void export_environment(const std::vector<std::pair<std::string, std::string>>& environment);
+
+#endif
@@ -0,0 +1,338 @@
+#include "file_watcher.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#include <array>
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <thread>
+#endif
+
+namespace {
+
+// A directory to watch and whether everything below it is watched as well
+struct WatchedDirectory
+{
+  std::filesystem::path path;
+  bool recursive = false;
+};
+
+}// namespace
+
+#if defined(__linux__)
+
+struct FileWatcher::Backend
+{
+  static constexpr uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+  int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  std::map<int, WatchedDirectory> watches;
+
+  explicit Backend(const std::vector<WatchedDirectory>& directories) {
+    for (const auto& directory : directories) {
+      add(directory.path, directory.recursive);
+    }
+  }
+  ~Backend() {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+  Backend(const Backend&) = delete;
+  Backend& operator=(const Backend&) = delete;
+  Backend(Backend&&) = delete;
+  Backend& operator=(Backend&&) = delete;
+
+  // inotify watches one directory at a time, so a tree needs a watch per directory
+  void add(const std::filesystem::path& directory, bool recursive) {
+    const int watch = inotify_add_watch(fd, directory.c_str(), mask);
+    if (watch < 0) {
+      return;
+    }
+    // The same directory may be asked for twice; once recursive means recursive
+    WatchedDirectory& watched = watches[watch];
+    watched.path = directory;
+    watched.recursive = watched.recursive || recursive;
+    if (!recursive) {
+      return;
+    }
+    std::error_code error;
+    for (std::filesystem::directory_iterator entry(directory, std::filesystem::directory_options::skip_permission_denied, error), end;
+         !error && entry != end; entry.increment(error)) {
+      if (entry->is_directory(error)) {
+        add(entry->path(), true);
+      }
+    }
+  }
+
+  void poll_changes(std::chrono::milliseconds timeout, std::vector<std::filesystem::path>& changed) {
+    if (fd < 0) {
+      return;
+    }
+    pollfd descriptor{ fd, POLLIN, 0 };
+    if (poll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0) {
+      return;
+    }
+    alignas(inotify_event) std::array<char, 16384> buffer{};
+    while (true) {
+      const ssize_t count = read(fd, buffer.data(), buffer.size());
+      if (count <= 0) {
+        return;
+      }
+      for (ssize_t offset = 0; offset < count;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        const auto watch = watches.find(event->wd);
+        if (watch == watches.end()) {
+          continue;
+        }
+        if ((event->mask & IN_IGNORED) != 0) {
+          watches.erase(watch);
+          continue;
+        }
+        const std::filesystem::path path = event->len > 0 ? watch->second.path / event->name : watch->second.path;
+        if (watch->second.recursive && (event->mask & IN_ISDIR) != 0 && (event->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+          add(path, true);
+        }
+        changed.push_back(path);
+      }
+    }
+  }
+};
+
+#elif defined(_WIN32)
+
+struct FileWatcher::Backend
+{
+  // One pending ReadDirectoryChangesW per directory; Windows watches whole trees by itself
+  struct Watch
+  {
+    WatchedDirectory directory;
+    HANDLE handle = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped{};
+    std::vector<DWORD> buffer = std::vector<DWORD>(16384);
+  };
+
+  std::vector<std::unique_ptr<Watch>> watches;
+
+  explicit Backend(const std::vector<WatchedDirectory>& directories) {
+    for (const auto& directory : directories) {
+      auto watch = std::make_unique<Watch>();
+      watch->directory = directory;
+      watch->handle = CreateFileW(directory.path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                  nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+      if (watch->handle == INVALID_HANDLE_VALUE) {
+        continue;
+      }
+      watch->overlapped.hEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+      if (start(*watch)) {
+        watches.push_back(std::move(watch));
+      } else {
+        CloseHandle(watch->overlapped.hEvent);
+        CloseHandle(watch->handle);
+      }
+    }
+  }
+  ~Backend() {
+    for (const auto& watch : watches) {
+      CancelIo(watch->handle);
+      CloseHandle(watch->overlapped.hEvent);
+      CloseHandle(watch->handle);
+    }
+  }
+  Backend(const Backend&) = delete;
+  Backend& operator=(const Backend&) = delete;
+  Backend(Backend&&) = delete;
+  Backend& operator=(Backend&&) = delete;
+
+  static bool start(Watch& watch) {
+    ResetEvent(watch.overlapped.hEvent);
+    return ReadDirectoryChangesW(watch.handle, watch.buffer.data(), static_cast<DWORD>(watch.buffer.size() * sizeof(DWORD)),
+                                 watch.directory.recursive ? TRUE : FALSE,
+                                 FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE,
+                                 nullptr, &watch.overlapped, nullptr)
+           != FALSE;
+  }
+
+  void poll_changes(std::chrono::milliseconds timeout, std::vector<std::filesystem::path>& changed) {
+    if (watches.empty()) {
+      Sleep(static_cast<DWORD>(timeout.count()));
+      return;
+    }
+    std::vector<HANDLE> events;
+    for (const auto& watch : watches) {
+      events.push_back(watch->overlapped.hEvent);
+    }
+    if (WaitForMultipleObjects(static_cast<DWORD>(events.size()), events.data(), FALSE, static_cast<DWORD>(timeout.count())) == WAIT_TIMEOUT) {
+      return;
+    }
+    for (const auto& watch : watches) {
+      DWORD bytes = 0;
+      if (WaitForSingleObject(watch->overlapped.hEvent, 0) != WAIT_OBJECT_0
+          || GetOverlappedResult(watch->handle, &watch->overlapped, &bytes, FALSE) == FALSE) {
+        continue;
+      }
+      // An overflowed buffer reports nothing in particular; the directory itself changed
+      if (bytes == 0) {
+        changed.push_back(watch->directory.path);
+      }
+      const auto* bytes_begin = reinterpret_cast<const char*>(watch->buffer.data());  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+      for (DWORD offset = 0; bytes > 0;) {
+        const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(bytes_begin + offset);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+        changed.push_back(watch->directory.path / std::wstring(info->FileName, info->FileNameLength / sizeof(wchar_t)));
+        if (info->NextEntryOffset == 0) {
+          break;
+        }
+        offset += info->NextEntryOffset;
+      }
+      start(*watch);
+    }
+  }
+};
+
+#else
+
+struct FileWatcher::Backend
+{
+  using Snapshot = std::map<std::filesystem::path, std::pair<std::filesystem::file_time_type, std::uintmax_t>>;
+
+  static constexpr std::chrono::milliseconds scan_interval{ 250 };
+
+  std::vector<WatchedDirectory> directories;
+  Snapshot snapshot;
+
+  explicit Backend(std::vector<WatchedDirectory> watched) : directories(std::move(watched)), snapshot(scan()) {}
+
+  [[nodiscard]] Snapshot scan() const {
+    Snapshot files;
+    const auto remember = [&](const std::filesystem::directory_entry& entry) {
+      std::error_code error;
+      const auto time = entry.last_write_time(error);
+      const auto size = entry.is_regular_file(error) ? entry.file_size(error) : 0;
+      files[entry.path()] = { time, size };
+    };
+    for (const auto& directory : directories) {
+      std::error_code error;
+      if (directory.recursive) {
+        for (std::filesystem::recursive_directory_iterator entry(directory.path, std::filesystem::directory_options::skip_permission_denied, error), end;
+             !error && entry != end; entry.increment(error)) {
+          remember(*entry);
+        }
+      } else {
+        for (std::filesystem::directory_iterator entry(directory.path, error), end; !error && entry != end; entry.increment(error)) {
+          remember(*entry);
+        }
+      }
+    }
+    return files;
+  }
+
+  void poll_changes(std::chrono::milliseconds timeout, std::vector<std::filesystem::path>& changed) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (changed.empty()) {
+      const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+      if (remaining.count() <= 0) {
+        return;
+      }
+      std::this_thread::sleep_for(std::min(remaining, scan_interval));
+      Snapshot current = scan();
+      for (const auto& [path, stamp] : current) {
+        const auto previous = snapshot.find(path);
+        if (previous == snapshot.end() || previous->second != stamp) {
+          changed.push_back(path);
+        }
+      }
+      for (const auto& [path, stamp] : snapshot) {
+        if (current.find(path) == current.end()) {
+          changed.push_back(path);
+        }
+      }
+      snapshot = std::move(current);
+    }
+  }
+};
+
+#endif
+
+FileWatcher::FileWatcher(const std::vector<std::filesystem::path>& paths) {
+  std::vector<WatchedDirectory> directories;
+  std::vector<std::filesystem::path> files;
+  for (const auto& path : paths) {
+    std::error_code error;
+    if (std::filesystem::is_directory(path, error)) {
+      directories.push_back(WatchedDirectory{ std::filesystem::absolute(path), true });
+    } else if (std::filesystem::exists(path, error)) {
+      files.push_back(std::filesystem::absolute(path));
+    }
+  }
+
+  // Editors often save by renaming a new file over the old one, which only the directory sees,
+  // so a single file is watched through its directory unless one of the trees covers it already
+  const auto in_tree = [&](const std::filesystem::path& directory) {
+    return std::any_of(directories.begin(), directories.end(), [&](const WatchedDirectory& tree) {
+      const auto relative = directory.lexically_relative(tree.path);
+      return tree.recursive && !relative.empty() && *relative.begin() != "..";
+    });
+  };
+  for (const auto& file : files) {
+    if (in_tree(file.parent_path())) {
+      continue;
+    }
+    auto& directory_files = files_by_directory[file.parent_path()];
+    if (directory_files.empty()) {
+      directories.push_back(WatchedDirectory{ file.parent_path(), false });
+    }
+    directory_files.insert(file);
+  }
+  backend = std::make_unique<Backend>(directories);
+}
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::collect(std::chrono::milliseconds timeout, std::set<std::filesystem::path>& changes) {
+  std::vector<std::filesystem::path> changed;
+  backend->poll_changes(timeout, changed);
+  bool any = false;
+  for (const auto& path : changed) {
+    const std::string name = path.filename().string();
+    if (name.empty() || name.front() == '.' || name.back() == '~') {
+      continue;
+    }
+    // Other entries of a directory that is only watched for some of its files
+    const auto files = files_by_directory.find(path.parent_path());
+    if (files != files_by_directory.end() && files->second.count(path) == 0) {
+      continue;
+    }
+    any = changes.insert(path).second || any;
+  }
+  return any;
+}
+
+std::vector<std::filesystem::path> FileWatcher::wait_for_changes(std::chrono::milliseconds timeout,
+                                                                 std::chrono::milliseconds quiet_period) {
+  std::set<std::filesystem::path> changes;
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (changes.empty()) {
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      return {};
+    }
+    collect(remaining, changes);
+  }
+  while (collect(quiet_period, changes)) {
+  }
+  return { changes.begin(), changes.end() };
+}
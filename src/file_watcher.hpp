@@ -0,0 +1,44 @@
+#ifndef SAIL_FILE_WATCHER_HPP
+#define SAIL_FILE_WATCHER_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+// Reports changes below a set of directories and to a set of single files. Uses inotify on
+// Linux and ReadDirectoryChangesW on Windows; elsewhere the watched trees are rescanned for
+// changed modification times, which is slower to notice but needs nothing from the system.
+// Hidden files and editor backups ending in '~' are not reported.
+class FileWatcher
+{
+public:
+  // Directories are watched with everything below them, including directories created later.
+  // Paths that do not exist yet are skipped.
+  explicit FileWatcher(const std::vector<std::filesystem::path>& paths);
+  ~FileWatcher();
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+  FileWatcher(FileWatcher&&) = delete;
+  FileWatcher& operator=(FileWatcher&&) = delete;
+
+  // Wait up to `timeout` for a change. Once one arrives, keep collecting until nothing changed for
+  // `quiet_period`, so that a burst of saves is reported once. Returns the changed paths, sorted;
+  // empty if nothing changed before the timeout.
+  [[nodiscard]] std::vector<std::filesystem::path> wait_for_changes(std::chrono::milliseconds timeout,
+                                                                    std::chrono::milliseconds quiet_period);
+
+private:
+  struct Backend;
+
+  // Collect what changed within `timeout` into `changes`; returns false if nothing did
+  bool collect(std::chrono::milliseconds timeout, std::set<std::filesystem::path>& changes);
+
+  std::unique_ptr<Backend> backend;
+  // Single files, by the directory watched for them
+  std::map<std::filesystem::path, std::set<std::filesystem::path>> files_by_directory;
+};
+
+#endif
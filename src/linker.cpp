@@ -0,0 +1,66 @@
+#include "linker.hpp"
+#include "process.hpp"
+#include "util.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <fmt/format.h>
+#include <fstream>
+
+LinkerChoice resolve_linker(const std::optional<std::string>& configured) {
+  if (configured) {
+    return *configured == "default" ? LinkerChoice{} : LinkerChoice{ *configured, true };
+  }
+  // gold is left out: it is slower than both and no longer maintained
+  if (find_program("mold")) {
+    return LinkerChoice{ "mold", false };
+  }
+  if (find_program("ld.lld")) {
+    return LinkerChoice{ "lld", false };
+  }
+  return {};
+}
+
+std::string linker_cmake_code(const LinkerChoice& linker) {
+  if (linker.name.empty()) {
+    return {};
+  }
+  std::string uppercase_name = linker.name;
+  for (char& character : uppercase_name) {
+    character = static_cast<char>(std::toupper(static_cast<unsigned char>(character)));
+  }
+  const std::string unsupported = linker.required
+    ? fmt::format("  message(FATAL_ERROR \"sail: [build] linker = \\\"{0}\\\" does not work with ${{CMAKE_CXX_COMPILER}}\")\n", linker.name)
+    : std::string();
+  return fmt::format("# [build] linker\n"
+                     "if(NOT MSVC)\n"
+                     "  include(CheckLinkerFlag)\n"
+                     "  check_linker_flag(CXX \"-fuse-ld={0}\" SAIL_LINKER_{1}_WORKS)\n"
+                     "endif()\n"
+                     "if(NOT SAIL_LINKER_{1}_WORKS)\n"
+                     "{2}"
+                     "elseif(CMAKE_VERSION VERSION_GREATER_EQUAL 3.29)\n"
+                     "  set(CMAKE_LINKER_TYPE {1})\n"
+                     "else()\n"
+                     "  add_link_options(\"-fuse-ld={0}\")\n"
+                     "endif()\n",
+    linker.name, uppercase_name, unsupported);
+}
+
+bool compiler_supports_linker(const std::string& compiler, const std::string& linker, const std::filesystem::path& probe_dir) {
+  const std::filesystem::path result_path = probe_dir / fmt::format("linker-{}.probe", linker);
+  if (const auto result = read_file(result_path)) {
+    return *result == "yes";
+  }
+
+  std::filesystem::create_directories(probe_dir);
+  const std::filesystem::path probe_source = probe_dir / "linker-probe.cpp";
+  write_file_if_changed(probe_source, "int main() { return 0; }\n");
+  const std::filesystem::path probe_executable = probe_dir / ("linker-probe" + std::string(EXECUTABLE_EXTENSION));
+  const bool works = run_process({ compiler, "-fuse-ld=" + linker, probe_source.string(), "-o", probe_executable.string() },
+                                 ProcessOptions{ ProcessOutput::Capture, std::chrono::seconds(60) })
+                       .success();
+  std::filesystem::remove(probe_executable);
+  std::ofstream(result_path, std::ios::binary) << (works ? "yes" : "no");
+  return works;
+}
@@ -0,0 +1,30 @@
+#ifndef SAIL_LINKER_HPP
+#define SAIL_LINKER_HPP
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+// Linker for the project's executable. An empty name keeps the compiler's default.
+struct LinkerChoice
+{
+  // "mold", "lld", "gold" or "bfd"
+  std::string name;
+  // Set in [build] linker: a compiler that cannot use it is an error. Auto-detected linkers
+  // silently fall back to the default instead.
+  bool required = false;
+};
+
+// [build] linker = "default" keeps the compiler's default. When the key is unset, mold and
+// then lld are used if they are on PATH.
+[[nodiscard]] LinkerChoice resolve_linker(const std::optional<std::string>& configured);
+
+// CMake code applying the choice in the project include; CMAKE_LINKER_TYPE on CMake 3.29+,
+// -fuse-ld before that. Empty for the default linker.
+[[nodiscard]] std::string linker_cmake_code(const LinkerChoice& linker);
+
+// Whether `compiler` can link with the linker; checked once with a test link and remembered
+// in `probe_dir`, which goes away with the objects when the compiler changes
+[[nodiscard]] bool compiler_supports_linker(const std::string& compiler, const std::string& linker, const std::filesystem::path& probe_dir);
+
+#endif
@@ -1,15 +1,24 @@
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <exception>
 #include <fmt/format.h>
 #include <fmt/base.h>
+#include <fmt/ranges.h>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <tuple>
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <fstream>
 #include <filesystem>
 #include <utility>
-#include <spdlog/spdlog.h>
 
 #include <CLI/CLI.hpp>
 
@@ -18,111 +27,228 @@
 // the source template at `configured_files/config.hpp.in`.
 #include <internal_use_only/config.hpp>
 
-#ifdef _WIN32
-    constexpr std::string_view EXECUTABLE_EXTENSION{".exe"};
-#else
-    constexpr std::string_view EXECUTABLE_EXTENSION{};
-#endif
-
-// Helper function to get executable path with correct extension
-std::filesystem::path get_executable_path(const std::filesystem::path& target_dir, const std::string& project_name) {
-  return target_dir / (project_name + std::string(EXECUTABLE_EXTENSION));
-}
-
-// Helper function to quote paths for system commands
-std::string quote_path(const std::string& path) {
-#ifdef _WIN32
-  return "\"" + path + "\"";
-#else
-  // Escape spaces and special characters on Unix-like systems
-  std::string result = path;
-  size_t pos = 0;
-  while ((pos = result.find(' ', pos)) != std::string::npos) {
-    result.insert(pos, "\\");
-    pos += 2;
+#include "artifacts.hpp"
+#include "bench_runner.hpp"
+#include "clean.hpp"
+#include "daemon.hpp"
+#include "dependencies.hpp"
+#include "distributed.hpp"
+#include "file_watcher.hpp"
+#include "linker.hpp"
+#include "manifest.hpp"
+#include "native_build.hpp"
+#include "process.hpp"
+#include "profiles.hpp"
+#include "project_root.hpp"
+#include "test_runner.hpp"
+#include "timings.hpp"
+#include "util.hpp"
+#include "workspace.hpp"
+
+// Command line options shared by the build, run, test and watch subcommands
+struct BuildOptions
+{
+  bool release_mode = false;
+  // --profile: dev, release or a custom profile; empty picks dev or release from release_mode
+  std::string profile;
+  // 0 leaves the choice to [build] jobs or the number of cores
+  unsigned jobs = 0;
+  // Fail instead of updating Sail.lock
+  bool locked = false;
+  // Report where the build time went
+  bool timings = false;
+  // Profile-guided optimization: build instrumented, or optimize with the collected profiles
+  bool pgo_generate = false;
+  bool pgo_use = false;
+  // Also build the test programs in tests/ or the benchmarks in benches/
+  bool tests = false;
+  bool benches = false;
+};
+
+// What `sail watch` keeps between builds: the parsed manifests and the resolved dependencies,
+// reused until one of the files they were read from changes
+struct LoadedProject
+{
+  std::filesystem::path root;
+  // Modification times and sizes of the manifests and the lockfile when they were read
+  std::string inputs_stamp;
+  Manifest manifest;
+  std::vector<WorkspaceMember> members;
+  std::optional<std::vector<ResolvedDependency>> dependencies;
+};
+
+// In a command that `sail daemon` carries out, the project as the daemon keeps it loaded
+const LoadedProject* daemon_project = nullptr;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+// Helper function to start a command from what sail daemon has loaded, or from nothing outside it
+LoadedProject preloaded_project() {
+  return daemon_project != nullptr ? *daemon_project : LoadedProject{};
+}
+
+// Helper function to pick the number of parallel build jobs.
+// Precedence: --jobs on the command line, then [build] jobs in Sail.toml, then the number of cores.
+unsigned resolve_build_jobs(const BuildSection& build, unsigned jobs_override) {
+  if (jobs_override > 0) {
+    return jobs_override;
   }
-  return result;
-#endif
+  if (build.jobs) {
+    return *build.jobs;
+  }
+  return std::max(1U, std::thread::hardware_concurrency());
 }
 
-// Helper function to build project (used by both build and run commands)
-// cppcheck-suppress normalCheckLevelMaxBranches
-std::pair<int, std::filesystem::path> build_project(bool release_mode) {
-  // Find project root by looking for Sail.toml
-  std::filesystem::path project_root;
-  std::filesystem::path current_path = std::filesystem::current_path();
-  
-  while (current_path != current_path.root_path()) {
-    const std::filesystem::path sail_toml_path = current_path / "Sail.toml";
-    if (std::filesystem::exists(sail_toml_path)) {
-      project_root = current_path;
-      break;
-    }
-    current_path = current_path.parent_path();
+// Helper function to pick the CMake generator; an empty result leaves the choice to CMake.
+// Precedence: [build] generator in Sail.toml, then the CMAKE_GENERATOR environment variable,
+// then Ninja if it is on PATH.
+std::string resolve_generator(const BuildSection& build) {
+  if (build.generator) {
+    return *build.generator == "default" ? std::string() : *build.generator;
   }
-  
-  if (project_root.empty()) {
-    fmt::print("Error: Sail.toml not found in current directory or any parent directory. Run 'sail init' first.\\n");
-    return {EXIT_FAILURE, {}};
+  if (!get_env("CMAKE_GENERATOR").empty()) {
+    return {};
   }
-  
-  // Read project name from Sail.toml
-  const std::filesystem::path sail_toml_path = project_root / "Sail.toml";
-  std::ifstream toml_file(sail_toml_path);
-  if (!toml_file) {
-    fmt::print("Error: Failed to read Sail.toml\\n");
-    return {EXIT_FAILURE, {}};
+  if (find_program("ninja")) {
+    return "Ninja";
   }
-  
-  std::string project_name;
+  return {};
+}
+
+// Helper function to pick the compiler launcher (ccache/sccache); an empty result disables it.
+// [build] cache in Sail.toml selects "ccache", "sccache", another launcher program or "none".
+// When unset, the first of ccache and sccache found on PATH is used.
+std::string resolve_compiler_launcher(const BuildSection& build) {
+  const auto& configured_cache = build.cache;
+  if (configured_cache && (configured_cache->empty() || *configured_cache == "none")) {
+    return {};
+  }
+  if (configured_cache) {
+    if (const auto cache_program = find_program(*configured_cache)) {
+      return cache_program->string();
+    }
+    fmt::print("Warning: compiler cache '{}' is enabled but was not found. Not using it\n", *configured_cache);
+    return {};
+  }
+  for (const std::string_view cache_program_name : {"ccache", "sccache"}) {
+    if (const auto cache_program = find_program(cache_program_name)) {
+      return cache_program->string();
+    }
+  }
+  return {};
+}
+
+// Helper function to write the file CMake includes after the project's top-level project() call
+// (CMAKE_PROJECT_INCLUDE), where the compiler is known. It holds the settings that have to reach the
+// project and its add_subdirectory dependencies whatever their CMakeLists.txt says.
+void write_project_include(const std::filesystem::path& include_path, const std::string& code) {
+  write_file_if_changed(include_path, "# Generated by sail from Sail.toml and the command line. Do not edit.\n"
+                                      "if(NOT PROJECT_IS_TOP_LEVEL)\n  return()\nendif()\n" + code);
+}
+
+// Helper function to read the generator an existing build tree was configured with
+std::string read_cached_generator(const std::filesystem::path& build_dir) {
+  std::ifstream cache_file(build_dir / "CMakeCache.txt");
+  constexpr std::string_view generator_entry = "CMAKE_GENERATOR:INTERNAL=";
   std::string line;
-  while (std::getline(toml_file, line)) {
-    if (line.find("name = \"") != std::string::npos) {
-      const size_t start = line.find('\"') + 1;
-      const size_t end = line.find('\"', start);
-      if (start != std::string::npos && end != std::string::npos) {
-        project_name = line.substr(start, end - start);
-        break;
-      }
+  while (std::getline(cache_file, line)) {
+    if (line.compare(0, generator_entry.size(), generator_entry) == 0) {
+      return line.substr(generator_entry.size());
     }
   }
-  
-  if (project_name.empty()) {
-    fmt::print("Error: Could not find project name in Sail.toml\\n");
-    return {EXIT_FAILURE, {}};
+  return {};
+}
+
+// Helper function to write target/<mode>/sources.cmake for the generated CMakeLists.txt.
+// The file is only rewritten when the sources or [build] settings changed, so that CMake does not re-run needlessly.
+void write_sources_manifest(const std::filesystem::path& manifest_path, const std::vector<std::filesystem::path>& sources,
+                            const std::vector<std::filesystem::path>& module_sources,
+                            const std::vector<std::string>& precompiled_headers, std::optional<unsigned> cxx_standard) {
+  std::string content = "# Generated by sail from the contents of src/ and [build]. Do not edit.\n";
+  if (cxx_standard) {
+    content += fmt::format("set(CMAKE_CXX_STANDARD {})\n", *cxx_standard);
   }
-  
-  // Check if src directory exists
-  const std::filesystem::path src_dir = project_root / "src";
-  if (!std::filesystem::exists(src_dir)) {
-    fmt::print("Error: src directory not found\\n");
-    return {EXIT_FAILURE, {}};
+  content += "set(SAIL_SOURCES\n";
+  for (const auto& source : sources) {
+    content += "  " + cmake_quote(source.generic_string()) + "\n";
+  }
+  content += ")\nset(SAIL_MODULE_SOURCES\n";
+  for (const auto& source : module_sources) {
+    content += "  " + cmake_quote(source.generic_string()) + "\n";
+  }
+  content += ")\nset(SAIL_PRECOMPILE_HEADERS\n";
+  for (const auto& header : precompiled_headers) {
+    content += "  " + cmake_quote(header) + "\n";
+  }
+  content += ")\n";
+  write_file_if_changed(manifest_path, content);
+}
+
+// First line of every CMakeLists.txt sail generates. While a file starts with it, sail keeps the file in
+// step with the sail that builds it; without it, the file is the project's own and sail never touches it.
+constexpr std::string_view generated_cmakelists_marker =
+  "# Generated by sail, which rewrites this file while this line is here. Remove the line to maintain the file yourself.\n";
+
+// Helper function to write a CMakeLists.txt that is missing or still sail's own; returns false if it cannot be
+// written. A file of the project's own that does not mention `hook`, the variable through which sail hands it
+// the sources and dependencies, gets a warning, since the settings passed that way do nothing for it.
+bool write_generated_cmakelists(const std::filesystem::path& cmake_path, std::string_view content, std::string_view hook) {
+  if (const auto existing = read_file(cmake_path)) {
+    if (existing->compare(0, generated_cmakelists_marker.size(), generated_cmakelists_marker) != 0) {
+      if (!hook.empty() && existing->find(hook) == std::string::npos) {
+        fmt::print("Warning: {} does not include {}, so the sources, [dependencies] and [build] settings sail passes "
+                   "through it are ignored. Delete the file to have sail generate one.\n", cmake_path.string(), hook);
+      }
+      return true;
+    }
   }
-  
-  // Determine build mode and target directory
-  const std::string build_mode = release_mode ? "Release" : "Debug";
-  const std::string target_subdir = release_mode ? "release" : "debug";
-  const std::filesystem::path target_dir = project_root / "target" / target_subdir;
-  
   try {
-    // Create target directories
-    std::filesystem::create_directories(target_dir);
-    
-    // Generate CMakeLists.txt if it doesn't exist
-    const std::filesystem::path cmake_path = project_root / "CMakeLists.txt";
-    if (!std::filesystem::exists(cmake_path)) {
-      const std::string cmake_content = fmt::format(R"(cmake_minimum_required(VERSION 3.21)
+    write_file_if_changed(cmake_path, std::string(generated_cmakelists_marker) + std::string(content));
+  } catch (const std::runtime_error&) {
+    fmt::print("Error: Failed to create CMakeLists.txt\n");
+    return false;
+  }
+  return true;
+}
+
+// Helper function to generate the CMakeLists.txt of a project; returns false if it cannot be written. A project
+// CMakeLists.txt of the project's own is only warned about when `own_file_needs_hooks`, as a workspace
+// library member's does not need sail's sources.
+bool write_default_cmakelists(const std::filesystem::path& project_root, const std::string& project_name, bool own_file_needs_hooks) {
+  const std::string cmake_content = fmt::format(R"(cmake_minimum_required(VERSION 3.21)
 
 project({} VERSION 0.1.0 LANGUAGES CXX)
 
 set(CMAKE_CXX_STANDARD 17)
 set(CMAKE_CXX_STANDARD_REQUIRED ON)
 
-# Collect all source files
-file(GLOB_RECURSE SOURCES src/*.cpp src/*.c)
+# Source files and [build] std and pch are listed by sail in target/<mode>/sources.cmake;
+# CMake re-runs by itself whenever sail rewrites that file because either changed
+if(DEFINED SAIL_SOURCES_FILE)
+  include("${{SAIL_SOURCES_FILE}}")
+else()
+  file(GLOB_RECURSE SAIL_SOURCES CONFIGURE_DEPENDS src/*.cpp src/*.c)
+endif()
+
+# Dependencies from Sail.toml are added by sail in target/<mode>/dependencies.cmake
+set(SAIL_DEPENDENCY_TARGETS)
+if(DEFINED SAIL_DEPENDENCIES_FILE)
+  include("${{SAIL_DEPENDENCIES_FILE}}")
+endif()
 
 # Create executable
-add_executable({} ${{SOURCES}})
+add_executable({} ${{SAIL_SOURCES}})
+target_link_libraries({} PRIVATE ${{SAIL_DEPENDENCY_TARGETS}})
+if(SAIL_PRECOMPILE_HEADERS)
+  target_precompile_headers({} PRIVATE ${{SAIL_PRECOMPILE_HEADERS}})
+endif()
+
+# CMake scans module interface units and their importers itself and orders the BMI builds
+if(SAIL_MODULE_SOURCES)
+  if(CMAKE_VERSION VERSION_LESS 3.28)
+    message(FATAL_ERROR "C++20 modules need CMake 3.28 or newer, this is ${{CMAKE_VERSION}}")
+  endif()
+  target_sources({} PRIVATE FILE_SET CXX_MODULES FILES ${{SAIL_MODULE_SOURCES}})
+  set_target_properties({} PROPERTIES CXX_SCAN_FOR_MODULES ON)
+endif()
 
 # Set output directory based on build type
 set_target_properties({} PROPERTIES
@@ -132,118 +258,986 @@ set_target_properties({} PROPERTIES
 
 # Ensure consistent output name across platforms
 set_target_properties({} PROPERTIES OUTPUT_NAME "{}")
-)", project_name, project_name, project_name, project_name, project_name);
-      
-      std::ofstream cmake_file(cmake_path);
-      if (!cmake_file) {
-        fmt::print("Error: Failed to create CMakeLists.txt\\n");
+)", project_name, project_name, project_name, project_name, project_name, project_name, project_name, project_name, project_name);
+
+  return write_generated_cmakelists(project_root / "CMakeLists.txt", cmake_content, own_file_needs_hooks ? "SAIL_SOURCES_FILE" : "");
+}
+
+// Helper function to generate the CMakeLists.txt of a workspace root. The members are listed by sail in
+// target/<mode>/workspace.cmake, so the file itself only changes with sail.
+bool write_workspace_cmakelists(const std::filesystem::path& workspace_root) {
+  constexpr std::string_view cmake_content = R"(cmake_minimum_required(VERSION 3.21)
+
+project(sail_workspace LANGUAGES CXX)
+
+# Dependencies of the members are added once by sail in target/<mode>/dependencies.cmake
+if(DEFINED SAIL_DEPENDENCIES_FILE)
+  include("${SAIL_DEPENDENCIES_FILE}")
+endif()
+
+# Members are added by sail in target/<mode>/workspace.cmake, each after the members it links.
+# Their executables are written to target/<mode>/ here.
+include("${SAIL_WORKSPACE_FILE}")
+)";
+
+  return write_generated_cmakelists(workspace_root / "CMakeLists.txt", cmake_content, "SAIL_WORKSPACE_FILE");
+}
+
+// Helper function to write the sources.cmake of a project from its src/ and [build] settings
+void write_project_sources(const std::filesystem::path& manifest_path, const std::filesystem::path& project_root,
+                           const BuildSection& build) {
+  const std::filesystem::path src_dir = project_root / "src";
+  std::vector<std::string> precompiled_headers;
+  for (const auto& header : build.pch) {
+    precompiled_headers.push_back(pch_include_spelling(header, project_root));
+  }
+  write_sources_manifest(manifest_path, collect_sources(src_dir), collect_module_sources(src_dir),
+    precompiled_headers, build.cxx_standard);
+}
+
+// Helper function for the project include of a custom profile: CMakeLists.txt sends the executable to
+// target/debug or target/release by build type, so move it to the profile's own directory once the
+// file has been processed
+std::string profile_output_cmake_code(const std::string& project_name, const std::filesystem::path& target_dir) {
+  const std::string output_dir = cmake_quote(target_dir.generic_string());
+  return fmt::format("# The profile builds into {0}\n"
+                     "function(sail_profile_output_directory)\n"
+                     "  if(TARGET {1})\n"
+                     "    set_target_properties({1} PROPERTIES RUNTIME_OUTPUT_DIRECTORY {0}\n"
+                     "      RUNTIME_OUTPUT_DIRECTORY_DEBUG {0} RUNTIME_OUTPUT_DIRECTORY_RELEASE {0})\n"
+                     "  endif()\n"
+                     "endfunction()\n"
+                     "cmake_language(DEFER CALL sail_profile_output_directory)\n", output_dir, project_name);
+}
+
+// Helper function to turn a program name into a CMake target name, such as sail_test_<name>
+std::string program_target_name(std::string_view kind, const std::string& program_name) {
+  std::string target = fmt::format("sail_{}_", kind);
+  for (const char character : program_name) {
+    target += std::isalnum(static_cast<unsigned char>(character)) != 0 || character == '-' ? character : '_';
+  }
+  return target;
+}
+
+// Helper function to write target/<mode>/programs.cmake, which adds a program per tests/*.cpp and
+// benches/*.cpp. The programs link the objects of every source but src/main.cpp, are left out of
+// the default build and are built together through the sail_tests and sail_benches targets.
+// Returns the code that includes the file once the project's CMakeLists.txt has run, so its
+// dependency targets are known; empty if there are no such programs.
+std::string write_programs_manifest(const std::filesystem::path& target_dir, const std::filesystem::path& project_root) {
+  const std::vector<std::filesystem::path> tests = collect_program_sources(project_root / "tests");
+  const std::vector<std::filesystem::path> benches = collect_program_sources(project_root / "benches");
+  if (tests.empty() && benches.empty()) {
+    return {};
+  }
+  const std::filesystem::path src_dir = project_root / "src";
+  std::string library_sources;
+  for (const auto& source : collect_sources(src_dir)) {
+    if (!is_main_source(source, src_dir)) {
+      library_sources += " " + cmake_quote(source.generic_string());
+    }
+  }
+  std::string module_sources;
+  for (const auto& source : collect_module_sources(src_dir)) {
+    module_sources += " " + cmake_quote(source.generic_string());
+  }
+
+  std::string content = "# Generated by sail from the contents of tests/ and benches/. Do not edit.\n"
+                        "add_custom_target(sail_tests)\n"
+                        "add_custom_target(sail_benches)\n";
+  if (library_sources.empty() && module_sources.empty()) {
+    content += "add_library(sail_program_objects INTERFACE)\n"
+               "target_link_libraries(sail_program_objects INTERFACE ${SAIL_DEPENDENCY_TARGETS})\n";
+  } else {
+    content += fmt::format("add_library(sail_program_objects OBJECT EXCLUDE_FROM_ALL{})\n"
+                           "target_link_libraries(sail_program_objects PUBLIC ${{SAIL_DEPENDENCY_TARGETS}})\n", library_sources);
+    if (!module_sources.empty()) {
+      content += fmt::format("target_sources(sail_program_objects PUBLIC FILE_SET CXX_MODULES FILES{})\n", module_sources);
+    }
+  }
+  content += fmt::format("target_include_directories(sail_program_objects INTERFACE {})\n", cmake_quote(src_dir.generic_string()));
+  for (const auto& [kind, group, programs] : { std::tuple{ std::string_view("test"), std::string_view("sail_tests"), &tests },
+                                                std::tuple{ std::string_view("bench"), std::string_view("sail_benches"), &benches } }) {
+    for (const auto& program : *programs) {
+      const std::string name = program.stem().string();
+      const std::string output_dir = cmake_quote((target_dir / program.parent_path().filename()).generic_string());
+      const std::string target = program_target_name(kind, name);
+      content += fmt::format("add_executable({} EXCLUDE_FROM_ALL {})\n"
+                             "target_link_libraries({} PRIVATE sail_program_objects)\n"
+                             "set_target_properties({} PROPERTIES OUTPUT_NAME {}\n"
+                             "  RUNTIME_OUTPUT_DIRECTORY {} RUNTIME_OUTPUT_DIRECTORY_DEBUG {} RUNTIME_OUTPUT_DIRECTORY_RELEASE {})\n"
+                             "add_dependencies({} {})\n",
+        target, cmake_quote(program.generic_string()), target, target, cmake_quote(name), output_dir, output_dir, output_dir, group, target);
+    }
+  }
+  const std::filesystem::path manifest_path = target_dir / "programs.cmake";
+  write_file_if_changed(manifest_path, content);
+  return fmt::format("cmake_language(DEFER CALL include {})\n", cmake_quote(manifest_path.generic_string()));
+}
+
+// Helper function to identify a compiler CMake would pick up: the one CC or CXX names, or `fallback` on
+// PATH. Symlinks such as update-alternatives' are followed, and the binary's time and size taken too,
+// so that an upgrade in place or another PATH is seen without running the compiler.
+std::string resolved_compiler_stamp(const char* variable, std::string_view fallback) {
+  std::string compiler = get_env(variable);
+  if (compiler.empty()) {
+    compiler = fallback;
+  }
+  std::filesystem::path path = compiler;
+  if (!path.has_parent_path()) {
+    path = find_program(compiler).value_or(path);
+  }
+  std::error_code error;
+  const std::filesystem::path resolved = std::filesystem::canonical(path, error);
+  if (error) {
+    return compiler;
+  }
+  const auto time = std::filesystem::last_write_time(resolved, error).time_since_epoch().count();
+  const auto size = error ? 0 : std::filesystem::file_size(resolved, error);
+  return fmt::format("{}:{}:{}", resolved.string(), time, size);
+}
+
+// Helper function to fingerprint every input of the CMake configure step.
+// If any of these change, the build tree has to be configured again.
+std::string compute_configure_fingerprint(const std::filesystem::path& project_root, const std::string& configure_command) {
+  std::uint64_t hash = fnv1a_hash(sail::cmake::project_version);
+  hash = fnv1a_hash(read_file(project_root / "Sail.toml").value_or(""), hash);
+  hash = fnv1a_hash(read_file(project_root / "CMakeLists.txt").value_or(""), hash);
+  hash = fnv1a_hash(configure_command, hash);
+  for (const char* toolchain_var : {"CC", "CXX", "CMAKE_GENERATOR", "CMAKE_TOOLCHAIN_FILE"}) {
+    hash = fnv1a_hash(toolchain_var, hash);
+    hash = fnv1a_hash(get_env(toolchain_var), hash);
+  }
+  hash = fnv1a_hash(resolved_compiler_stamp("CC", "cc"), hash);
+  hash = fnv1a_hash(resolved_compiler_stamp("CXX", "c++"), hash);
+  return fmt::format("{:016x}", hash);
+}
+
+// Helper function to check whether an existing build tree was configured from the same inputs
+bool is_configure_up_to_date(const std::filesystem::path& build_dir,
+                             const std::filesystem::path& fingerprint_path,
+                             const std::string& fingerprint) {
+  if (!std::filesystem::exists(build_dir / "CMakeCache.txt")) {
+    return false;
+  }
+  const auto stored_fingerprint = read_file(fingerprint_path);
+  return stored_fingerprint.has_value() && *stored_fingerprint == fingerprint;
+}
+
+// Helper function to stamp the files a LoadedProject was read from
+std::string project_inputs_stamp(const std::filesystem::path& project_root, const std::vector<WorkspaceMember>& members) {
+  std::vector<std::filesystem::path> inputs = { project_root / "Sail.toml", project_root / "Sail.lock" };
+  for (const auto& member : members) {
+    inputs.push_back(member.root / "Sail.toml");
+  }
+  std::string stamp;
+  for (const auto& input : inputs) {
+    std::error_code error;
+    const auto time = std::filesystem::last_write_time(input, error).time_since_epoch().count();
+    const auto size = error ? 0 : std::filesystem::file_size(input, error);
+    stamp += fmt::format("{}:{}:{}\n", input.string(), time, size);
+  }
+  return stamp;
+}
+
+// Helper function to name the profile a command builds: --profile, or dev or release after --release
+std::string selected_profile(const BuildOptions& options) {
+  if (!options.profile.empty()) {
+    return options.profile;
+  }
+  return options.release_mode ? "release" : "dev";
+}
+
+// Helper function to name the build in messages: debug or release, or the profile given with --profile
+std::string profile_label(const BuildOptions& options) {
+  if (!options.profile.empty()) {
+    return options.profile;
+  }
+  return options.release_mode ? "release" : "debug";
+}
+
+// Builds the project, recording its phases in `timings` when that is set. `known_target_dir` is filled in
+// once known, so the timings can be written even when the build fails. With a `cache`, the manifests and
+// dependencies it holds are reused while their files are unchanged, and stored there otherwise.
+// cppcheck-suppress normalCheckLevelMaxBranches
+std::pair<int, std::filesystem::path> build_project_timed(const BuildOptions& options, BuildTimings* timings,
+                                                          std::filesystem::path& known_target_dir,
+                                                          LoadedProject* cache = nullptr) {
+  // Find project root by looking for Sail.toml
+  std::optional<std::filesystem::path> found_project_root;
+  {
+    const ScopedTiming timing(timings, "root discovery");
+    found_project_root = find_project_root();
+  }
+  if (!found_project_root) {
+    fmt::print("Error: Sail.toml not found in current directory or any parent directory. Run 'sail init' first.\n");
+    return {EXIT_FAILURE, {}};
+  }
+  const std::filesystem::path& project_root = *found_project_root;
+  
+  const bool cache_valid = cache != nullptr && cache->root == project_root
+    && cache->inputs_stamp == project_inputs_stamp(project_root, cache->members);
+  
+  // Parse Sail.toml
+  Manifest manifest;
+  try {
+    const ScopedTiming timing(timings, "manifest");
+    manifest = cache_valid ? cache->manifest : load_manifest(project_root);
+  } catch (const std::exception& e) {
+    fmt::print("Error: {}\n", e.what());
+    return {EXIT_FAILURE, {}};
+  }
+  
+  // A workspace root has no project of its own; its members are built in one tree
+  const bool is_workspace = manifest.workspace.has_value();
+  std::vector<WorkspaceMember> members;
+  if (cache_valid) {
+    members = cache->members;
+  } else if (is_workspace) {
+    try {
+      const ScopedTiming timing(timings, "manifest");
+      members = load_workspace_members(*manifest.workspace, project_root);
+    } catch (const std::exception& e) {
+      fmt::print("Error: {}\n", e.what());
+      return {EXIT_FAILURE, {}};
+    }
+    if (members.empty()) {
+      fmt::print("Error: [workspace] members in Sail.toml lists no projects\n");
+      return {EXIT_FAILURE, {}};
+    }
+    if (manifest.build.engine != "cmake") {
+      fmt::print("Error: workspaces are built with the CMake engine; remove [build] engine from the workspace's Sail.toml\n");
+      return {EXIT_FAILURE, {}};
+    }
+  }
+  if (is_workspace && (options.tests || options.benches)) {
+    fmt::print("Error: A workspace has no {} of its own; use sail {} in one of its members\n",
+      options.tests ? "tests" : "benchmarks", options.tests ? "test" : "bench");
+    return {EXIT_FAILURE, {}};
+  }
+  if (cache != nullptr && !cache_valid) {
+    *cache = LoadedProject{ project_root, project_inputs_stamp(project_root, members), manifest, members, std::nullopt };
+  }
+  
+  const std::string& project_name = manifest.project.name;
+  if (project_name.empty() && !is_workspace) {
+    fmt::print("Error: Could not find project name in Sail.toml\n");
+    return {EXIT_FAILURE, {}};
+  }
+  
+  // Check if src directory exists
+  const std::filesystem::path src_dir = project_root / "src";
+  if (!is_workspace && !std::filesystem::exists(src_dir)) {
+    fmt::print("Error: src directory not found\n");
+    return {EXIT_FAILURE, {}};
+  }
+  
+  unsigned build_jobs = resolve_build_jobs(manifest.build, options.jobs);
+  
+  // Determine the profile, and from it the build mode and target directory
+  BuildProfile build_profile;
+  try {
+    build_profile = resolve_build_profile(manifest, selected_profile(options));
+  } catch (const std::exception& e) {
+    fmt::print("Error: {}\n", e.what());
+    return {EXIT_FAILURE, {}};
+  }
+  const bool release_mode = build_profile.release;
+  const std::string build_mode = release_mode ? "Release" : "Debug";
+  const std::filesystem::path target_dir = project_root / "target" / build_profile.directory;
+  known_target_dir = target_dir;
+  
+  try {
+    // Create target directories
+    std::filesystem::create_directories(target_dir);
+    
+    // [profile.dev] goes with debug builds, [profile.release] with --release, and --profile picks any
+    const ProfileSection& profile = build_profile.settings;
+    const PgoMode pgo = options.pgo_generate ? PgoMode::Generate : (options.pgo_use ? PgoMode::Use : PgoMode::None);
+    const std::filesystem::path pgo_dir = pgo_data_dir(target_dir);
+    prepare_pgo_data(pgo, pgo_dir);
+    const LinkerChoice linker = resolve_linker(manifest.build.linker);
+    
+    // The launcher is always passed to CMake, so that turning the cache off also clears it from CMakeCache.txt.
+    // [build] distributed puts the build farm's client in front of the compiler, and unless the jobs
+    // were given, keeps as many compiles in flight as the farm takes.
+    std::string compiler_launcher = resolve_compiler_launcher(manifest.build);
+    const unsigned local_cores = std::max(1U, std::thread::hardware_concurrency());
+    if (manifest.build.distributed) {
+      const DistributedCompilation distribution = resolve_distributed(*manifest.build.distributed, compiler_launcher, local_cores);
+      export_environment(distribution.environment);
+      compiler_launcher = distribution.launcher;
+      if (options.jobs == 0 && !manifest.build.jobs) {
+        build_jobs = distribution.jobs;
+      }
+    }
+    
+    // Fetch [dependencies] into the shared cache
+    std::vector<ResolvedDependency> dependencies;
+    if (cache != nullptr && cache->dependencies) {
+      dependencies = *cache->dependencies;
+    } else {
+      const ScopedTiming timing(timings, "dependencies");
+      dependencies = resolve_dependencies(is_workspace ? merge_member_dependencies(manifest, members, project_root) : manifest,
+        project_root, options.locked);
+      // Resolving may have written Sail.lock, which must not count as a change
+      if (cache != nullptr) {
+        cache->dependencies = dependencies;
+        cache->inputs_stamp = project_inputs_stamp(project_root, members);
+      }
+    }
+    
+    // Link git dependencies against binaries shared between projects instead of compiling them here
+    const std::string generator = resolve_generator(manifest.build);
+    {
+      const ScopedTiming timing(timings, "prebuilt dependencies");
+      prepare_dependency_artifacts(dependencies, ArtifactBuildRequest{ build_mode, generator, compiler_launcher, build_jobs, profile, pgo, pgo_dir });
+    }
+    
+    // Simple single-target projects can skip CMake entirely
+    const std::string& engine = manifest.build.engine;
+    if (engine == "native") {
+      NativeBuildRequest request{ project_root, target_dir, project_name, release_mode,
+        manifest.build.cxx_standard.value_or(17U), build_jobs,
+        compiler_launcher, {}, {}, manifest.build.unity ? manifest.build.unity_batch_size : 0U,
+        manifest.build.pch, timings, profile, pgo, pgo_dir, linker, options.tests, options.benches };
+      // Without CMake, dependencies can only be used from the install trees of their artifacts
+      for (const auto& dependency : dependencies) {
+        if (dependency.artifact_dir.empty()) {
+          fmt::print("Error: Dependency '{}' has no prebuilt artifact, which the native engine needs to link it; "
+                     "it is a path dependency, has prebuilt = false or failed to prebuild. Use engine = \"cmake\" "
+                     "in [build] to build it from source\n", dependency.name);
+          return {EXIT_FAILURE, {}};
+        }
+        const std::filesystem::path include_dir = dependency.artifact_dir / "include";
+        request.include_dirs.push_back(std::filesystem::exists(include_dir) ? include_dir : dependency.artifact_dir);
+      }
+      // Later dependencies may link against earlier ones, so they go first on the link line
+      for (auto dependency = dependencies.rbegin(); dependency != dependencies.rend(); ++dependency) {
+        const std::vector<std::filesystem::path> libraries = artifact_libraries(dependency->artifact_dir);
+        request.link_libraries.insert(request.link_libraries.end(), libraries.begin(), libraries.end());
+      }
+      const ScopedTiming timing(timings, "build");
+      const int build_result = native_build(request);
+      link_compilation_database(target_dir / "compile_commands.json", project_root);
+      return {build_result, get_executable_path(target_dir, project_name)};
+    }
+    if (engine != "cmake") {
+      fmt::print("Error: Unknown build engine '{}' in Sail.toml, expected \"cmake\" or \"native\"\n", engine);
+      return {EXIT_FAILURE, {}};
+    }
+    
+    // Generate CMakeLists.txt if it doesn't exist, or bring sail's own up to date
+    if (is_workspace) {
+      if (!write_workspace_cmakelists(project_root)) {
         return {EXIT_FAILURE, {}};
       }
-      cmake_file << cmake_content;
+      for (const auto& member : members) {
+        if (!write_default_cmakelists(member.root, member.manifest.project.name, false)) {
+          return {EXIT_FAILURE, {}};
+        }
+      }
+    } else if (!write_default_cmakelists(project_root, project_name, true)) {
+      return {EXIT_FAILURE, {}};
     }
     
     // Create build directory inside target
     const std::filesystem::path build_dir = target_dir / "build";
     std::filesystem::create_directories(build_dir);
     
-    // Run CMake configure
-    const std::string cmake_configure_cmd = fmt::format(
-      "cmake -DCMAKE_BUILD_TYPE={} -S {} -B {}",
-      build_mode,
-      quote_path(project_root.string()),
-      quote_path(build_dir.string())
-    );
+    // Keep the source list in sync with src/, or with each member's src/ in a workspace
+    const std::filesystem::path sources_manifest_path = target_dir / (is_workspace ? "workspace.cmake" : "sources.cmake");
+    if (is_workspace) {
+      for (const auto& member : members) {
+        const std::filesystem::path member_dir = member_target_dir(target_dir, member);
+        std::filesystem::create_directories(member_dir);
+        write_project_sources(member_dir / "sources.cmake", member.root, member.manifest.build);
+      }
+    } else {
+      write_project_sources(sources_manifest_path, project_root, manifest.build);
+    }
     
-    const int configure_result = std::system(cmake_configure_cmd.c_str());  // NOLINT(cert-env33-c,concurrency-mt-unsafe)
-    if (configure_result != 0) {
-      fmt::print("Error: CMake configuration failed\\n");
-      return {EXIT_FAILURE, {}};
+    const std::filesystem::path dependencies_manifest_path = target_dir / "dependencies.cmake";
+    if (is_workspace) {
+      write_shared_dependencies_manifest(dependencies_manifest_path, dependencies);
+      write_workspace_manifest(target_dir, members, dependencies);
+    } else {
+      write_dependencies_manifest(dependencies_manifest_path, dependencies);
     }
+    const std::filesystem::path project_include_path = target_dir / "project_include.cmake";
+    const std::string programs_code = is_workspace ? std::string() : write_programs_manifest(target_dir, project_root);
+    const std::string distributed_code = manifest.build.distributed ? distributed_cmake_code(local_cores) : std::string();
+    const bool own_directory = build_profile.directory != "debug" && build_profile.directory != "release";
+    const std::string output_code = own_directory && !is_workspace ? profile_output_cmake_code(project_name, target_dir) : std::string();
+    write_project_include(project_include_path,
+      profile_cmake_code(profile, pgo, pgo_dir) + linker_cmake_code(linker) + distributed_code + programs_code + output_code);
     
-    // Run CMake build
-    const std::string cmake_build_cmd = fmt::format(
-      "cmake --build {} --config {}",
-      quote_path(build_dir.string()),
-      build_mode
-    );
+    // CMake refuses to switch generators in an existing build tree, so start it over instead
+    if (!generator.empty()) {
+      const std::string cached_generator = read_cached_generator(build_dir);
+      if (!cached_generator.empty() && cached_generator != generator) {
+        std::filesystem::remove(build_dir / "CMakeCache.txt");
+        std::filesystem::remove_all(build_dir / "CMakeFiles");
+      }
+    }
     
-    const int build_result = std::system(cmake_build_cmd.c_str());  // NOLINT(cert-env33-c,concurrency-mt-unsafe)
-    if (build_result != 0) {
-      fmt::print("Error: Build failed\\n");
+    std::vector<std::string> cmake_configure_cmd = { "cmake" };
+    if (!generator.empty()) {
+      cmake_configure_cmd.insert(cmake_configure_cmd.end(), { "-G", generator });
+    }
+    cmake_configure_cmd.insert(cmake_configure_cmd.end(), {
+      "-DCMAKE_BUILD_TYPE=" + build_mode,
+      "-DCMAKE_CXX_COMPILER_LAUNCHER=" + compiler_launcher,
+      fmt::format("-DCMAKE_UNITY_BUILD={}", manifest.build.unity ? "ON" : "OFF"),
+      fmt::format("-DCMAKE_UNITY_BUILD_BATCH_SIZE={}", manifest.build.unity_batch_size),
+      "-DCMAKE_EXPORT_COMPILE_COMMANDS=ON",
+      "-DCMAKE_PROJECT_INCLUDE=" + project_include_path.generic_string(),
+      fmt::format("-D{}={}", is_workspace ? "SAIL_WORKSPACE_FILE" : "SAIL_SOURCES_FILE", sources_manifest_path.generic_string()),
+      "-DSAIL_DEPENDENCIES_FILE=" + dependencies_manifest_path.generic_string(),
+      "-S", project_root.string(),
+      "-B", build_dir.string()
+    });
+    
+    // Run CMake configure, unless the build tree was already configured from the same inputs
+    const std::filesystem::path fingerprint_path = target_dir / "configure.fingerprint";
+    const std::string fingerprint = compute_configure_fingerprint(project_root, format_command(cmake_configure_cmd));
+    if (!is_configure_up_to_date(build_dir, fingerprint_path, fingerprint)) {
+      // Drop the old fingerprint first so an interrupted configure is never considered up to date
+      std::filesystem::remove(fingerprint_path);
+
+      const ScopedTiming timing(timings, "configure");
+      const ProcessResult configure_result = run_process(cmake_configure_cmd);
+      if (!configure_result.error.empty()) {
+        fmt::print("Error: {}\n", configure_result.error);
+      }
+      if (!configure_result.success()) {
+        fmt::print("Error: CMake configuration failed\n");
+        return {EXIT_FAILURE, {}};
+      }
+
+      std::ofstream fingerprint_file(fingerprint_path, std::ios::binary);
+      fingerprint_file << fingerprint;
+    }
+    // Makefile and Ninja generators write compile_commands.json while configuring
+    link_compilation_database(build_dir / "compile_commands.json", project_root);
+    
+    // Run CMake build; the test and bench programs are only built for sail test and sail bench
+    std::vector<std::string> cmake_build_cmd = {
+      "cmake", "--build", build_dir.string(), "--config", build_mode, "--parallel", std::to_string(build_jobs)
+    };
+    if (options.tests) {
+      cmake_build_cmd.insert(cmake_build_cmd.end(), { "--target", "sail_tests" });
+    } else if (options.benches) {
+      cmake_build_cmd.insert(cmake_build_cmd.end(), { "--target", "sail_benches" });
+    }
+    
+    // Ninja appends to its log, so the jobs of this build are the ones after the current end
+    std::error_code log_error;
+    const std::uintmax_t ninja_log_offset = std::filesystem::file_size(build_dir / ".ninja_log", log_error);
+    const auto build_start = BuildTimings::Clock::now();
+    ProcessResult build_result;
+    {
+      const ScopedTiming timing(timings, "build");
+      build_result = run_process(cmake_build_cmd);
+    }
+    if (timings != nullptr && !timings->import_ninja_log(build_dir, log_error ? 0 : ninja_log_offset, build_start)) {
+      timings->add_note("per translation unit times are only available with the Ninja generator");
+    }
+    if (!build_result.error.empty()) {
+      fmt::print("Error: {}\n", build_result.error);
+    }
+    if (!build_result.success()) {
+      fmt::print("Error: Build failed\n");
       return {EXIT_FAILURE, {}};
     }
     
+    // Workspace members each write their own executable; there is no single one to report
+    if (is_workspace) {
+      return {EXIT_SUCCESS, {}};
+    }
     const std::filesystem::path executable_path = get_executable_path(target_dir, project_name);
     return {EXIT_SUCCESS, executable_path};
     
   } catch (const std::filesystem::filesystem_error& e) {
-    fmt::print("Error: {}\\n", e.what());
+    fmt::print("Error: {}\n", e.what());
     return {EXIT_FAILURE, {}};
   } catch (const std::exception& e) {
-    fmt::print("Error: {}\\n", e.what());
+    fmt::print("Error: {}\n", e.what());
     return {EXIT_FAILURE, {}};
   }
 }
 
+// Helper function to build project (used by both build and run commands)
+std::pair<int, std::filesystem::path> build_project(const BuildOptions& options) {
+  BuildTimings timings;
+  std::filesystem::path target_dir;
+  LoadedProject project = preloaded_project();
+  auto result = build_project_timed(options, options.timings ? &timings : nullptr, target_dir, &project);
+  if (options.timings && !target_dir.empty()) {
+    try {
+      report_timings(timings, target_dir);
+    } catch (const std::exception& e) {
+      fmt::print("Warning: Could not write timings: {}\n", e.what());
+    }
+  }
+  return result;
+}
+
 // Handler for run subcommand
-int handle_run_command(bool run_release, const std::vector<std::string>& run_args) {
-  fmt::print("Compiling {}...\\n", run_release ? "release" : "debug");
+int handle_run_command(const BuildOptions& run_options, const std::vector<std::string>& run_args) {
+  fmt::print("Compiling {}...\n", profile_label(run_options));
   
-  const auto [build_result, executable_path] = build_project(run_release);
+  const auto [build_result, executable_path] = build_project(run_options);
   if (build_result != EXIT_SUCCESS) {
     return build_result;
   }
+  if (executable_path.empty()) {
+    fmt::print("Error: A workspace has no executable of its own; use sail run in one of its members\n");
+    return EXIT_FAILURE;
+  }
   
   if (!std::filesystem::exists(executable_path)) {
-    fmt::print("Error: Executable not found at {}\\n", executable_path.string());
+    fmt::print("Error: Executable not found at {}\n", executable_path.string());
     return EXIT_FAILURE;
   }
   
-  fmt::print("Running `{}`\\n", executable_path.filename().string());
+  fmt::print("Running `{}`\n", executable_path.filename().string());
   
   // Build command to execute
-  std::string run_command = quote_path(executable_path.string());
-  for (const auto& arg : run_args) {
-    run_command += " " + quote_path(arg);
-  }
+  std::vector<std::string> run_command = { executable_path.string() };
+  run_command.insert(run_command.end(), run_args.begin(), run_args.end());
   
-  // Execute the program
-  const int run_result = std::system(run_command.c_str());  // NOLINT(cert-env33-c,concurrency-mt-unsafe)
-  return run_result;
+  // Hand the process over to the program, so nothing sits between it and whoever started sail
+  const ProcessResult run_result = exec_process(run_command);
+  if (!run_result.error.empty()) {
+    fmt::print("Error: {}\n", run_result.error);
+  }
+  return run_result.exit_code;
+}
+
+// Helper function for sail build with several profiles: build them all at once, each in a sail of its
+// own with its share of the jobs. Sail.lock and the dependency checkouts are settled first, so that
+// the builds only read them, and prebuilt artifacts are shared by the profiles with the same build
+// type and flags.
+int build_profiles_concurrently(const BuildOptions& options, std::vector<std::string> profiles) {
+  const auto project_root = find_project_root();
+  if (!project_root) {
+    fmt::print("Error: Sail.toml not found in current directory or any parent directory. Run 'sail init' first.\n");
+    return EXIT_FAILURE;
+  }
+  std::vector<std::string> unique_profiles;
+  for (auto& profile : profiles) {
+    if (std::find(unique_profiles.begin(), unique_profiles.end(), profile) == unique_profiles.end()) {
+      unique_profiles.push_back(std::move(profile));
+    }
+  }
+
+  unsigned total_jobs = 0;
+  try {
+    const Manifest manifest = load_manifest(*project_root);
+    // An unknown profile fails the command before any build starts
+    for (const auto& profile : unique_profiles) {
+      std::ignore = resolve_build_profile(manifest, profile);
+    }
+    std::vector<WorkspaceMember> members;
+    if (manifest.workspace) {
+      members = load_workspace_members(*manifest.workspace, *project_root);
+    }
+    std::ignore = resolve_dependencies(manifest.workspace ? merge_member_dependencies(manifest, members, *project_root) : manifest,
+      *project_root, options.locked);
+    total_jobs = resolve_build_jobs(manifest.build, options.jobs);
+    if (manifest.build.distributed && options.jobs == 0 && !manifest.build.jobs) {
+      total_jobs = resolve_distributed(*manifest.build.distributed, {}, std::max(1U, std::thread::hardware_concurrency())).jobs;
+    }
+  } catch (const std::exception& e) {
+    fmt::print("Error: {}\n", e.what());
+    return EXIT_FAILURE;
+  }
+
+  const std::filesystem::path self = current_executable();
+  const auto count = static_cast<unsigned>(unique_profiles.size());
+  std::vector<std::vector<std::string>> commands;
+  for (unsigned index = 0; index < count; ++index) {
+    const unsigned jobs = std::max(1U, total_jobs / count + (index < total_jobs % count ? 1U : 0U));
+    std::vector<std::string> command = { self.empty() ? std::string("sail") : self.string(), "build", "--profile", unique_profiles[index],
+      "--jobs", std::to_string(jobs), "--locked" };
+    if (options.timings) {
+      command.emplace_back("--timings");
+    }
+    if (options.pgo_generate || options.pgo_use) {
+      command.emplace_back(options.pgo_generate ? "--pgo-generate" : "--pgo-use");
+    }
+    commands.push_back(std::move(command));
+  }
+
+  // The builds are children of this sail; a daemon would only hand them back
+  export_environment({ { "SAIL_NO_DAEMON", "1" } });
+  fmt::print("Building profiles {} with {} jobs in total...\n", fmt::join(unique_profiles, ", "), total_jobs);
+  std::vector<std::string> failed;
+  const auto start = std::chrono::steady_clock::now();
+  run_processes(commands, count, ProcessOptions{ ProcessOutput::Capture }, [&](std::size_t index, unsigned, const ProcessResult& result) {
+    // Each build's output stays together, printed as the build finishes
+    fmt::print("==> {} ({:.1f}s)\n{}", unique_profiles[index], std::chrono::duration<double>(result.elapsed).count(), result.output);
+    if (!result.error.empty()) {
+      fmt::print("Error: {}\n", result.error);
+    }
+    if (!result.success()) {
+      failed.push_back(unique_profiles[index]);
+    }
+    std::fflush(stdout);
+  }, true);
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (!failed.empty()) {
+    fmt::print("Error: {} of {} profiles failed to build: {}\n", failed.size(), count, fmt::join(failed, ", "));
+    return EXIT_FAILURE;
+  }
+  fmt::print("Finished profiles {} in {:.1f}s\n", fmt::join(unique_profiles, ", "), elapsed);
+  return EXIT_SUCCESS;
 }
 
 // Handler for build subcommand
-int handle_build_command(bool build_release) {
-  fmt::print("Configuring project...\\n");
-  fmt::print("Compiling...\\n");
+int handle_build_command(BuildOptions build_options, const std::vector<std::string>& profiles) {
+  if (profiles.size() > 1) {
+    return build_profiles_concurrently(build_options, profiles);
+  }
+  if (!profiles.empty()) {
+    build_options.profile = profiles.front();
+  }
+  fmt::print("Configuring project...\n");
+  fmt::print("Compiling...\n");
   
-  const auto [build_result, executable_path] = build_project(build_release);
+  const auto [build_result, executable_path] = build_project(build_options);
   if (build_result != EXIT_SUCCESS) {
     return build_result;
   }
   
-  const std::string target_subdir = build_release ? "release" : "debug";
-  const std::string build_mode = build_release ? "Release" : "Debug";
-  
-  if (std::filesystem::exists(executable_path)) {
-    fmt::print("Finished {} [{}] target(s) in target/{}/\\n", 
-              build_release ? "release" : "debug",
-              build_mode, 
-              target_subdir);
+  if (executable_path.empty() || std::filesystem::exists(executable_path)) {
+    if (build_options.profile.empty()) {
+      const bool build_release = build_options.release_mode;
+      fmt::print("Finished {} [{}] target(s) in target/{}/\n", 
+                build_release ? "release" : "debug",
+                build_release ? "Release" : "Debug", 
+                build_release ? "release" : "debug");
+    } else {
+      fmt::print("Finished {} target(s) in target/{}\n", build_options.profile,
+        executable_path.empty() ? std::string() : executable_path.parent_path().filename().generic_string() + "/");
+    }
   } else {
-    fmt::print("Warning: Executable not found at expected location\\n");
+    fmt::print("Warning: Executable not found at expected location\n");
   }
   
   return EXIT_SUCCESS;
 }
 
+// Helper function to run the test programs of a project built with options.tests
+int run_project_tests(const LoadedProject& project, const std::filesystem::path& target_dir, const BuildOptions& options,
+                      const TestShard& shard, const std::vector<std::string>& test_args) {
+  std::vector<std::string> names;
+  for (const auto& test : collect_program_sources(project.root / "tests")) {
+    names.push_back(test.stem().string());
+  }
+  if (names.empty()) {
+    fmt::print("No tests found in tests/\n");
+    return EXIT_SUCCESS;
+  }
+  return run_tests(TestRunRequest{ target_dir, names, shard, resolve_build_jobs(project.manifest.build, options.jobs), test_args });
+}
+
+// Handler for test subcommand: build every tests/*.cpp into its own program and run the programs in parallel
+int handle_test_command(BuildOptions test_options, const TestShard& shard, const std::vector<std::string>& test_args) {
+  fmt::print("Compiling tests ({})...\n", profile_label(test_options));
+  test_options.tests = true;
+  LoadedProject project = preloaded_project();
+  std::filesystem::path target_dir;
+  const auto [build_result, executable_path] = build_project_timed(test_options, nullptr, target_dir, &project);
+  if (build_result != EXIT_SUCCESS) {
+    return build_result;
+  }
+  return run_project_tests(project, target_dir, test_options, shard, test_args);
+}
+
+// Handler for bench subcommand: build every benches/*.cpp in release mode, with [profile.release],
+// and time the programs one after the other. `bench` holds the settings from the command line.
+int handle_bench_command(BuildOptions bench_options, BenchRunRequest bench) {
+  fmt::print("Compiling benchmarks (release)...\n");
+  bench_options.release_mode = true;
+  bench_options.benches = true;
+  LoadedProject project = preloaded_project();
+  std::filesystem::path target_dir;
+  const auto [build_result, executable_path] = build_project_timed(bench_options, nullptr, target_dir, &project);
+  if (build_result != EXIT_SUCCESS) {
+    return build_result;
+  }
+  for (const auto& program : collect_program_sources(project.root / "benches")) {
+    bench.names.push_back(program.stem().string());
+  }
+  if (bench.names.empty()) {
+    fmt::print("No benchmarks found in benches/\n");
+    return EXIT_SUCCESS;
+  }
+  bench.target_dir = target_dir;
+  bench.results_dir = project.root / "target" / "bench";
+  return run_benches(bench);
+}
+
+// Helper function to list what sail watch watches: each project's src/, tests/ and Sail.toml
+std::vector<std::filesystem::path> watched_paths(const std::filesystem::path& project_root, const std::vector<WorkspaceMember>& members) {
+  std::vector<std::filesystem::path> paths = { project_root / "Sail.toml", project_root / "src", project_root / "tests" };
+  for (const auto& member : members) {
+    paths.push_back(member.root / "Sail.toml");
+    paths.push_back(member.root / "src");
+    paths.push_back(member.root / "tests");
+  }
+  return paths;
+}
+
+// Handler for watch subcommand: build, and for `run` start the program or for `test` run the tests,
+// then again after every change. Bursts of changes are debounced into one rebuild, and the previous
+// run is stopped before the rebuild. Runs until interrupted.
+int handle_watch_command(const std::string& action, BuildOptions watch_options, const std::vector<std::string>& run_args) {
+  const auto project_root = find_project_root();
+  if (!project_root) {
+    fmt::print("Error: Sail.toml not found in current directory or any parent directory. Run 'sail init' first.\n");
+    return EXIT_FAILURE;
+  }
+
+  watch_options.tests = action == "test";
+  LoadedProject project = preloaded_project();
+  std::unique_ptr<ChildProcess> child;
+  while (true) {
+    // Watching starts before the build, so edits made while it compiles trigger the next one
+    FileWatcher watcher(watched_paths(*project_root, project.members));
+    fmt::print("Compiling {}...\n", profile_label(watch_options));
+    std::filesystem::path target_dir;
+    const auto [build_result, executable_path] = build_project_timed(watch_options, nullptr, target_dir, &project);
+    if (build_result == EXIT_SUCCESS && action == "run") {
+      if (executable_path.empty()) {
+        fmt::print("Error: A workspace has no executable of its own; use sail watch run in one of its members\n");
+      } else {
+        fmt::print("Running `{}`\n", executable_path.filename().string());
+        std::vector<std::string> run_command = { executable_path.string() };
+        run_command.insert(run_command.end(), run_args.begin(), run_args.end());
+        child = std::make_unique<ChildProcess>(run_command);
+        if (!child->error().empty()) {
+          fmt::print("Error: {}\n", child->error());
+        }
+      }
+    }
+    if (build_result == EXIT_SUCCESS && action == "test") {
+      static_cast<void>(run_project_tests(project, target_dir, watch_options, TestShard{}, run_args));
+    }
+    fmt::print("Watching src, tests and Sail.toml for changes (Ctrl+C to stop)\n");
+
+    std::vector<std::filesystem::path> changes;
+    bool exit_reported = false;
+    while (changes.empty()) {
+      changes = watcher.wait_for_changes(std::chrono::milliseconds(250), std::chrono::milliseconds(150));
+      if (child && child->error().empty() && !exit_reported) {
+        if (const auto exit_code = child->poll()) {
+          fmt::print("`{}` exited with code {}\n", executable_path.filename().string(), *exit_code);
+          exit_reported = true;
+        }
+      }
+    }
+    // Name a file that is still there; editors save through temporary files that are gone by now
+    const auto shown = std::find_if(changes.begin(), changes.end(), [](const std::filesystem::path& path) {
+      std::error_code error;
+      return std::filesystem::exists(path, error);
+    });
+    fmt::print("Changed: {}{}\n", (shown != changes.end() ? *shown : changes.front()).lexically_relative(*project_root).generic_string(),
+      changes.size() > 1 ? fmt::format(" and {} more", changes.size() - 1) : std::string());
+    child.reset();
+  }
+}
+
+// Helper function for sail daemon: bring `project` up to date with the project at `project_root`,
+// reading the manifests and resolving the dependencies again only after one of their files changed.
+// Sail.lock is never written here; when it would have to change, the command that runs next does that.
+void refresh_loaded_project(const std::filesystem::path& project_root, LoadedProject& project) {
+  if (project.root == project_root && project.dependencies
+      && project.inputs_stamp == project_inputs_stamp(project_root, project.members)) {
+    return;
+  }
+  project = LoadedProject{};
+  LoadedProject loaded{ project_root, {}, load_manifest(project_root), {}, std::nullopt };
+  if (loaded.manifest.workspace) {
+    loaded.members = load_workspace_members(*loaded.manifest.workspace, project_root);
+  }
+  loaded.inputs_stamp = project_inputs_stamp(project_root, loaded.members);
+  loaded.dependencies = resolve_dependencies(loaded.manifest.workspace
+    ? merge_member_dependencies(loaded.manifest, loaded.members, project_root) : loaded.manifest, project_root, true);
+  project = std::move(loaded);
+}
+
+int run_command_line(int argc, const char** argv);
+
+// Handler for daemon subcommand: keep the project loaded and carry out the build, test and watch
+// commands that sail forwards to it, each in a process forked from the daemon
+int handle_daemon_command(bool stop) {
+  const auto project_root = find_project_root();
+  if (!project_root) {
+    fmt::print("Error: Sail.toml not found in current directory or any parent directory. Run 'sail init' first.\n");
+    return EXIT_FAILURE;
+  }
+  const std::filesystem::path socket_path = daemon_socket_path(*project_root);
+  if (stop) {
+    if (!stop_daemon(socket_path)) {
+      fmt::print("Error: No sail daemon is running for this project\n");
+      return EXIT_FAILURE;
+    }
+    fmt::print("Stopped the sail daemon\n");
+    return EXIT_SUCCESS;
+  }
+
+  LoadedProject project;
+  DaemonHandlers handlers;
+  handlers.prepare = [&]() {
+    try {
+      refresh_loaded_project(*project_root, project);
+    } catch (const std::exception&) {
+      // The commands load the project themselves and report what is wrong with it
+      project = LoadedProject{};
+      throw;
+    }
+  };
+  handlers.run = [&](const std::vector<std::string>& args) {
+    daemon_project = project.root.empty() ? nullptr : &project;
+    std::vector<const char*> argv = { "sail" };
+    for (const auto& arg : args) {
+      argv.push_back(arg.c_str());
+    }
+    return run_command_line(static_cast<int>(argv.size()), argv.data());
+  };
+  try {
+    handlers.prepare();
+  } catch (const std::exception& e) {
+    fmt::print("Warning: {}\n", e.what());
+  }
+  return serve_daemon(socket_path, handlers);
+}
+
+// Helper function for sail clean --gc: trim ccache to `max_bytes`. ccache evicts by itself, least
+// recently used first; its own max_size is left as configured for the builds. Returns the bytes it
+// dropped, or std::nullopt if this ccache does not report its size.
+std::optional<std::uint64_t> trim_ccache(const std::filesystem::path& ccache, std::uint64_t max_bytes) {
+  const auto cache_size = [&]() -> std::optional<std::uint64_t> {
+    const auto stats = run_capture({ ccache.string(), "--print-stats" });
+    if (!stats) {
+      return std::nullopt;
+    }
+    constexpr std::string_view field = "cache_size_kibibyte\t";
+    const size_t start = stats->find(field);
+    if (start == std::string::npos) {
+      return std::nullopt;
+    }
+    return std::strtoull(stats->c_str() + start + field.size(), nullptr, 10) * 1024;
+  };
+  const auto before = cache_size();
+  export_environment({ { "CCACHE_MAXSIZE", std::to_string(max_bytes / 1024) + "K" } });
+  if (!run_capture({ ccache.string(), "--cleanup" })) {
+    fmt::print("Warning: ccache --cleanup failed; the compiler cache was left as it is\n");
+    return std::nullopt;
+  }
+  const auto after = cache_size();
+  if (!before || !after) {
+    return std::nullopt;
+  }
+  return *before > *after ? *before - *after : 0;
+}
+
+// Handler for clean subcommand: remove target/, or with --gc only what no longer pays for itself:
+// objects of deleted sources, the build tree of the engine not in use, and the cache entries used
+// least recently once a cache outgrows `max_cache_size`
+int handle_clean_command(bool gc, const std::string& max_cache_size) {
+  const auto project_root = find_project_root();
+  if (!project_root) {
+    fmt::print("Error: Sail.toml not found in current directory or any parent directory. Run 'sail init' first.\n");
+    return EXIT_FAILURE;
+  }
+  const std::filesystem::path target_root = *project_root / "target";
+  std::error_code error;
+
+  if (!gc) {
+    Reclaimed removed;
+    std::vector<std::filesystem::path> entries;
+    for (const auto& entry : std::filesystem::directory_iterator(target_root, error)) {
+      // A running daemon keeps listening
+      if (entry.path() != daemon_socket_path(*project_root)) {
+        entries.push_back(entry.path());
+      }
+    }
+    for (const auto& entry : entries) {
+      removed += remove_counted(entry);
+    }
+    fmt::print("Removed {} files, {}\n", removed.files, format_bytes(removed.bytes));
+    return EXIT_SUCCESS;
+  }
+
+  const std::string size_text = !max_cache_size.empty() ? max_cache_size : get_env("SAIL_CACHE_MAX_SIZE");
+  const auto max_bytes = parse_byte_size(size_text.empty() ? "10G" : size_text);
+  if (!max_bytes) {
+    fmt::print("Error: Invalid cache size '{}', expected a size such as 512M or 10G\n", size_text);
+    return EXIT_FAILURE;
+  }
+  std::string engine = "cmake";
+  try {
+    engine = load_manifest(*project_root).build.engine;
+  } catch (const std::exception& e) {
+    fmt::print("Error: {}\n", e.what());
+    return EXIT_FAILURE;
+  }
+
+  Reclaimed total;
+  const auto report = [&](std::string_view step, const Reclaimed& reclaimed) {
+    if (reclaimed.files > 0) {
+      fmt::print("{}: {} files, {}\n", step, reclaimed.files, format_bytes(reclaimed.bytes));
+    }
+    total += reclaimed;
+  };
+  // target/debug, target/release and one directory per custom profile
+  std::vector<std::filesystem::path> mode_dirs;
+  for (const auto& entry : std::filesystem::directory_iterator(target_root, error)) {
+    if (entry.is_directory(error)) {
+      mode_dirs.push_back(entry.path());
+    }
+  }
+  std::sort(mode_dirs.begin(), mode_dirs.end());
+  for (const auto& mode_dir : mode_dirs) {
+    const std::string mode = mode_dir.filename().string();
+    report(fmt::format("Orphaned objects in target/{}", mode), remove_orphaned_objects(*project_root, mode_dir));
+    // Left behind by a switch of [build] engine, and never read again
+    const std::string_view unused_tree = engine == "native" ? "build" : "obj";
+    if (std::filesystem::is_directory(mode_dir / unused_tree, error)) {
+      report(fmt::format("Unused target/{}/{}", mode, unused_tree), remove_counted(mode_dir / unused_tree));
+    }
+  }
+  report("Artifact cache", evict_least_recently_used(artifact_cache_directory(), *max_bytes, EvictionUnit::Entries));
+  if (const auto ccache = find_program("ccache")) {
+    if (const auto trimmed = trim_ccache(*ccache, *max_bytes); trimmed && *trimmed > 0) {
+      fmt::print("ccache: {}\n", format_bytes(*trimmed));
+      total.bytes += *trimmed;
+    }
+  }
+  if (const std::filesystem::path sccache_dir = sccache_directory();
+      !sccache_dir.empty() && std::filesystem::is_directory(sccache_dir, error)) {
+    // A running sccache server keeps its own index of the cache; it rebuilds it on the next start
+    if (const auto sccache = find_program("sccache")) {
+      std::ignore = run_capture({ sccache->string(), "--stop-server" });
+    }
+    report("sccache", evict_least_recently_used(sccache_dir, *max_bytes, EvictionUnit::Files));
+  }
+  fmt::print("Reclaimed {} in total, caches limited to {}\n", format_bytes(total.bytes), format_bytes(*max_bytes));
+  return EXIT_SUCCESS;
+}
+
 // Handler for new subcommand
 int handle_new_command(const std::string& new_project_name) {
   const std::filesystem::path project_dir = std::filesystem::current_path() / new_project_name;
   
   // Check if directory already exists
   if (std::filesystem::exists(project_dir)) {
-    fmt::print("Directory '{}' already exists\\n", new_project_name);
+    fmt::print("Directory '{}' already exists\n", new_project_name);
     return EXIT_FAILURE;
   }
   
@@ -266,7 +1260,7 @@ version = "0.1.0"
     
     std::ofstream toml_file(sail_toml_path);
     if (!toml_file) {
-      fmt::print("Failed to create Sail.toml\\n");
+      fmt::print("Failed to create Sail.toml\n");
       return EXIT_FAILURE;
     }
     toml_file << sail_toml_content;
@@ -283,16 +1277,16 @@ int main() {
     
     std::ofstream cpp_file(main_cpp_path);
     if (!cpp_file) {
-      fmt::print("Failed to create src/main.cpp\\n");
+      fmt::print("Failed to create src/main.cpp\n");
       return EXIT_FAILURE;
     }
     cpp_file << main_cpp_content;
     
-    fmt::print("Created project '{}'\\n", new_project_name);
+    fmt::print("Created project '{}'\n", new_project_name);
     return EXIT_SUCCESS;
     
   } catch (const std::filesystem::filesystem_error& e) {
-    fmt::print("Failed to create project: {}\\n", e.what());
+    fmt::print("Failed to create project: {}\n", e.what());
     return EXIT_FAILURE;
   }
 }
@@ -312,76 +1306,197 @@ version = "0.1.0"
   const std::filesystem::path sail_toml_path = std::filesystem::current_path() / "Sail.toml";
   
   if (std::filesystem::exists(sail_toml_path)) {
-    fmt::print("Sail.toml already exists in current directory\\n");
+    fmt::print("Sail.toml already exists in current directory\n");
     return EXIT_FAILURE;
   }
   
   std::ofstream file(sail_toml_path);
   if (!file) {
-    fmt::print("Failed to create Sail.toml\\n");
+    fmt::print("Failed to create Sail.toml\n");
     return EXIT_FAILURE;
   }
   
   file << sail_toml_content;
-  fmt::print("Created Sail.toml\\n");
+  fmt::print("Created Sail.toml\n");
   return EXIT_SUCCESS;
 }
 
-// NOLINTNEXTLINE(bugprone-exception-escape)
-int main(int argc, const char **argv)
-{
-  try {
-    CLI::App app{ fmt::format("{} version {}", sail::cmake::project_name, sail::cmake::project_version) };
+// Parse the command line and carry it out; sail daemon calls this for the commands forwarded to it
+int run_command_line(int argc, const char** argv) {
+  CLI::App app{ fmt::format("{} version {}", sail::cmake::project_name, sail::cmake::project_version) };
 
-    std::optional<std::string> message;
-    app.add_option("-m,--message", message, "A message to print back out");
-    bool show_version = false;
-    app.add_flag("--version", show_version, "Show version information");
+  std::optional<std::string> message;
+  app.add_option("-m,--message", message, "A message to print back out");
+  bool show_version = false;
+  app.add_flag("--version", show_version, "Show version information");
 
-    bool is_turn_based = false;
-    auto *turn_based = app.add_flag("--turn_based", is_turn_based);
+  bool is_turn_based = false;
+  auto *turn_based = app.add_flag("--turn_based", is_turn_based);
 
-    bool is_loop_based = false;
-    auto *loop_based = app.add_flag("--loop_based", is_loop_based);
+  bool is_loop_based = false;
+  auto *loop_based = app.add_flag("--loop_based", is_loop_based);
 
-    turn_based->excludes(loop_based);
-    loop_based->excludes(turn_based);
+  turn_based->excludes(loop_based);
+  loop_based->excludes(turn_based);
 
-    auto* init_subcommand = app.add_subcommand("init", "Initialize a new Sail project");
-    auto* new_subcommand = app.add_subcommand("new", "Create a new Sail project");
-    auto* build_subcommand = app.add_subcommand("build", "Compile the current project");
-    auto* run_subcommand = app.add_subcommand("run", "Run the current project");
-    
-    std::string new_project_name;
-    new_subcommand->add_option("name", new_project_name, "Project name")->required();
-    
-    bool build_release = false;
-    build_subcommand->add_flag("--release", build_release, "Build in release mode");
-    
-    bool run_release = false;
-    std::vector<std::string> run_args;
-    run_subcommand->add_flag("--release", run_release, "Run in release mode");
-    
-    // Set up command handlers using the extracted functions
-    init_subcommand->callback([&]() { return handle_init_command(); });
-    new_subcommand->callback([&]() { return handle_new_command(new_project_name); });
-    build_subcommand->callback([&]() { return handle_build_command(build_release); });
-    run_subcommand->callback([&]() { return handle_run_command(run_release, run_args); });
+  auto* init_subcommand = app.add_subcommand("init", "Initialize a new Sail project");
+  auto* new_subcommand = app.add_subcommand("new", "Create a new Sail project");
+  auto* build_subcommand = app.add_subcommand("build", "Compile the current project");
+  auto* run_subcommand = app.add_subcommand("run", "Run the current project");
+  auto* test_subcommand = app.add_subcommand("test", "Build and run the test programs in tests/");
+  auto* bench_subcommand = app.add_subcommand("bench", "Build the programs in benches/ in release mode and time them");
+  auto* watch_subcommand = app.add_subcommand("watch", "Rebuild, or rebuild and rerun, whenever src, tests or Sail.toml change");
+  auto* daemon_subcommand = app.add_subcommand("daemon",
+    "Keep the project loaded and carry out build, run, test and watch for it until stopped");
+  auto* clean_subcommand = app.add_subcommand("clean", "Remove target/, or with --gc only stale build output and cache overflow");
+  
+  std::string new_project_name;
+  new_subcommand->add_option("name", new_project_name, "Project name")->required();
+  
+  BuildOptions build_options;
+  std::vector<std::string> build_profiles;
+  auto* build_release = build_subcommand->add_flag("--release", build_options.release_mode, "Build in release mode");
+  build_subcommand->add_option("--profile", build_profiles,
+    "Build these profiles, such as dev,release,asan; several are built at once, sharing the jobs")
+    ->delimiter(',')->excludes(build_release);
+  build_subcommand->add_option("-j,--jobs", build_options.jobs, "Number of parallel jobs (defaults to the number of cores)")
+    ->check(CLI::PositiveNumber);
+  build_subcommand->add_flag("--locked", build_options.locked, "Fail if Sail.lock would need to change");
+  build_subcommand->add_flag("--timings", build_options.timings, "Report time per phase and translation unit");
+  auto* build_pgo_generate = build_subcommand->add_flag("--pgo-generate", build_options.pgo_generate,
+    "Build with profiling instrumentation; run the program afterwards to collect profiles");
+  build_subcommand->add_flag("--pgo-use", build_options.pgo_use, "Optimize with the profiles collected after --pgo-generate")
+    ->excludes(build_pgo_generate);
+  
+  BuildOptions run_options;
+  std::vector<std::string> run_args;
+  auto* run_release = run_subcommand->add_flag("--release", run_options.release_mode, "Run in release mode");
+  run_subcommand->add_option("--profile", run_options.profile, "Build and run this profile, such as asan")->excludes(run_release);
+  run_subcommand->add_option("-j,--jobs", run_options.jobs, "Number of parallel jobs (defaults to the number of cores)")
+    ->check(CLI::PositiveNumber);
+  run_subcommand->add_flag("--locked", run_options.locked, "Fail if Sail.lock would need to change");
+  auto* run_pgo_generate = run_subcommand->add_flag("--pgo-generate", run_options.pgo_generate,
+    "Build with profiling instrumentation and collect profiles from this run");
+  run_subcommand->add_flag("--pgo-use", run_options.pgo_use, "Optimize with the profiles collected after --pgo-generate")
+    ->excludes(run_pgo_generate);
+  run_subcommand->add_option("args", run_args, "Arguments for the program; put them after -- so sail leaves them alone");
+  
+  BuildOptions test_options;
+  std::string test_shard;
+  std::vector<std::string> test_args;
+  auto* test_release = test_subcommand->add_flag("--release", test_options.release_mode, "Build and run the tests in release mode");
+  test_subcommand->add_option("--profile", test_options.profile, "Build and run the tests with this profile, such as asan")
+    ->excludes(test_release);
+  test_subcommand->add_option("-j,--jobs", test_options.jobs, "Number of parallel jobs (defaults to the number of cores)")
+    ->check(CLI::PositiveNumber);
+  test_subcommand->add_flag("--locked", test_options.locked, "Fail if Sail.lock would need to change");
+  test_subcommand->add_option("--shard", test_shard, "Run only slice i of n of the tests, such as 2/4, to split them across machines")
+    ->check(CLI::Validator([](const std::string& shard) {
+      return parse_test_shard(shard) ? std::string() : std::string("--shard expects i/n with 1 <= i <= n");
+    }, "I/N"));
+  test_subcommand->add_option("args", test_args, "Arguments for every test program; put them after --");
+  
+  BuildOptions bench_options;
+  BenchRunRequest bench_settings;
+  const auto baseline_name = CLI::Validator([](const std::string& name) {
+    return !name.empty() && name.find_first_of("/\\.") == std::string::npos ? std::string() : std::string("baseline names cannot contain / \\ or .");
+  }, "NAME");
+  bench_subcommand->add_option("-j,--jobs", bench_options.jobs, "Number of parallel build jobs (defaults to the number of cores)")
+    ->check(CLI::PositiveNumber);
+  bench_subcommand->add_flag("--locked", bench_options.locked, "Fail if Sail.lock would need to change");
+  bench_subcommand->add_option("--warmup", bench_settings.warmup, "Untimed runs of each benchmark first (default 1)");
+  bench_subcommand->add_option("--runs", bench_settings.repetitions, "Timed runs of each benchmark (default 10)")
+    ->check(CLI::PositiveNumber);
+  bench_subcommand->add_option("--cpu", bench_settings.cpu, "Pin the benchmarks to this CPU");
+  bench_subcommand->add_option("--save-baseline", bench_settings.save_baseline, "Also store the results as this baseline in target/bench")
+    ->check(baseline_name);
+  bench_subcommand->add_option("--baseline", bench_settings.baseline, "Compare against a baseline stored with --save-baseline")
+    ->check(baseline_name);
+  bench_subcommand->add_option("args", bench_settings.args, "Arguments for every bench program; put them after --");
+  
+  std::string watch_action = "build";
+  BuildOptions watch_options;
+  std::vector<std::string> watch_args;
+  watch_subcommand->add_option("action", watch_action, "What to do after each change: build (default), run or test")
+    ->check(CLI::IsMember({ "build", "run", "test" }));
+  watch_subcommand->add_flag("--release", watch_options.release_mode, "Build in release mode");
+  watch_subcommand->add_option("-j,--jobs", watch_options.jobs, "Number of parallel jobs (defaults to the number of cores)")
+    ->check(CLI::PositiveNumber);
+  watch_subcommand->add_flag("--locked", watch_options.locked, "Fail if Sail.lock would need to change");
+  watch_subcommand->add_option("args", watch_args, "Arguments for the program with run, or the tests with test; put them after --");
+  
+  bool stop_daemon_requested = false;
+  daemon_subcommand->add_flag("--stop", stop_daemon_requested, "Stop the daemon running for this project");
+  
+  bool clean_gc = false;
+  std::string clean_max_cache_size;
+  auto* clean_gc_flag = clean_subcommand->add_flag("--gc", clean_gc,
+    "Keep what is current: remove objects of deleted sources and evict least recently used cache entries");
+  clean_subcommand->add_option("--max-cache-size", clean_max_cache_size,
+    "Size each cache is trimmed to with --gc, such as 512M or 10G (default $SAIL_CACHE_MAX_SIZE or 10G)")
+    ->needs(clean_gc_flag);
+  
+  // Set up command handlers using the extracted functions; the handler's result is the exit status
+  int exit_code = EXIT_SUCCESS;
+  init_subcommand->callback([&]() { exit_code = handle_init_command(); });
+  new_subcommand->callback([&]() { exit_code = handle_new_command(new_project_name); });
+  build_subcommand->callback([&]() { exit_code = handle_build_command(build_options, build_profiles); });
+  run_subcommand->callback([&]() { exit_code = handle_run_command(run_options, run_args); });
+  test_subcommand->callback([&]() {
+    exit_code = handle_test_command(test_options, parse_test_shard(test_shard).value_or(TestShard{}), test_args);
+  });
+  bench_subcommand->callback([&]() { exit_code = handle_bench_command(bench_options, bench_settings); });
+  watch_subcommand->callback([&]() { exit_code = handle_watch_command(watch_action, watch_options, watch_args); });
+  daemon_subcommand->callback([&]() { exit_code = handle_daemon_command(stop_daemon_requested); });
+  clean_subcommand->callback([&]() { exit_code = handle_clean_command(clean_gc, clean_max_cache_size); });
 
-    CLI11_PARSE(app, argc, argv);
+  CLI11_PARSE(app, argc, argv);
 
-    if (show_version) {
-      fmt::print("{}\n", sail::cmake::project_version);
-      return EXIT_SUCCESS;
-    }
-    
-    if (init_subcommand->parsed() || new_subcommand->parsed() || build_subcommand->parsed() || run_subcommand->parsed()) {
-      return EXIT_SUCCESS;
+  if (show_version) {
+    fmt::print("{}\n", sail::cmake::project_version);
+    return EXIT_SUCCESS;
+  }
+
+  return exit_code;
+}
+
+// Helper function to tell whether sail daemon carries out a command line. The programs of sail run and
+// sail watch run are left out: they take the place of this sail, keeping its process, terminal and signals
+bool is_forwarded_to_daemon(int argc, const char** argv) {
+  const std::string_view command = argc >= 2 ? argv[1] : "";
+  if (command == "watch") {
+    // The action comes before the arguments for the program, which follow --
+    for (int index = 2; index < argc && std::string_view(argv[index]) != "--"; ++index) {
+      if (std::string_view(argv[index]) == "run") {
+        return false;
+      }
     }
+    return true;
+  }
+  return command == "build" || command == "test";
+}
 
+// NOLINTNEXTLINE(bugprone-exception-escape)
+int main(int argc, const char **argv)
+{
+  // Scripts and editor integrations ask for the version often; answer before any parser is built
+  if (argc == 2 && std::string_view(argv[1]) == "--version") {
+    fmt::print("{}\n", sail::cmake::project_version);
     return EXIT_SUCCESS;
+  }
+
+  try {
+    // With sail daemon running for the project, it carries out these commands with everything loaded
+    if (is_forwarded_to_daemon(argc, argv) && get_env("SAIL_NO_DAEMON").empty()) {
+      if (const auto project_root = find_project_root()) {
+        if (const auto exit_code = forward_to_daemon(daemon_socket_path(*project_root), std::vector<std::string>(argv + 1, argv + argc))) {
+          return *exit_code;
+        }
+      }
+    }
+    return run_command_line(argc, argv);
   } catch (const std::exception &e) {
-    spdlog::error("Unhandled exception in main: {}", e.what());
+    fmt::print(stderr, "Error: unhandled exception: {}\n", e.what());
     return EXIT_FAILURE;
   }
 }
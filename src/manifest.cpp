@@ -0,0 +1,478 @@
+#include "manifest.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fmt/format.h>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+// Bump whenever the snapshot layout or TomlValue changes
+constexpr std::string_view snapshot_magic = "SAILTOML1";
+
+void write_u64(std::string& out, std::uint64_t value) {
+  for (int shift = 0; shift < 64; shift += 8) {
+    out += static_cast<char>((value >> shift) & 0xFFU);
+  }
+}
+
+void write_string(std::string& out, std::string_view value) {
+  write_u64(out, value.size());
+  out += value;
+}
+
+void write_value(std::string& out, const TomlValue& value) {
+  out += static_cast<char>(value.type);
+  switch (value.type) {
+  case TomlValue::Type::String: write_string(out, value.string); break;
+  case TomlValue::Type::Integer: write_u64(out, static_cast<std::uint64_t>(value.integer)); break;
+  case TomlValue::Type::Float: write_string(out, fmt::format("{}", value.floating)); break;
+  case TomlValue::Type::Boolean: out += value.boolean ? '\1' : '\0'; break;
+  case TomlValue::Type::Array:
+    write_u64(out, value.array.size());
+    for (const auto& element : value.array) {
+      write_value(out, element);
+    }
+    break;
+  case TomlValue::Type::Table:
+    write_u64(out, value.keys.size());
+    for (size_t i = 0; i < value.keys.size(); ++i) {
+      write_string(out, value.keys[i]);
+      write_value(out, value.values[i]);
+    }
+    break;
+  }
+}
+
+// uint64_t is size_t on LP64 targets, where a cast would be useless; callers bound the value first
+template<typename Wide> std::size_t narrow_to_size(Wide value) {
+  if constexpr (std::is_same_v<Wide, std::size_t>) {
+    return value;
+  } else {
+    return static_cast<std::size_t>(value);
+  }
+}
+
+// Reader for snapshots; any inconsistency makes the snapshot unusable rather than fatal
+class SnapshotReader
+{
+public:
+  explicit SnapshotReader(std::string_view snapshot) : data(snapshot) {}
+
+  bool read_u64(std::uint64_t& value) {
+    if (data.size() - pos < 8) {
+      return false;
+    }
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 8) {
+      value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[pos++])) << shift;
+    }
+    return true;
+  }
+
+  // A length or count; each element takes at least one byte, so it cannot exceed what is left
+  bool read_size(size_t& value) {
+    std::uint64_t wide = 0;
+    if (!read_u64(wide) || wide > data.size() - pos) {
+      return false;
+    }
+    value = narrow_to_size(wide);
+    return true;
+  }
+
+  bool read_string(std::string& value) {
+    size_t size = 0;
+    if (!read_size(size)) {
+      return false;
+    }
+    value.assign(data.substr(pos, size));
+    pos += size;
+    return true;
+  }
+
+  bool read_value(TomlValue& value, int depth = 0) {
+    if (pos >= data.size() || depth > 64) {
+      return false;
+    }
+    const auto type = static_cast<unsigned char>(data[pos++]);
+    if (type > static_cast<unsigned char>(TomlValue::Type::Table)) {
+      return false;
+    }
+    value.type = static_cast<TomlValue::Type>(type);
+    std::uint64_t count = 0;
+    size_t length = 0;
+    switch (value.type) {
+    case TomlValue::Type::String: return read_string(value.string);
+    case TomlValue::Type::Integer:
+      if (!read_u64(count)) {
+        return false;
+      }
+      value.integer = static_cast<std::int64_t>(count);
+      return true;
+    case TomlValue::Type::Float: {
+      std::string text;
+      if (!read_string(text)) {
+        return false;
+      }
+      value.floating = std::stod(text);
+      return true;
+    }
+    case TomlValue::Type::Boolean:
+      if (pos >= data.size()) {
+        return false;
+      }
+      value.boolean = data[pos++] != '\0';
+      return true;
+    case TomlValue::Type::Array:
+      if (!read_size(length)) {
+        return false;
+      }
+      value.array.resize(length);
+      for (auto& element : value.array) {
+        if (!read_value(element, depth + 1)) {
+          return false;
+        }
+      }
+      return true;
+    case TomlValue::Type::Table:
+      if (!read_size(length)) {
+        return false;
+      }
+      value.keys.resize(length);
+      value.values.resize(length);
+      for (size_t i = 0; i < value.keys.size(); ++i) {
+        if (!read_string(value.keys[i]) || !read_value(value.values[i], depth + 1)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  [[nodiscard]] bool at_end() const noexcept { return pos == data.size(); }
+
+private:
+  std::string_view data;
+  size_t pos = 0;
+};
+
+std::optional<TomlValue> read_snapshot(const std::filesystem::path& snapshot_path, std::uint64_t content_hash) {
+  const auto snapshot = read_file(snapshot_path);
+  if (!snapshot || snapshot->compare(0, snapshot_magic.size(), snapshot_magic) != 0) {
+    return std::nullopt;
+  }
+  SnapshotReader reader(std::string_view(*snapshot).substr(snapshot_magic.size()));
+  std::uint64_t stored_hash = 0;
+  TomlValue document;
+  try {
+    if (!reader.read_u64(stored_hash) || stored_hash != content_hash || !reader.read_value(document) || !reader.at_end()) {
+      return std::nullopt;
+    }
+  } catch (const std::exception&) {
+    return std::nullopt;
+  }
+  return document;
+}
+
+// Best effort: a snapshot that cannot be written only costs a parse next time
+void write_snapshot(const std::filesystem::path& snapshot_path, std::uint64_t content_hash, const TomlValue& document) {
+  std::string snapshot(snapshot_magic);
+  write_u64(snapshot, content_hash);
+  write_value(snapshot, document);
+
+  std::error_code error;
+  std::filesystem::create_directories(snapshot_path.parent_path(), error);
+  const std::filesystem::path temporary_path = snapshot_path.string() + ".tmp";
+  {
+    std::ofstream snapshot_file(temporary_path, std::ios::binary);
+    if (!snapshot_file || !(snapshot_file << snapshot)) {
+      return;
+    }
+  }
+  std::filesystem::rename(temporary_path, snapshot_path, error);
+}
+
+const TomlValue* find_typed(const TomlValue& table, std::string_view table_name, std::string_view key, TomlValue::Type type) {
+  const TomlValue* value = table.find(key);
+  if (value != nullptr && value->type != type) {
+    throw std::runtime_error(fmt::format("Sail.toml: [{}] {} must be a {}, not a {}",
+      table_name, key, toml_type_name(type), toml_type_name(value->type)));
+  }
+  return value;
+}
+
+std::optional<std::string> string_entry(const TomlValue& table, std::string_view table_name, std::string_view key) {
+  const TomlValue* value = find_typed(table, table_name, key, TomlValue::Type::String);
+  return value != nullptr ? std::optional<std::string>(value->string) : std::nullopt;
+}
+
+std::optional<bool> bool_entry(const TomlValue& table, std::string_view table_name, std::string_view key) {
+  const TomlValue* value = find_typed(table, table_name, key, TomlValue::Type::Boolean);
+  return value != nullptr ? std::optional<bool>(value->boolean) : std::nullopt;
+}
+
+std::optional<unsigned> positive_entry(const TomlValue& table, std::string_view table_name, std::string_view key) {
+  const TomlValue* value = find_typed(table, table_name, key, TomlValue::Type::Integer);
+  if (value == nullptr) {
+    return std::nullopt;
+  }
+  if (value->integer <= 0 || value->integer > std::numeric_limits<unsigned>::max()) {
+    throw std::runtime_error(fmt::format("Sail.toml: [{}] {} must be a positive integer", table_name, key));
+  }
+  return static_cast<unsigned>(value->integer);
+}
+
+std::vector<std::string> string_array_entry(const TomlValue& table, std::string_view table_name, std::string_view key) {
+  std::vector<std::string> strings;
+  if (const TomlValue* value = find_typed(table, table_name, key, TomlValue::Type::Array)) {
+    for (const auto& element : value->array) {
+      if (element.type != TomlValue::Type::String) {
+        throw std::runtime_error(fmt::format("Sail.toml: [{}] {} must only contain strings", table_name, key));
+      }
+      strings.push_back(element.string);
+    }
+  }
+  return strings;
+}
+
+// Render a scalar the way CMake expects it in a cache variable
+std::string scalar_to_string(const TomlValue& value, std::string_view table_name, std::string_view key) {
+  switch (value.type) {
+  case TomlValue::Type::String: return value.string;
+  case TomlValue::Type::Integer: return std::to_string(value.integer);
+  case TomlValue::Type::Boolean: return value.boolean ? "ON" : "OFF";
+  default:
+    throw std::runtime_error(fmt::format("Sail.toml: [{}] {} must be a string, integer or boolean", table_name, key));
+  }
+}
+
+const TomlValue* table_entry(const TomlValue& document, std::string_view name) {
+  const TomlValue* table = document.find(name);
+  if (table != nullptr && !table->is_table()) {
+    throw std::runtime_error(fmt::format("Sail.toml: {} must be a table", name));
+  }
+  return table;
+}
+
+DependencySpec parse_dependency(const std::string& name, const TomlValue& entry) {
+  DependencySpec dependency;
+  dependency.name = name;
+  if (entry.type == TomlValue::Type::String) {
+    dependency.version = entry.string;
+    return dependency;
+  }
+  if (!entry.is_table()) {
+    throw std::runtime_error(fmt::format("Sail.toml: dependency '{}' must be a version string or a table", name));
+  }
+  const std::string table_name = "dependencies." + name;
+  dependency.version = string_entry(entry, table_name, "version").value_or("");
+  dependency.git = string_entry(entry, table_name, "git").value_or("");
+  dependency.tag = string_entry(entry, table_name, "tag").value_or("");
+  dependency.branch = string_entry(entry, table_name, "branch").value_or("");
+  dependency.rev = string_entry(entry, table_name, "rev").value_or("");
+  dependency.path = string_entry(entry, table_name, "path").value_or("");
+  dependency.targets = string_array_entry(entry, table_name, "targets");
+  dependency.prebuilt = bool_entry(entry, table_name, "prebuilt").value_or(true);
+  if (const TomlValue* options = find_typed(entry, table_name, "options", TomlValue::Type::Table)) {
+    for (size_t i = 0; i < options->keys.size(); ++i) {
+      dependency.options.emplace_back(options->keys[i], scalar_to_string(options->values[i], table_name, options->keys[i]));
+    }
+  }
+  if (!dependency.git.empty() && (!dependency.tag.empty() + !dependency.branch.empty() + !dependency.rev.empty()) > 1) {
+    throw std::runtime_error(fmt::format("Sail.toml: dependency '{}' may only set one of tag, branch or rev", name));
+  }
+  // A short hash cannot be asked of the remote; only a full one pins a commit
+  const bool full_hash = dependency.rev.size() == 40
+    && std::all_of(dependency.rev.begin(), dependency.rev.end(), [](unsigned char character) { return std::isxdigit(character) != 0; });
+  if (!dependency.rev.empty() && !full_hash) {
+    throw std::runtime_error(fmt::format("Sail.toml: dependency '{}' rev must be a full 40-character commit hash, not \"{}\"", name, dependency.rev));
+  }
+  if (dependency.version.empty() && dependency.git.empty() && dependency.path.empty()) {
+    throw std::runtime_error(fmt::format("Sail.toml: dependency '{}' needs a version, git or path", name));
+  }
+  return dependency;
+}
+
+ProfileSection parse_profile(const TomlValue& table, std::string_view name) {
+  const std::string table_name = fmt::format("profile.{}", name);
+  ProfileSection profile;
+  if (const TomlValue* lto = table.find("lto")) {
+    if (lto->type == TomlValue::Type::Boolean) {
+      profile.lto = lto->boolean ? "full" : "off";
+    } else {
+      profile.lto = string_entry(table, table_name, "lto");
+    }
+    if (*profile.lto != "off" && *profile.lto != "thin" && *profile.lto != "full") {
+      throw std::runtime_error(fmt::format("Sail.toml: [{}] lto must be \"off\", \"thin\" or \"full\", not \"{}\"", table_name, *profile.lto));
+    }
+  }
+  if (const TomlValue* opt_level = table.find("opt-level")) {
+    profile.opt_level = opt_level->type == TomlValue::Type::Integer ? std::to_string(opt_level->integer)
+                                                                    : string_entry(table, table_name, "opt-level").value_or("");
+    constexpr std::array<std::string_view, 6> levels{ "0", "1", "2", "3", "s", "z" };
+    if (std::find(levels.begin(), levels.end(), *profile.opt_level) == levels.end()) {
+      throw std::runtime_error(fmt::format("Sail.toml: [{}] opt-level must be 0 to 3, \"s\" or \"z\"", table_name));
+    }
+  }
+  profile.target_cpu = string_entry(table, table_name, "target-cpu");
+  if (table.find("sanitizers") != nullptr) {
+    profile.sanitizers = string_array_entry(table, table_name, "sanitizers");
+    constexpr std::array<std::string_view, 5> known{ "address", "leak", "undefined", "thread", "memory" };
+    const auto uses = [&](std::string_view sanitizer) {
+      return std::find(profile.sanitizers->begin(), profile.sanitizers->end(), sanitizer) != profile.sanitizers->end();
+    };
+    for (const auto& sanitizer : *profile.sanitizers) {
+      if (std::find(known.begin(), known.end(), sanitizer) == known.end()) {
+        throw std::runtime_error(fmt::format("Sail.toml: [{}] sanitizers has unknown sanitizer \"{}\", expected address, leak, "
+                                             "undefined, thread or memory", table_name, sanitizer));
+      }
+    }
+    // The runtimes of these cannot share a process
+    if (uses("thread") && (uses("address") || uses("leak"))) {
+      throw std::runtime_error(fmt::format("Sail.toml: [{}] the thread sanitizer cannot be combined with address or leak", table_name));
+    }
+    if (uses("memory") && (uses("address") || uses("leak") || uses("thread"))) {
+      throw std::runtime_error(fmt::format("Sail.toml: [{}] the memory sanitizer cannot be combined with address, leak or thread", table_name));
+    }
+  }
+  profile.hardening = bool_entry(table, table_name, "hardening");
+  profile.inherits = string_entry(table, table_name, "inherits");
+  if (profile.inherits && *profile.inherits != "dev" && *profile.inherits != "release") {
+    throw std::runtime_error(fmt::format("Sail.toml: [{}] inherits must be \"dev\" or \"release\"", table_name));
+  }
+  return profile;
+}
+
+DistributedSection parse_distributed(const TomlValue& value) {
+  DistributedSection distributed;
+  if (value.type == TomlValue::Type::String) {
+    distributed.backend = value.string;
+  } else if (value.is_table()) {
+    distributed.backend = string_entry(value, "build.distributed", "backend").value_or("");
+    distributed.hosts = string_entry(value, "build.distributed", "hosts");
+    distributed.endpoint = string_entry(value, "build.distributed", "endpoint");
+    distributed.instance = string_entry(value, "build.distributed", "instance");
+    distributed.jobs = positive_entry(value, "build.distributed", "jobs");
+  } else {
+    throw std::runtime_error("Sail.toml: [build] distributed must be a backend name or a table");
+  }
+  constexpr std::array<std::string_view, 4> backends{ "distcc", "icecc", "sccache", "recc" };
+  if (std::find(backends.begin(), backends.end(), distributed.backend) == backends.end()) {
+    throw std::runtime_error(fmt::format("Sail.toml: [build] distributed backend must be \"distcc\", \"icecc\", \"sccache\" or \"recc\", not \"{}\"", distributed.backend));
+  }
+  if (distributed.hosts && distributed.backend != "distcc") {
+    throw std::runtime_error("Sail.toml: [build.distributed] hosts only applies to distcc");
+  }
+  if ((distributed.endpoint || distributed.instance) && distributed.backend != "recc") {
+    throw std::runtime_error("Sail.toml: [build.distributed] endpoint and instance only apply to recc");
+  }
+  return distributed;
+}
+
+}// namespace
+
+Manifest manifest_from_toml(TomlValue document) {
+  Manifest manifest;
+
+  const TomlValue* project = table_entry(document, "project");
+  if (project != nullptr) {
+    manifest.project.name = string_entry(*project, "project", "name").value_or("");
+    manifest.project.version = string_entry(*project, "project", "version").value_or("");
+  }
+
+  if (const TomlValue* dependencies = table_entry(document, "dependencies")) {
+    for (size_t i = 0; i < dependencies->keys.size(); ++i) {
+      manifest.dependencies.push_back(parse_dependency(dependencies->keys[i], dependencies->values[i]));
+    }
+  }
+
+  if (const TomlValue* build = table_entry(document, "build")) {
+    manifest.build.jobs = positive_entry(*build, "build", "jobs");
+    manifest.build.generator = string_entry(*build, "build", "generator");
+    manifest.build.cache = string_entry(*build, "build", "cache");
+    manifest.build.engine = string_entry(*build, "build", "engine").value_or("cmake");
+    manifest.build.cxx_standard = positive_entry(*build, "build", "std");
+    if (manifest.build.cxx_standard) {
+      constexpr std::array<unsigned, 6> standards{ 11, 14, 17, 20, 23, 26 };
+      if (std::find(standards.begin(), standards.end(), *manifest.build.cxx_standard) == standards.end()) {
+        throw std::runtime_error(fmt::format("Sail.toml: [build] std must be one of 11, 14, 17, 20, 23 or 26, not {}", *manifest.build.cxx_standard));
+      }
+    }
+    manifest.build.linker = string_entry(*build, "build", "linker");
+    if (manifest.build.linker) {
+      constexpr std::array<std::string_view, 5> linkers{ "mold", "lld", "gold", "bfd", "default" };
+      if (std::find(linkers.begin(), linkers.end(), *manifest.build.linker) == linkers.end()) {
+        throw std::runtime_error(fmt::format("Sail.toml: [build] linker must be \"mold\", \"lld\", \"gold\", \"bfd\" or \"default\", not \"{}\"", *manifest.build.linker));
+      }
+    }
+    manifest.build.prebuilt = bool_entry(*build, "build", "prebuilt").value_or(true);
+    manifest.build.unity = bool_entry(*build, "build", "unity").value_or(false);
+    manifest.build.pch = string_array_entry(*build, "build", "pch");
+    manifest.build.unity_batch_size = positive_entry(*build, "build", "unity-batch-size").value_or(manifest.build.unity_batch_size);
+    if (const TomlValue* distributed = build->find("distributed")) {
+      manifest.build.distributed = parse_distributed(*distributed);
+    }
+  }
+
+  if (const TomlValue* workspace = table_entry(document, "workspace")) {
+    manifest.workspace = WorkspaceSection{ string_array_entry(*workspace, "workspace", "members") };
+    if (project != nullptr) {
+      throw std::runtime_error("Sail.toml: a [workspace] root cannot also be a [project]; move the project into a member directory");
+    }
+  }
+
+  if (const TomlValue* profiles = table_entry(document, "profile")) {
+    for (size_t i = 0; i < profiles->keys.size(); ++i) {
+      const std::string& name = profiles->keys[i];
+      if (!profiles->values[i].is_table()) {
+        throw std::runtime_error(fmt::format("Sail.toml: profile.{} must be a table", name));
+      }
+      // Profile names become directories under target/, where debug is the dev profile's
+      const bool valid_name = !name.empty() && std::all_of(name.begin(), name.end(), [](char character) {
+        return (character >= 'a' && character <= 'z') || (character >= '0' && character <= '9') || character == '-' || character == '_';
+      });
+      if (!valid_name || name == "debug") {
+        throw std::runtime_error(fmt::format("Sail.toml: [profile.{}] is not a valid profile name; use lowercase letters, "
+                                             "digits, - and _, and dev rather than debug", name));
+      }
+      ProfileSection profile = parse_profile(profiles->values[i], name);
+      if (name == "dev" || name == "release") {
+        if (profile.inherits) {
+          throw std::runtime_error(fmt::format("Sail.toml: [profile.{}] cannot inherit; only custom profiles do", name));
+        }
+        (name == "dev" ? manifest.dev_profile : manifest.release_profile) = std::move(profile);
+      } else {
+        manifest.custom_profiles[name] = std::move(profile);
+      }
+    }
+  }
+
+  manifest.document = std::move(document);
+  return manifest;
+}
+
+Manifest load_manifest(const std::filesystem::path& project_root) {
+  const auto content = read_file(project_root / "Sail.toml");
+  if (!content) {
+    throw std::runtime_error("Failed to read Sail.toml");
+  }
+
+  const std::uint64_t content_hash = fnv1a_hash(*content);
+  const std::filesystem::path snapshot_path = project_root / "target" / "manifest.cache";
+  if (auto document = read_snapshot(snapshot_path, content_hash)) {
+    return manifest_from_toml(std::move(*document));
+  }
+
+  TomlValue document = parse_toml(*content, (project_root / "Sail.toml").string());
+  write_snapshot(snapshot_path, content_hash, document);
+  return manifest_from_toml(std::move(document));
+}
@@ -0,0 +1,121 @@
+#ifndef SAIL_MANIFEST_HPP
+#define SAIL_MANIFEST_HPP
+
+#include "toml.hpp"
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// [project] table
+struct ProjectSection
+{
+  std::string name;
+  std::string version;
+};
+
+// One entry of the [dependencies] table. `name = "1.2.3"` is shorthand for a registry version;
+// the table form also accepts `git` with one of `tag`/`branch`/`rev`, or a local `path`.
+// `targets` names the CMake targets to link and `options` are cache variables set before the
+// dependency is added to the build. `prebuilt = false` always builds it as part of the project.
+struct DependencySpec
+{
+  std::string name;
+  std::string version;
+  std::string git;
+  std::string tag;
+  std::string branch;
+  std::string rev;
+  std::string path;
+  std::vector<std::string> targets;
+  std::vector<std::pair<std::string, std::string>> options;
+  bool prebuilt = true;
+};
+
+// [build] distributed: a pool of machines that compiles the C and C++ sources; links stay local
+struct DistributedSection
+{
+  // "distcc", "icecc", "sccache" (sccache-dist) or "recc" (Remote Execution API)
+  std::string backend;
+  // distcc's host list, as in DISTCC_HOSTS
+  std::optional<std::string> hosts;
+  // recc's remote execution endpoint, such as "http://farm:8980", and the instance name on it
+  std::optional<std::string> endpoint;
+  std::optional<std::string> instance;
+  // Compile jobs in flight at once
+  std::optional<unsigned> jobs;
+};
+
+// [build] table; unset keys are left for the build to auto-detect
+struct BuildSection
+{
+  std::optional<unsigned> jobs;
+  std::optional<std::string> generator;
+  std::optional<std::string> cache;
+  std::string engine = "cmake";
+  // "mold", "lld", "gold", "bfd" or "default"; auto-detected when unset
+  std::optional<std::string> linker;
+  // C++ standard, e.g. 20; unset leaves it to the project's CMakeLists.txt (17 with the native engine)
+  std::optional<unsigned> cxx_standard;
+  // Use the shared prebuilt artifact cache for git dependencies
+  bool prebuilt = true;
+  // Compile the project's sources in batches of unity_batch_size files per translation unit
+  bool unity = false;
+  unsigned unity_batch_size = 8;
+  // Headers to precompile for every C++ source, e.g. "<vector>", "fmt/format.h" or "src/common.hpp"
+  std::vector<std::string> pch;
+  // `distributed = "distcc"` or a table with the backend's settings
+  std::optional<DistributedSection> distributed;
+};
+
+// [profile.dev], [profile.release] or a custom [profile.<name>]; unset keys keep the flags CMake
+// uses for the build type, or those of the profile a custom one inherits
+struct ProfileSection
+{
+  // Custom profiles only: "dev" (the default) or "release", whose build type and settings they start from
+  std::optional<std::string> inherits;
+  // "off", "thin" or "full"; `lto = true` means "full"
+  std::optional<std::string> lto;
+  // "0", "1", "2", "3", "s" or "z"
+  std::optional<std::string> opt_level;
+  // Passed as -march, e.g. "native"
+  std::optional<std::string> target_cpu;
+  // Any of "address", "leak", "undefined", "thread" and "memory", as cmake/Sanitizers.cmake combines them
+  std::optional<std::vector<std::string>> sanitizers;
+  // The flags of cmake/Hardening.cmake: library assertions, _FORTIFY_SOURCE=3, stack and control-flow protection
+  std::optional<bool> hardening;
+};
+
+// [workspace] table of a root Sail.toml that builds several projects in one build tree
+struct WorkspaceSection
+{
+  // Member directories relative to the workspace root; "dir/*" stands for every project directly under dir
+  std::vector<std::string> members;
+};
+
+// Typed view of Sail.toml. `document` keeps the full parse tree for tables without a typed section yet.
+struct Manifest
+{
+  ProjectSection project;
+  std::vector<DependencySpec> dependencies;
+  BuildSection build;
+  ProfileSection dev_profile;
+  ProfileSection release_profile;
+  // Every other [profile.<name>], by name
+  std::map<std::string, ProfileSection> custom_profiles;
+  std::optional<WorkspaceSection> workspace;
+  TomlValue document;
+};
+
+// Load <project_root>/Sail.toml. The parse tree is cached in target/manifest.cache, keyed by the
+// hash of the file contents, so unchanged manifests are not parsed again. Throws std::runtime_error
+// (or TomlParseError) when the file is missing or invalid.
+[[nodiscard]] Manifest load_manifest(const std::filesystem::path& project_root);
+
+// Build the typed view from an already parsed document; throws std::runtime_error on type errors
+[[nodiscard]] Manifest manifest_from_toml(TomlValue document);
+
+#endif
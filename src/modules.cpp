@@ -0,0 +1,148 @@
+#include "modules.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+// Blank out comments and string or character literals, keeping line breaks, so that
+// declarations can be matched line by line
+std::string strip_comments_and_literals(std::string_view source) {
+  std::string stripped(source);
+  size_t pos = 0;
+  const auto blank = [&](size_t from, size_t to) {
+    for (size_t i = from; i < to && i < stripped.size(); ++i) {
+      if (stripped[i] != '\n') {
+        stripped[i] = ' ';
+      }
+    }
+  };
+  while (pos < source.size()) {
+    if (source.compare(pos, 2, "//") == 0) {
+      const size_t end = source.find('\n', pos);
+      blank(pos, end == std::string_view::npos ? source.size() : end);
+      pos = end == std::string_view::npos ? source.size() : end;
+    } else if (source.compare(pos, 2, "/*") == 0) {
+      const size_t end = source.find("*/", pos + 2);
+      const size_t stop = end == std::string_view::npos ? source.size() : end + 2;
+      blank(pos, stop);
+      pos = stop;
+    } else if (source[pos] == 'R' && pos + 1 < source.size() && source[pos + 1] == '"'
+               && (pos == 0 || (std::isalnum(static_cast<unsigned char>(source[pos - 1])) == 0 && source[pos - 1] != '_'))) {
+      // Raw string: R"delimiter( ... )delimiter"
+      const size_t open = source.find('(', pos + 2);
+      if (open == std::string_view::npos) {
+        break;
+      }
+      const std::string terminator = ")" + std::string(source.substr(pos + 2, open - pos - 2)) + "\"";
+      const size_t end = source.find(terminator, open);
+      const size_t stop = end == std::string_view::npos ? source.size() : end + terminator.size();
+      blank(pos, stop);
+      pos = stop;
+    } else if (source[pos] == '"' || (source[pos] == '\'' && (pos == 0 || std::isxdigit(static_cast<unsigned char>(source[pos - 1])) == 0))) {
+      // A quote after a hex digit is a digit separator, not a character literal
+      const char quote = source[pos];
+      size_t end = pos + 1;
+      while (end < source.size() && source[end] != quote && source[end] != '\n') {
+        end += source[end] == '\\' ? 2U : 1U;
+      }
+      // Keep quoted header-unit names; nothing else between quotes matters here
+      blank(pos + 1, std::min(end, source.size()));
+      pos = end + 1;
+    } else {
+      ++pos;
+    }
+  }
+  return stripped;
+}
+
+bool is_identifier_char(char character) {
+  return std::isalnum(static_cast<unsigned char>(character)) != 0 || character == '_';
+}
+
+std::string_view next_word(std::string_view line, size_t& pos) {
+  while (pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos])) != 0) {
+    ++pos;
+  }
+  const size_t start = pos;
+  while (pos < line.size() && is_identifier_char(line[pos])) {
+    ++pos;
+  }
+  return line.substr(start, pos - start);
+}
+
+// Collect the text up to the ";" without whitespace; false if the line has none
+bool declaration_operand(std::string_view line, size_t pos, std::string& operand) {
+  const size_t end = line.find(';', pos);
+  if (end == std::string_view::npos) {
+    return false;
+  }
+  operand.clear();
+  for (size_t i = pos; i < end; ++i) {
+    if (std::isspace(static_cast<unsigned char>(line[i])) == 0) {
+      operand += line[i];
+    }
+  }
+  return true;
+}
+
+}// namespace
+
+ModuleUnit scan_module_unit(std::string_view source) {
+  ModuleUnit unit;
+  std::string module_name;
+  std::istringstream lines(strip_comments_and_literals(source));
+  std::string line;
+  while (std::getline(lines, line)) {
+    size_t pos = 0;
+    std::string_view word = next_word(line, pos);
+    const bool exported = word == "export";
+    if (exported) {
+      word = next_word(line, pos);
+    }
+    if (word != "module" && word != "import") {
+      continue;
+    }
+    // `module` and `import` are only keywords when a name, partition, header or ';' follows
+    size_t operand_start = pos;
+    while (operand_start < line.size() && std::isspace(static_cast<unsigned char>(line[operand_start])) != 0) {
+      ++operand_start;
+    }
+    if (operand_start < line.size() && !is_identifier_char(line[operand_start]) && line[operand_start] != ':'
+        && line[operand_start] != ';' && line[operand_start] != '<' && line[operand_start] != '"') {
+      continue;
+    }
+    std::string operand;
+    if (!declaration_operand(line, operand_start, operand)) {
+      continue;
+    }
+
+    if (word == "module") {
+      // `module;` opens the global module fragment and `module :private;` the private fragment
+      if (operand.empty() || operand == ":private") {
+        continue;
+      }
+      unit.is_module_unit = true;
+      module_name = operand.substr(0, operand.find(':'));
+      if (exported || operand.find(':') != std::string::npos) {
+        unit.provides = operand;
+      } else {
+        unit.imports.push_back(operand);
+      }
+      continue;
+    }
+
+    if (operand.empty() || operand.front() == '<' || operand.front() == '"') {
+      continue;
+    }
+    unit.imports.push_back(operand.front() == ':' ? module_name + operand : operand);
+  }
+  return unit;
+}
+
+std::string module_bmi_stem(std::string_view module_name) {
+  std::string stem(module_name);
+  std::replace(stem.begin(), stem.end(), ':', '-');
+  return stem;
+}
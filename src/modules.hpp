@@ -0,0 +1,28 @@
+#ifndef SAIL_MODULES_HPP
+#define SAIL_MODULES_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The C++20 module declarations of one source file
+struct ModuleUnit
+{
+  // Module or partition whose BMI the file produces, such as "math" or "math:detail"; empty otherwise
+  std::string provides;
+  // Imported modules, with partitions spelled in full ("math:detail"). Header units are not listed.
+  std::vector<std::string> imports;
+  // Whether the file declares a module at all, including implementation units
+  bool is_module_unit = false;
+};
+
+// Find the module, import and export import declarations in a source file without preprocessing it.
+// Declarations must start a line, which is how they are written in practice; comments and string
+// literals are skipped. An implementation unit `module m;` imports m.
+[[nodiscard]] ModuleUnit scan_module_unit(std::string_view source);
+
+// File name for a module's BMI. Partitions use '-' for ':', which is the name Clang looks for
+// under -fprebuilt-module-path.
+[[nodiscard]] std::string module_bmi_stem(std::string_view module_name);
+
+#endif
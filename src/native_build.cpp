@@ -0,0 +1,628 @@
+#include "modules.hpp"
+#include "native_build.hpp"
+#include "process.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+// One translation unit together with the files the compiler produces for it
+struct CompileJob
+{
+  std::filesystem::path source;
+  std::filesystem::path object;
+  std::filesystem::path depfile;
+  std::vector<std::string> command;
+  // BMI the compile writes, for module interface units
+  std::filesystem::path bmi;
+  // BMIs of the modules the unit imports
+  std::vector<std::filesystem::path> imported_bmis;
+};
+
+// A translation unit to compile and the project sources it covers
+struct TranslationUnit
+{
+  std::filesystem::path source;
+  std::vector<std::filesystem::path> members;
+};
+
+// Group the sources into generated unity files of up to batch_size sources each, C and C++
+// separately. The files are only rewritten when their batch changes, so untouched batches stay built.
+std::vector<TranslationUnit> make_unity_units(const std::vector<std::filesystem::path>& sources,
+                                              const std::filesystem::path& unity_dir, unsigned batch_size) {
+  std::vector<TranslationUnit> units;
+  std::filesystem::create_directories(unity_dir);
+  for (const std::string_view extension : { ".cpp", ".c" }) {
+    std::vector<std::filesystem::path> batch;
+    const auto flush = [&]() {
+      if (batch.empty()) {
+        return;
+      }
+      TranslationUnit unit;
+      unit.source = unity_dir / fmt::format("unity_{}{}", units.size(), extension);
+      std::string content = "// Generated by sail for a unity build. Do not edit.\n";
+      for (const auto& member : batch) {
+        content += fmt::format("#include \"{}\"\n", member.generic_string());
+      }
+      write_file_if_changed(unit.source, content);
+      unit.members = std::move(batch);
+      batch.clear();
+      units.push_back(std::move(unit));
+    };
+    for (const auto& source : sources) {
+      if (source.extension() == extension) {
+        batch.push_back(source);
+        if (batch.size() == batch_size) {
+          flush();
+        }
+      }
+    }
+    flush();
+  }
+  return units;
+}
+
+// Clang looks for <header>.pch next to a -include'd header, GCC for <header>.gch
+bool is_clang(const std::string& compiler) {
+  const auto version = run_capture({ compiler, "--version" }, std::chrono::seconds(30));
+  return version && version->find("clang") != std::string::npos;
+}
+
+// Flags shared by every compile, matching what CMake uses for the Debug and Release build types
+std::vector<std::string> mode_flags(bool release_mode) {
+  if (release_mode) {
+    return { "-O3", "-DNDEBUG" };
+  }
+  return { "-O0", "-g" };
+}
+
+void append(std::vector<std::string>& arguments, const std::vector<std::string>& more) {
+  arguments.insert(arguments.end(), more.begin(), more.end());
+}
+
+// The compile_commands.json entry for `file` compiled by `job`, without the compiler launcher that
+// starts the command. A unity member gets the command of its unity file, naming the member instead.
+std::string compilation_database_entry(const std::filesystem::path& directory, const CompileJob& job,
+                                       const std::filesystem::path& file, size_t launcher_size) {
+  std::string arguments;
+  for (size_t i = launcher_size; i < job.command.size(); ++i) {
+    arguments += fmt::format("{}{}", arguments.empty() ? "" : ", ",
+      json_quote(job.command[i] == job.source.string() ? file.string() : job.command[i]));
+  }
+  return fmt::format("  {{ \"directory\": {}, \"file\": {}, \"output\": {}, \"arguments\": [{}] }}",
+    json_quote(directory.string()), json_quote(file.string()), json_quote(job.object.string()), arguments);
+}
+
+// Parse the prerequisites out of a Makefile-style depfile written by -MMD
+std::vector<std::filesystem::path> read_depfile(const std::filesystem::path& depfile) {
+  std::vector<std::filesystem::path> dependencies;
+  const auto content = read_file(depfile);
+  if (!content) {
+    return dependencies;
+  }
+
+  // Skip the "target:" part; a colon followed by whitespace ends it, so drive letters survive
+  size_t pos = 0;
+  while (pos < content->size()) {
+    if ((*content)[pos] == ':' && (pos + 1 == content->size() || std::isspace(static_cast<unsigned char>((*content)[pos + 1])) != 0)) {
+      ++pos;
+      break;
+    }
+    ++pos;
+  }
+
+  std::string current;
+  for (; pos < content->size(); ++pos) {
+    const char character = (*content)[pos];
+    if (character == '\\' && pos + 1 < content->size()) {
+      const char next = (*content)[pos + 1];
+      if (next == '\n' || next == '\r') {
+        ++pos;
+        continue;
+      }
+      if (next == ' ' || next == '#' || next == '\\') {
+        current += next;
+        ++pos;
+        continue;
+      }
+    }
+    if (character == '$' && pos + 1 < content->size() && (*content)[pos + 1] == '$') {
+      current += '$';
+      ++pos;
+      continue;
+    }
+    // Only the first rule lists prerequisites; GCC appends module bookkeeping rules after it
+    if (character == '\n') {
+      break;
+    }
+    if (std::isspace(static_cast<unsigned char>(character)) != 0) {
+      if (!current.empty()) {
+        dependencies.emplace_back(current);
+        current.clear();
+      }
+      continue;
+    }
+    current += character;
+  }
+  if (!current.empty()) {
+    dependencies.emplace_back(current);
+  }
+  return dependencies;
+}
+
+// An object is stale if it is missing or older than its source, any header it included last
+// time or any BMI it imports. Module interface units are also stale when their BMI is missing.
+bool is_object_stale(const CompileJob& job) {
+  std::error_code error;
+  const auto object_time = std::filesystem::last_write_time(job.object, error);
+  if (error || !std::filesystem::exists(job.depfile, error)
+      || (!job.bmi.empty() && !std::filesystem::exists(job.bmi, error))) {
+    return true;
+  }
+
+  std::vector<std::filesystem::path> dependencies = read_depfile(job.depfile);
+  dependencies.push_back(job.source);
+  dependencies.insert(dependencies.end(), job.imported_bmis.begin(), job.imported_bmis.end());
+  return std::any_of(dependencies.begin(), dependencies.end(), [&](const std::filesystem::path& dependency) {
+    std::error_code dependency_error;
+    const auto dependency_time = std::filesystem::last_write_time(dependency, dependency_error);
+    return dependency_error || dependency_time > object_time;
+  });
+}
+
+// Run the compile commands on up to `jobs` workers; labels name each command in the timings.
+// Each compiler's diagnostics are printed in one piece once it exits, so that concurrent jobs do
+// not garble each other's messages. No new commands are started after the first failure.
+bool run_parallel(const std::vector<std::vector<std::string>>& commands, const std::vector<std::string>& labels, unsigned jobs,
+                  BuildTimings* timings) {
+  return run_processes(commands, jobs, ProcessOptions{ ProcessOutput::Capture },
+    [&](size_t index, unsigned lane, const ProcessResult& result) {
+      if (!result.output.empty()) {
+        fmt::print("{}", result.output);
+      }
+      if (!result.error.empty()) {
+        fmt::print("Error: {}\n", result.error);
+      }
+      if (timings != nullptr) {
+        const auto end = BuildTimings::Clock::now();
+        timings->record(labels[index], "compile", end - result.elapsed, end, lane);
+      }
+    });
+}
+
+// Order the jobs into layers so that every job comes after the providers of the modules it
+// imports; the jobs of one layer do not depend on each other. Imports no job provides, such as
+// `import std;`, are left to the compiler. Throws on an import cycle.
+std::vector<std::vector<size_t>> schedule_module_layers(const std::vector<ModuleUnit>& modules) {
+  std::map<std::string, size_t> providers;
+  for (size_t i = 0; i < modules.size(); ++i) {
+    if (!modules[i].provides.empty() && !providers.emplace(modules[i].provides, i).second) {
+      throw std::runtime_error(fmt::format("module '{}' is declared by more than one source", modules[i].provides));
+    }
+  }
+
+  constexpr size_t unvisited = static_cast<size_t>(-1);
+  constexpr size_t visiting = unvisited - 1;
+  std::vector<size_t> layer_of(modules.size(), unvisited);
+  const auto layer = [&](const auto& self, size_t index) -> size_t {
+    if (layer_of[index] == visiting) {
+      throw std::runtime_error(fmt::format("module '{}' imports itself through its imports", modules[index].provides));
+    }
+    if (layer_of[index] != unvisited) {
+      return layer_of[index];
+    }
+    layer_of[index] = visiting;
+    size_t depth = 0;
+    for (const auto& import : modules[index].imports) {
+      const auto provider = providers.find(import);
+      if (provider != providers.end()) {
+        depth = std::max(depth, self(self, provider->second) + 1);
+      }
+    }
+    layer_of[index] = depth;
+    return depth;
+  };
+
+  std::vector<std::vector<size_t>> layers;
+  for (size_t i = 0; i < modules.size(); ++i) {
+    const size_t depth = layer(layer, i);
+    if (layers.size() <= depth) {
+      layers.resize(depth + 1);
+    }
+    layers[depth].push_back(i);
+  }
+  return layers;
+}
+
+// Check a stored fingerprint and replace it; returns true if it changed
+bool update_fingerprint(const std::filesystem::path& fingerprint_path, const std::string& fingerprint) {
+  if (read_file(fingerprint_path) == fingerprint) {
+    return false;
+  }
+  std::ofstream fingerprint_file(fingerprint_path, std::ios::binary);
+  fingerprint_file << fingerprint;
+  return true;
+}
+
+}// namespace
+
+int native_build(const NativeBuildRequest& request) {
+  std::string cxx = get_env("CXX");
+  if (cxx.empty()) {
+    cxx = "c++";
+  }
+  std::string cc = get_env("CC");
+  if (cc.empty()) {
+    cc = "cc";
+  }
+  if (std::filesystem::path(cxx).stem() == "cl") {
+    fmt::print("Error: the native build engine needs a GCC or Clang compatible compiler; use engine = \"cmake\" with MSVC\n");
+    return EXIT_FAILURE;
+  }
+
+  const std::filesystem::path src_dir = request.project_root / "src";
+  const std::filesystem::path obj_dir = request.target_dir / "obj";
+  std::filesystem::create_directories(obj_dir);
+
+  // Every compile command starts with the launcher, if there is one
+  std::vector<std::string> launcher;
+  if (!request.compiler_launcher.empty()) {
+    launcher.push_back(request.compiler_launcher);
+  }
+  std::vector<std::string> include_flags;
+  for (const auto& include_dir : request.include_dirs) {
+    include_flags.push_back("-I" + include_dir.string());
+  }
+  // Reading every source for module declarations is only worth it once the project has an interface unit
+  std::vector<std::filesystem::path> sources = collect_sources(src_dir);
+  const std::vector<std::filesystem::path> module_sources = collect_module_sources(src_dir);
+  const bool uses_modules = !module_sources.empty();
+  if (uses_modules && request.cxx_standard < 20) {
+    fmt::print("Error: module interface units in src need [build] std = 20 or later\n");
+    return EXIT_FAILURE;
+  }
+  const bool needs_compiler_kind = uses_modules || !request.precompiled_headers.empty() || request.pgo != PgoMode::None
+    || (request.profile.lto && *request.profile.lto != "off") || request.profile.hardening.value_or(false);
+  const bool clang = needs_compiler_kind && is_clang(cxx);
+  const ProfileFlags profile = profile_flags(request.profile, request.pgo, request.pgo_dir, clang, request.release_mode);
+
+  const std::filesystem::path module_dir = obj_dir / "modules";
+  std::vector<std::string> module_flags;
+  if (uses_modules) {
+    // GCC finds BMIs through a mapper file written below; Clang looks up <name>.pcm in a directory
+    if (clang) {
+      module_flags = { "-fprebuilt-module-path=" + module_dir.string() };
+    } else {
+      module_flags = { "-fmodules-ts", "-fmodule-mapper=" + (module_dir / "modules.map").string() };
+    }
+  }
+  std::vector<std::string> cxx_flags = { fmt::format("-std=c++{}", request.cxx_standard) };
+  append(cxx_flags, mode_flags(request.release_mode));
+  append(cxx_flags, profile.compile);
+  append(cxx_flags, include_flags);
+  append(cxx_flags, module_flags);
+  std::vector<std::string> c_flags = mode_flags(request.release_mode);
+  append(c_flags, profile.compile);
+  append(c_flags, include_flags);
+
+  // Objects built with other flags or another compiler cannot be reused
+  std::string precompiled_headers;
+  for (const auto& header : request.precompiled_headers) {
+    precompiled_headers += header + "\n";
+  }
+  const std::string compile_fingerprint = fmt::format("{:016x}", fnv1a_hash(fmt::format("{}\n{}\n{}\n{}\n{}\n{}",
+    format_command(launcher), cxx, format_command(cxx_flags), cc, format_command(c_flags), precompiled_headers)));
+  if (update_fingerprint(obj_dir / "compile.fingerprint", compile_fingerprint)) {
+    for (const auto& entry : std::filesystem::directory_iterator(obj_dir)) {
+      if (entry.path().filename() != "compile.fingerprint") {
+        std::filesystem::remove_all(entry.path());
+      }
+    }
+  }
+
+  // The precompiled header is built with the same flags as the sources, and rebuilding it makes
+  // every object that was compiled against the old one stale
+  std::vector<std::string> pch_flags;
+  bool pch_rebuilt = false;
+  if (!request.precompiled_headers.empty()) {
+    const std::filesystem::path pch_dir = obj_dir / "pch";
+    std::filesystem::create_directories(pch_dir);
+    CompileJob pch;
+    pch.source = pch_dir / "sail_pch.hpp";
+    std::string content = "// Generated by sail from [build] pch. Do not edit.\n";
+    for (const auto& header : request.precompiled_headers) {
+      content += "#include " + pch_include_spelling(header, request.project_root) + "\n";
+    }
+    write_file_if_changed(pch.source, content);
+    pch.object = pch.source;
+    pch.object += clang ? ".pch" : ".gch";
+    pch.depfile = pch_dir / "sail_pch.d";
+    pch.command = launcher;
+    pch.command.push_back(cxx);
+    append(pch.command, cxx_flags);
+    append(pch.command, { "-x", "c++-header", "-MMD", "-MF", pch.depfile.string(), pch.source.string(), "-o", pch.object.string() });
+
+    if (is_object_stale(pch)) {
+      fmt::print("Precompiling {} header(s)\n", request.precompiled_headers.size());
+      const auto start = BuildTimings::Clock::now();
+      const ProcessResult result = run_process(pch.command);
+      if (!result.success()) {
+        fmt::print("Error: Failed to precompile the headers in [build] pch{}\n", result.error.empty() ? "" : ": " + result.error);
+        return EXIT_FAILURE;
+      }
+      if (request.timings != nullptr) {
+        request.timings->record("precompiled headers", "compile", start, BuildTimings::Clock::now(), 1);
+      }
+      pch_rebuilt = true;
+    }
+    pch_flags = { "-include", pch.source.string() };
+  }
+
+  // Sources that declare or import modules are compiled on their own, never inside a unity file
+  std::map<std::filesystem::path, ModuleUnit> module_units;
+  if (uses_modules) {
+    std::vector<std::filesystem::path> plain_sources;
+    sources.insert(sources.end(), module_sources.begin(), module_sources.end());
+    for (const auto& source : sources) {
+      ModuleUnit unit;
+      if (source.extension() != ".c") {
+        unit = scan_module_unit(read_file(source).value_or(std::string()));
+      }
+      if (unit.is_module_unit || !unit.imports.empty()) {
+        module_units.emplace(source, std::move(unit));
+      } else {
+        plain_sources.push_back(source);
+      }
+    }
+    sources = std::move(plain_sources);
+  }
+
+  // Test and bench programs link everything but main, so main stays out of the unity files once there are any
+  const std::vector<std::filesystem::path> test_sources = collect_program_sources(request.project_root / "tests");
+  const std::vector<std::filesystem::path> bench_sources = collect_program_sources(request.project_root / "benches");
+  std::vector<TranslationUnit> units;
+  if (request.unity_batch_size > 0) {
+    std::vector<std::filesystem::path> batched_sources;
+    for (const auto& source : sources) {
+      if ((!test_sources.empty() || !bench_sources.empty()) && is_main_source(source, src_dir)) {
+        units.push_back(TranslationUnit{ source, { source } });
+      } else {
+        batched_sources.push_back(source);
+      }
+    }
+    const std::vector<TranslationUnit> batches = make_unity_units(batched_sources, obj_dir / "unity", request.unity_batch_size);
+    units.insert(units.end(), batches.begin(), batches.end());
+  } else {
+    for (const auto& source : sources) {
+      units.push_back(TranslationUnit{ source, { source } });
+    }
+  }
+  for (const auto& [source, module_unit] : module_units) {
+    units.push_back(TranslationUnit{ source, { source } });
+  }
+
+  std::vector<CompileJob> jobs;
+  std::vector<std::string> labels;
+  std::vector<std::string> database;
+  std::vector<ModuleUnit> job_modules;
+  std::string module_map;
+  const std::string bmi_extension = clang ? ".pcm" : ".gcm";
+  for (const auto& unit : units) {
+    const std::filesystem::path& source = unit.source;
+    const auto module_unit = module_units.find(source);
+    CompileJob job;
+    job.source = source;
+    // Unity files are generated inside obj/ already
+    job.object = source.parent_path() == obj_dir / "unity" ? source : obj_dir / std::filesystem::relative(source, src_dir);
+    job.object += ".o";
+    job.depfile = job.object;
+    job.depfile.replace_extension(".d");
+    const bool is_c_source = source.extension() == ".c";
+    std::vector<std::string> source_flags;
+    if (module_unit != module_units.end()) {
+      for (const auto& import : module_unit->second.imports) {
+        job.imported_bmis.push_back(module_dir / (module_bmi_stem(import) + bmi_extension));
+      }
+      const std::string& provides = module_unit->second.provides;
+      if (!provides.empty()) {
+        job.bmi = module_dir / (module_bmi_stem(provides) + bmi_extension);
+        module_map += fmt::format("{} {}\n", provides, job.bmi.string());
+        if (clang) {
+          source_flags = { "-x", "c++-module", "-fmodule-output=" + job.bmi.string() };
+        } else {
+          source_flags = { "-x", "c++" };
+        }
+      }
+      job_modules.push_back(module_unit->second);
+    } else {
+      job_modules.emplace_back();
+    }
+    job.command = launcher;
+    job.command.push_back(is_c_source ? cc : cxx);
+    append(job.command, is_c_source ? c_flags : cxx_flags);
+    if (!is_c_source) {
+      append(job.command, pch_flags);
+    }
+    append(job.command, { "-MMD", "-MF", job.depfile.string(), "-c" });
+    append(job.command, source_flags);
+    append(job.command, { job.source.string(), "-o", job.object.string() });
+    for (const auto& member : unit.members) {
+      database.push_back(compilation_database_entry(request.project_root, job, member, launcher.size()));
+    }
+    jobs.push_back(std::move(job));
+
+    const std::string first_member = std::filesystem::relative(unit.members.front(), request.project_root).generic_string();
+    labels.push_back(unit.members.size() == 1 ? first_member
+      : fmt::format("{} and {} more (unity)", first_member, unit.members.size() - 1));
+  }
+
+  if (jobs.empty()) {
+    fmt::print("Error: no source files found in src\n");
+    return EXIT_FAILURE;
+  }
+
+  // Test and bench programs come after the project's jobs, compiled with src/ on the include path
+  // so that they can include the project's headers
+  const size_t project_job_count = jobs.size();
+  std::vector<std::filesystem::path> program_sources;
+  if (request.build_tests) {
+    program_sources = test_sources;
+  }
+  if (request.build_benches) {
+    program_sources.insert(program_sources.end(), bench_sources.begin(), bench_sources.end());
+  }
+  for (const auto& source : program_sources) {
+    CompileJob job;
+    job.source = source;
+    job.object = obj_dir / source.parent_path().filename() / source.filename();
+    job.object += ".o";
+    job.depfile = job.object;
+    job.depfile.replace_extension(".d");
+    ModuleUnit program_module;
+    if (uses_modules) {
+      program_module.imports = scan_module_unit(read_file(source).value_or(std::string())).imports;
+      for (const auto& import : program_module.imports) {
+        job.imported_bmis.push_back(module_dir / (module_bmi_stem(import) + bmi_extension));
+      }
+    }
+    job.command = launcher;
+    job.command.push_back(cxx);
+    append(job.command, cxx_flags);
+    append(job.command, pch_flags);
+    append(job.command, { "-I" + src_dir.string(), "-MMD", "-MF", job.depfile.string(), "-c", job.source.string(), "-o", job.object.string() });
+    database.push_back(compilation_database_entry(request.project_root, job, job.source, launcher.size()));
+    jobs.push_back(std::move(job));
+    labels.push_back(std::filesystem::relative(source, request.project_root).generic_string());
+    job_modules.push_back(std::move(program_module));
+  }
+
+  // Written before compiling, so that editors understand the sources even while the build is broken
+  std::string database_content = "[\n";
+  for (size_t i = 0; i < database.size(); ++i) {
+    database_content += database[i] + (i + 1 < database.size() ? ",\n" : "\n");
+  }
+  write_file_if_changed(request.target_dir / "compile_commands.json", database_content + "]\n");
+
+  std::vector<std::vector<size_t>> layers;
+  if (uses_modules) {
+    std::filesystem::create_directories(module_dir);
+    write_file_if_changed(module_dir / "modules.map", module_map);
+    try {
+      layers = schedule_module_layers(job_modules);
+    } catch (const std::exception& error) {
+      fmt::print("Error: {}\n", error.what());
+      return EXIT_FAILURE;
+    }
+  } else {
+    layers.emplace_back(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+      layers.front()[i] = i;
+    }
+  }
+
+  // Staleness is checked layer by layer, so importers see the BMIs the previous layer just rebuilt
+  std::vector<bool> compiled(jobs.size(), false);
+  for (const auto& layer : layers) {
+    std::vector<std::vector<std::string>> compile_commands;
+    std::vector<std::string> compile_labels;
+    for (const size_t i : layer) {
+      const CompileJob& job = jobs[i];
+      if ((pch_rebuilt && job.source.extension() != ".c") || is_object_stale(job)) {
+        std::filesystem::create_directories(job.object.parent_path());
+        compile_labels.push_back(labels[i]);
+        fmt::print("Compiling {}\n", compile_labels.back());
+        compile_commands.push_back(job.command);
+        compiled[i] = true;
+      }
+    }
+
+    if (!run_parallel(compile_commands, compile_labels, request.jobs, request.timings)) {
+      fmt::print("Error: Build failed\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<std::string> linker_flags;
+  if (!request.linker.name.empty() && (request.linker.required || compiler_supports_linker(cxx, request.linker.name, obj_dir))) {
+    linker_flags.push_back("-fuse-ld=" + request.linker.name);
+  }
+  append(linker_flags, profile.link);
+  // Dependencies' libraries follow the objects, and shared ones are found again at run time
+  for (const auto& library : request.link_libraries) {
+    linker_flags.push_back(library.string());
+    if (library.extension() == ".so" || library.extension() == ".dylib") {
+      linker_flags.push_back("-Wl,-rpath," + library.parent_path().string());
+    }
+  }
+
+  // Link the objects of the given jobs unless none of them was recompiled and the link command is
+  // the one of the last link. The command lists every object, so adding or removing a source changes it as well.
+  const auto link = [&](const std::vector<size_t>& job_indices, const std::filesystem::path& executable_path,
+                        const std::filesystem::path& link_fingerprint_path) {
+    std::vector<std::string> link_command = { cxx };
+    for (const size_t i : job_indices) {
+      link_command.push_back(jobs[i].object.string());
+    }
+    append(link_command, linker_flags);
+    append(link_command, { "-o", executable_path.string() });
+
+    const std::string link_fingerprint = fmt::format("{:016x}", fnv1a_hash(format_command(link_command)));
+    const bool compiled_any = std::any_of(job_indices.begin(), job_indices.end(), [&](size_t i) { return compiled[i]; });
+    if (!compiled_any && std::filesystem::exists(executable_path)
+        && read_file(link_fingerprint_path) == link_fingerprint) {
+      return true;
+    }
+
+    // Forget the old link first so that a failed link is retried next time
+    std::filesystem::remove(link_fingerprint_path);
+    fmt::print("Linking {}\n", executable_path.filename().string());
+    const auto link_start = BuildTimings::Clock::now();
+    const ProcessResult link_result = run_process(link_command);
+    if (!link_result.success()) {
+      fmt::print("Error: Linking failed{}\n", link_result.error.empty() ? "" : ": " + link_result.error);
+      return false;
+    }
+    if (request.timings != nullptr) {
+      request.timings->record(executable_path.filename().string(), "link", link_start, BuildTimings::Clock::now(), 1);
+    }
+    update_fingerprint(link_fingerprint_path, link_fingerprint);
+    return true;
+  };
+
+  std::vector<size_t> project_jobs;
+  std::vector<size_t> library_jobs;
+  for (size_t i = 0; i < project_job_count; ++i) {
+    project_jobs.push_back(i);
+    if (!is_main_source(jobs[i].source, src_dir)) {
+      library_jobs.push_back(i);
+    }
+  }
+  if (!link(project_jobs, get_executable_path(request.target_dir, request.project_name), obj_dir / "link.fingerprint")) {
+    return EXIT_FAILURE;
+  }
+
+  // Each program goes to the directory named like the one its source is in, target/<mode>/tests or benches
+  for (size_t i = project_job_count; i < jobs.size(); ++i) {
+    const std::filesystem::path kind = jobs[i].source.parent_path().filename();
+    const std::filesystem::path programs_dir = request.target_dir / kind;
+    std::filesystem::create_directories(programs_dir);
+    std::vector<size_t> program_jobs = library_jobs;
+    program_jobs.push_back(i);
+    const std::string program_name = jobs[i].source.stem().string();
+    if (!link(program_jobs, get_executable_path(programs_dir, program_name), obj_dir / kind / (program_name + ".link.fingerprint"))) {
+      return EXIT_FAILURE;
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+#ifndef SAIL_NATIVE_BUILD_HPP
+#define SAIL_NATIVE_BUILD_HPP
+
+#include "linker.hpp"
+#include "profiles.hpp"
+#include "timings.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Everything the native engine needs to build a single-executable project
+struct NativeBuildRequest
+{
+  std::filesystem::path project_root;
+  std::filesystem::path target_dir;
+  std::string project_name;
+  bool release_mode = false;
+  // [build] std, passed as -std=c++<N>; modules need 20 or later
+  unsigned cxx_standard = 17;
+  unsigned jobs = 1;
+  std::string compiler_launcher;
+  // Header search paths of the project's dependencies, and their libraries in link order
+  std::vector<std::filesystem::path> include_dirs;
+  std::vector<std::filesystem::path> link_libraries;
+  // Sources per generated unity translation unit; 0 compiles every source on its own
+  unsigned unity_batch_size = 0;
+  // [build] pch entries, precompiled once and force-included into every C++ source
+  std::vector<std::string> precompiled_headers;
+  // Receives a span per compile and link job when --timings is given
+  BuildTimings* timings = nullptr;
+  // [profile.dev] or [profile.release] and the --pgo step
+  ProfileSection profile;
+  PgoMode pgo = PgoMode::None;
+  std::filesystem::path pgo_dir;
+  LinkerChoice linker;
+  // Also build every tests/*.cpp into target/<mode>/tests/<name>, or benches/*.cpp into
+  // target/<mode>/benches/<name>, linked with the project's objects except those of src/main.cpp
+  bool build_tests = false;
+  bool build_benches = false;
+};
+
+// Build src/**/*.cpp into target/<mode>/<name> without going through CMake.
+// Objects and -MMD depfiles live under target/<mode>/obj, and only stale
+// translation units are recompiled. Module interface units (src/**/*.cppm, .ixx)
+// are compiled before their importers, as parallel as the import graph allows.
+// With build_tests or build_benches, those programs are compiled in the same layers and linked afterwards.
+// The compile commands are also written to target/<mode>/compile_commands.json for editors.
+// Returns EXIT_SUCCESS or EXIT_FAILURE.
+[[nodiscard]] int native_build(const NativeBuildRequest& request);
+
+#endif
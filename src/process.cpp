@@ -0,0 +1,520 @@
+#include "process.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+#include <filesystem>
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+
+extern char** environ;  // NOLINT(readability-redundant-declaration)
+#endif
+
+namespace {
+
+// A pipe is inheritable between its creation and the spawn of the child it is meant for, so pipes
+// and spawns are serialized; otherwise a child started at the same moment would hold the write
+// end open and the reader would never see the end of its output
+std::mutex spawn_mutex;
+
+using Clock = std::chrono::steady_clock;
+
+#ifdef _WIN32
+
+// Quote one argument the way CommandLineToArgvW and the MSVC runtime split it again
+std::wstring quote_windows_argument(const std::wstring& argument) {
+  if (!argument.empty() && argument.find_first_of(L" \t\n\v\"") == std::wstring::npos) {
+    return argument;
+  }
+  std::wstring quoted = L"\"";
+  size_t backslashes = 0;
+  for (const wchar_t character : argument) {
+    if (character == L'\\') {
+      ++backslashes;
+      continue;
+    }
+    // Backslashes only escape anything when a quote follows them
+    quoted.append(character == L'"' ? backslashes * 2 + 1 : backslashes, L'\\');
+    backslashes = 0;
+    quoted.push_back(character);
+  }
+  quoted.append(backslashes * 2, L'\\');
+  quoted.push_back(L'"');
+  return quoted;
+}
+
+std::wstring windows_command_line(const std::vector<std::string>& argv) {
+  std::wstring command_line;
+  for (const auto& argument : argv) {
+    command_line += (command_line.empty() ? L"" : L" ") + quote_windows_argument(std::filesystem::path(argument).wstring());
+  }
+  return command_line;
+}
+
+ProcessResult spawn_and_wait(const std::vector<std::string>& argv, const ProcessOptions& options) {
+  ProcessResult result;
+  std::wstring command_line = windows_command_line(argv);
+
+  const bool capture = options.output != ProcessOutput::Inherit;
+  HANDLE read_pipe = nullptr;
+  STARTUPINFOW startup{};
+  startup.cb = sizeof(startup);
+  PROCESS_INFORMATION process{};
+  BOOL created = FALSE;
+  {
+    const std::lock_guard lock(spawn_mutex);
+    HANDLE write_pipe = nullptr;
+    if (capture) {
+      SECURITY_ATTRIBUTES attributes{ sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+      if (CreatePipe(&read_pipe, &write_pipe, &attributes, 0) == FALSE) {
+        result.error = fmt::format("could not create a pipe for {}: error {}", argv.front(), GetLastError());
+        return result;
+      }
+      SetHandleInformation(read_pipe, HANDLE_FLAG_INHERIT, 0);
+      startup.dwFlags = STARTF_USESTDHANDLES;
+      startup.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+      startup.hStdOutput = write_pipe;
+      startup.hStdError = options.output == ProcessOutput::Capture ? write_pipe : GetStdHandle(STD_ERROR_HANDLE);
+    }
+    created = CreateProcessW(nullptr, command_line.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup, &process);
+    if (created == FALSE) {
+      result.error = fmt::format("could not run {}: error {}", argv.front(), GetLastError());
+    }
+    if (write_pipe != nullptr) {
+      CloseHandle(write_pipe);
+    }
+  }
+  if (created == FALSE) {
+    if (read_pipe != nullptr) {
+      CloseHandle(read_pipe);
+    }
+    return result;
+  }
+
+  std::thread reader;
+  if (capture) {
+    reader = std::thread([&]() {
+      std::array<char, 4096> buffer{};
+      DWORD count = 0;
+      while (ReadFile(read_pipe, buffer.data(), static_cast<DWORD>(buffer.size()), &count, nullptr) != FALSE && count > 0) {
+        result.output.append(buffer.data(), count);
+      }
+    });
+  }
+
+  const DWORD wait_time = options.timeout.count() > 0 ? static_cast<DWORD>(options.timeout.count()) : INFINITE;
+  if (WaitForSingleObject(process.hProcess, wait_time) == WAIT_TIMEOUT) {
+    TerminateProcess(process.hProcess, EXIT_FAILURE);
+    WaitForSingleObject(process.hProcess, INFINITE);
+    result.timed_out = true;
+  }
+  DWORD exit_code = EXIT_FAILURE;
+  GetExitCodeProcess(process.hProcess, &exit_code);
+  result.exit_code = static_cast<int>(exit_code);
+  if (reader.joinable()) {
+    // Whatever the killed child started may still hold the pipe open
+    if (result.timed_out) {
+      CancelSynchronousIo(reader.native_handle());
+    }
+    reader.join();
+    CloseHandle(read_pipe);
+  }
+  CloseHandle(process.hThread);
+  CloseHandle(process.hProcess);
+  return result;
+}
+
+#else
+
+// The null-terminated argument array posix_spawnp and execvp take
+std::vector<char*> c_arguments(const std::vector<std::string>& argv) {
+  std::vector<char*> arguments;
+  arguments.reserve(argv.size() + 1);
+  for (const auto& argument : argv) {
+    arguments.push_back(const_cast<char*>(argument.c_str()));  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+  }
+  arguments.push_back(nullptr);
+  return arguments;
+}
+
+int wait_status_to_exit_code(int status) noexcept {
+  if (WIFEXITED(status)) {
+    return WEXITSTATUS(status);
+  }
+  if (WIFSIGNALED(status)) {
+    return 128 + WTERMSIG(status);
+  }
+  return EXIT_FAILURE;
+}
+
+// Milliseconds left until the deadline for poll(); -1 without a timeout
+int remaining_milliseconds(const std::optional<Clock::time_point>& deadline) {
+  if (!deadline) {
+    return -1;
+  }
+  const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*deadline - Clock::now()).count();
+  return static_cast<int>(std::clamp<std::chrono::milliseconds::rep>(remaining, 0, 1000));
+}
+
+// Read the child's output until every writer closed the pipe or the deadline passes; returns
+// false on timeout
+bool read_until_closed(int read_fd, const std::optional<Clock::time_point>& deadline, std::string& output) {
+  std::array<char, 4096> buffer{};
+  while (true) {
+    if (deadline && Clock::now() >= *deadline) {
+      return false;
+    }
+    pollfd descriptor{ read_fd, POLLIN, 0 };
+    const int ready = poll(&descriptor, 1, remaining_milliseconds(deadline));
+    if (ready < 0 && errno != EINTR) {
+      return true;
+    }
+    if (ready <= 0) {
+      continue;
+    }
+    const ssize_t count = read(read_fd, buffer.data(), buffer.size());
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return true;
+    }
+    output.append(buffer.data(), static_cast<size_t>(count));
+  }
+}
+
+// Wait for the child to exit; returns false if the deadline passes first
+bool wait_for_exit(pid_t pid, const std::optional<Clock::time_point>& deadline, int& status) {
+  while (true) {
+    const pid_t waited = waitpid(pid, &status, deadline ? WNOHANG : 0);
+    if (waited == pid) {
+      return true;
+    }
+    if (waited < 0 && errno != EINTR) {
+      status = 0;
+      return true;
+    }
+    if (deadline) {
+      if (Clock::now() >= *deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  }
+}
+
+ProcessResult spawn_and_wait(const std::vector<std::string>& argv, const ProcessOptions& options) {
+  ProcessResult result;
+  std::vector<char*> arguments = c_arguments(argv);
+
+  const bool capture = options.output != ProcessOutput::Inherit;
+  const bool has_timeout = options.timeout.count() > 0;
+  std::array<int, 2> pipe_fds{ -1, -1 };
+  pid_t pid = -1;
+  int spawn_error = 0;
+  {
+    const std::lock_guard lock(spawn_mutex);
+    if (capture) {
+      if (pipe(pipe_fds.data()) != 0) {
+        result.error = fmt::format("could not create a pipe for {}: {}", argv.front(), std::strerror(errno));
+        return result;
+      }
+      fcntl(pipe_fds[0], F_SETFD, FD_CLOEXEC);
+      fcntl(pipe_fds[1], F_SETFD, FD_CLOEXEC);
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (capture) {
+      // dup2 clears close-on-exec on the copy, so only the child's stdout and stderr survive the exec
+      posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], STDOUT_FILENO);
+      if (options.output == ProcessOutput::Capture) {
+        posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], STDERR_FILENO);
+      }
+    }
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    if (has_timeout) {
+      posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+      posix_spawnattr_setpgroup(&attributes, 0);
+    }
+    spawn_error = posix_spawnp(&pid, arguments.front(), &actions, &attributes, arguments.data(), environ);
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+    if (capture) {
+      close(pipe_fds[1]);
+    }
+  }
+  if (spawn_error != 0) {
+    if (capture) {
+      close(pipe_fds[0]);
+    }
+    result.error = fmt::format("could not run {}: {}", argv.front(), std::strerror(spawn_error));
+    return result;
+  }
+
+  const std::optional<Clock::time_point> deadline = has_timeout
+    ? std::optional<Clock::time_point>(Clock::now() + options.timeout) : std::nullopt;
+  bool finished = true;
+  if (capture) {
+    finished = read_until_closed(pipe_fds[0], deadline, result.output);
+    close(pipe_fds[0]);
+  }
+  int status = 0;
+  finished = finished && wait_for_exit(pid, deadline, status);
+  if (!finished) {
+    kill(-pid, SIGKILL);
+    wait_for_exit(pid, std::nullopt, status);
+    result.timed_out = true;
+  }
+  result.exit_code = wait_status_to_exit_code(status);
+  return result;
+}
+
+#endif
+
+// Arguments a shell would split or expand
+bool needs_quoting(std::string_view argument) {
+  return argument.empty() || argument.find_first_of(" \t\n\"'\\$`;&|<>()*?#~") != std::string_view::npos;
+}
+
+}// namespace
+
+ProcessResult run_process(const std::vector<std::string>& argv, const ProcessOptions& options) {
+  if (argv.empty()) {
+    ProcessResult result;
+    result.error = "no command to run";
+    return result;
+  }
+  // Anything sail printed so far has to come out before the child's own output
+  if (options.output != ProcessOutput::Capture) {
+    std::fflush(stdout);
+  }
+  const auto start = Clock::now();
+  ProcessResult result = spawn_and_wait(argv, options);
+  result.elapsed = Clock::now() - start;
+  return result;
+}
+
+ProcessResult exec_process(const std::vector<std::string>& argv) {
+#ifdef _WIN32
+  // The console sends Ctrl+C to every process attached to it; sail leaves it to the program
+  SetConsoleCtrlHandler(nullptr, TRUE);
+  ProcessResult result = run_process(argv);
+  SetConsoleCtrlHandler(nullptr, FALSE);
+  return result;
+#else
+  ProcessResult result;
+  if (argv.empty()) {
+    result.error = "no command to run";
+    return result;
+  }
+  std::vector<char*> arguments = c_arguments(argv);
+  // Buffered output would be lost with the process image
+  std::fflush(stdout);
+  std::fflush(stderr);
+  execvp(arguments.front(), arguments.data());
+  result.error = fmt::format("could not run {}: {}", argv.front(), std::strerror(errno));
+  return result;
+#endif
+}
+
+#ifdef _WIN32
+
+ChildProcess::ChildProcess(const std::vector<std::string>& argv) {
+  std::wstring command_line = windows_command_line(argv);
+  STARTUPINFOW startup{};
+  startup.cb = sizeof(startup);
+  PROCESS_INFORMATION info{};
+  std::fflush(stdout);
+  const std::lock_guard lock(spawn_mutex);
+  if (CreateProcessW(nullptr, command_line.data(), nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup, &info) == FALSE) {
+    start_error = fmt::format("could not run {}: error {}", argv.front(), GetLastError());
+    return;
+  }
+  CloseHandle(info.hThread);
+  process = info.hProcess;
+}
+
+ChildProcess::~ChildProcess() {
+  stop(std::chrono::milliseconds(0));
+}
+
+std::optional<int> ChildProcess::poll() {
+  if (process != nullptr && !exit_code && WaitForSingleObject(process, 0) == WAIT_OBJECT_0) {
+    DWORD code = EXIT_FAILURE;
+    GetExitCodeProcess(process, &code);
+    exit_code = static_cast<int>(code);
+  }
+  return exit_code;
+}
+
+// Console programs have no polite way to be asked to stop from outside, so there is no grace period
+void ChildProcess::stop(std::chrono::milliseconds /*grace_period*/) {
+  if (process == nullptr) {
+    return;
+  }
+  if (!poll()) {
+    TerminateProcess(process, EXIT_FAILURE);
+    WaitForSingleObject(process, INFINITE);
+    poll();
+  }
+  CloseHandle(process);
+  process = nullptr;
+}
+
+#else
+
+ChildProcess::ChildProcess(const std::vector<std::string>& argv) {
+  std::vector<char*> arguments = c_arguments(argv);
+  std::fflush(stdout);
+  pid_t child = -1;
+  int spawn_error = 0;
+  {
+    const std::lock_guard lock(spawn_mutex);
+    spawn_error = posix_spawnp(&child, arguments.front(), nullptr, nullptr, arguments.data(), environ);
+  }
+  if (spawn_error != 0) {
+    start_error = fmt::format("could not run {}: {}", argv.front(), std::strerror(spawn_error));
+    return;
+  }
+  pid = child;
+}
+
+ChildProcess::~ChildProcess() {
+  stop();
+}
+
+std::optional<int> ChildProcess::poll() {
+  if (pid > 0 && !exit_code) {
+    int status = 0;
+    if (waitpid(pid, &status, WNOHANG) == pid) {
+      exit_code = wait_status_to_exit_code(status);
+      pid = -1;
+    }
+  }
+  return exit_code;
+}
+
+void ChildProcess::stop(std::chrono::milliseconds grace_period) {
+  if (pid <= 0 || poll()) {
+    return;
+  }
+  kill(pid, SIGTERM);
+  int status = 0;
+  if (!wait_for_exit(pid, Clock::now() + grace_period, status)) {
+    kill(pid, SIGKILL);
+    wait_for_exit(pid, std::nullopt, status);
+  }
+  exit_code = wait_status_to_exit_code(status);
+  pid = -1;
+}
+
+#endif
+
+bool run_processes(const std::vector<std::vector<std::string>>& commands, unsigned jobs, const ProcessOptions& options,
+                   const ProcessFinished& on_finished, bool keep_going) {
+  std::atomic<size_t> next_command{ 0 };
+  std::atomic<bool> failed{ false };
+  std::mutex finished_mutex;
+  const auto worker = [&](unsigned lane) {
+    while (keep_going || !failed) {
+      const size_t index = next_command++;
+      if (index >= commands.size()) {
+        return;
+      }
+      const ProcessResult result = run_process(commands[index], options);
+      if (!result.success()) {
+        failed = true;
+      }
+      if (on_finished) {
+        const std::lock_guard lock(finished_mutex);
+        on_finished(index, lane, result);
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  const size_t worker_count = std::min<size_t>(std::max(1U, jobs), commands.size());
+  workers.reserve(worker_count);
+  for (size_t i = 0; i < worker_count; ++i) {
+    workers.emplace_back(worker, static_cast<unsigned>(i) + 1);
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  return !failed;
+}
+
+std::optional<std::string> run_capture(const std::vector<std::string>& argv, std::chrono::milliseconds timeout) {
+  ProcessResult result = run_process(argv, ProcessOptions{ ProcessOutput::CaptureStdout, timeout });
+  if (!result.success()) {
+    return std::nullopt;
+  }
+  return std::move(result.output);
+}
+
+std::string format_command(const std::vector<std::string>& argv) {
+  std::string command;
+  for (const auto& argument : argv) {
+    if (!command.empty()) {
+      command += ' ';
+    }
+    if (!needs_quoting(argument)) {
+      command += argument;
+      continue;
+    }
+    command += '"';
+    for (const char character : argument) {
+      if (character == '"' || character == '\\' || character == '$' || character == '`') {
+        command += '\\';
+      }
+      command += character;
+    }
+    command += '"';
+  }
+  return command;
+}
+
+std::filesystem::path current_executable() {
+  std::error_code error;
+#ifdef _WIN32
+  std::wstring path(MAX_PATH, L'\0');
+  const DWORD length = GetModuleFileNameW(nullptr, path.data(), static_cast<DWORD>(path.size()));
+  if (length == 0 || length == path.size()) {
+    return {};
+  }
+  path.resize(length);
+  return std::filesystem::path(path);
+#elif defined(__APPLE__)
+  std::uint32_t size = 0;
+  _NSGetExecutablePath(nullptr, &size);
+  std::string path(size, '\0');
+  if (_NSGetExecutablePath(path.data(), &size) != 0) {
+    return {};
+  }
+  return std::filesystem::weakly_canonical(std::filesystem::path(path.c_str()), error);
+#else
+  return std::filesystem::read_symlink("/proc/self/exe", error);
+#endif
+}
@@ -0,0 +1,106 @@
+#ifndef SAIL_PROCESS_HPP
+#define SAIL_PROCESS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Where a child's standard output and error go
+enum class ProcessOutput : std::uint8_t {
+  // Straight to sail's own stdout and stderr
+  Inherit,
+  // Both into ProcessResult::output through one pipe, interleaved as the child wrote them
+  Capture,
+  // Standard output into ProcessResult::output; standard error still goes to sail's stderr
+  CaptureStdout,
+};
+
+struct ProcessOptions
+{
+  ProcessOutput output = ProcessOutput::Inherit;
+  // Kill the child once it has run this long; zero waits for as long as it takes
+  std::chrono::milliseconds timeout{ 0 };
+};
+
+struct ProcessResult
+{
+  // The child's exit code; 128 + the signal number if it was killed, as shells report it, and
+  // 127 if it could not be started at all
+  int exit_code = 127;
+  bool timed_out = false;
+  // Captured output, empty with ProcessOutput::Inherit
+  std::string output;
+  // Why the child could not be started or waited for; empty if it ran
+  std::string error;
+  std::chrono::steady_clock::duration elapsed{};
+
+  [[nodiscard]] bool success() const noexcept { return exit_code == 0 && error.empty(); }
+};
+
+// Run argv[0], looked up on PATH, with the remaining arguments passed as they are; nothing goes
+// through a shell, so arguments need no quoting. Uses posix_spawn on Unix and CreateProcess on
+// Windows. Safe to call from several threads at once: pipes never leak into other children.
+// A child with a timeout runs in its own process group on Unix, so whatever it started is
+// killed along with it.
+[[nodiscard]] ProcessResult run_process(const std::vector<std::string>& argv, const ProcessOptions& options = {});
+
+// Replace sail with the program, so that signals, stdio and the exit code are the program's own.
+// Only returns if the program could not be started, with ProcessResult::error saying why. Windows
+// has no exec; there the program runs as a child that alone receives Ctrl+C, and its result is returned.
+[[nodiscard]] ProcessResult exec_process(const std::vector<std::string>& argv);
+
+// A program started in the background with inherited stdio, for `sail watch` to restart at will.
+// The destructor stops it if it still runs.
+class ChildProcess
+{
+public:
+  explicit ChildProcess(const std::vector<std::string>& argv);
+  ~ChildProcess();
+  ChildProcess(const ChildProcess&) = delete;
+  ChildProcess& operator=(const ChildProcess&) = delete;
+  ChildProcess(ChildProcess&&) = delete;
+  ChildProcess& operator=(ChildProcess&&) = delete;
+
+  // Why the program could not be started; empty if it was
+  [[nodiscard]] const std::string& error() const noexcept { return start_error; }
+  // The exit code once the program has exited, reported like ProcessResult::exit_code;
+  // std::nullopt while it still runs
+  [[nodiscard]] std::optional<int> poll();
+  // Ask the program to terminate, kill it if it has not after `grace_period`, and wait for it
+  void stop(std::chrono::milliseconds grace_period = std::chrono::milliseconds(1000));
+
+private:
+  std::string start_error;
+  std::optional<int> exit_code;
+#ifdef _WIN32
+  void* process = nullptr;
+#else
+  int pid = -1;
+#endif
+};
+
+// Called as each command of run_processes finishes, never from two threads at once. lane is the
+// 1-based worker that ran it, so concurrent commands have different lanes.
+using ProcessFinished = std::function<void(std::size_t index, unsigned lane, const ProcessResult& result)>;
+
+// Run the commands on up to `jobs` workers; returns false if any of them failed. After the first
+// failure no further commands are started, unless `keep_going` is set.
+bool run_processes(const std::vector<std::vector<std::string>>& commands, unsigned jobs, const ProcessOptions& options,
+                   const ProcessFinished& on_finished = {}, bool keep_going = false);
+
+// Run a command and capture its standard output; std::nullopt if it cannot run or exits non-zero
+[[nodiscard]] std::optional<std::string> run_capture(const std::vector<std::string>& argv,
+                                                     std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+// The path of the running executable, for starting sail again; empty if the system does not tell
+[[nodiscard]] std::filesystem::path current_executable();
+
+// The command spelled as a shell would need it, for messages and fingerprints
+[[nodiscard]] std::string format_command(const std::vector<std::string>& argv);
+
+#endif
@@ -0,0 +1,268 @@
+#include "process.hpp"
+#include "profiles.hpp"
+#include "util.hpp"
+
+#include <fmt/format.h>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// The flag spellings shared by GCC and Clang; LTO differs and is handled by the callers
+std::vector<std::string> common_flags(const ProfileSection& profile, PgoMode pgo, const std::filesystem::path& pgo_dir) {
+  std::vector<std::string> flags;
+  if (profile.opt_level) {
+    flags.push_back("-O" + *profile.opt_level);
+  }
+  if (profile.target_cpu) {
+    flags.push_back("-march=" + *profile.target_cpu);
+  }
+  if (pgo == PgoMode::Generate) {
+    flags.push_back("-fprofile-generate=" + pgo_dir.generic_string());
+  } else if (pgo == PgoMode::Use) {
+    flags.push_back("-fprofile-use=" + pgo_dir.generic_string());
+  }
+  return flags;
+}
+
+// GCC has no ThinLTO; its partitioned -flto=auto mode is the closest match for both settings
+std::string lto_flag(const std::string& lto, bool clang) {
+  if (!clang) {
+    return "-flto=auto";
+  }
+  return lto == "thin" ? "-flto=thin" : "-flto";
+}
+
+bool uses_lto(const ProfileSection& profile) {
+  return profile.lto && *profile.lto != "off";
+}
+
+bool uses_hardening(const ProfileSection& profile) {
+  return profile.hardening.value_or(false);
+}
+
+// -fsanitize=address,undefined; empty without sanitizers
+std::string sanitize_flag(const ProfileSection& profile) {
+  if (!profile.sanitizers || profile.sanitizers->empty()) {
+    return {};
+  }
+  std::string list;
+  for (const auto& sanitizer : *profile.sanitizers) {
+    list += (list.empty() ? "" : ",") + sanitizer;
+  }
+  return "-fsanitize=" + list;
+}
+
+// Settings `over` has take the place of those in `base`
+ProfileSection overlay(ProfileSection base, const ProfileSection& over) {
+  for (const auto member : { &ProfileSection::inherits, &ProfileSection::lto, &ProfileSection::opt_level, &ProfileSection::target_cpu }) {
+    if (over.*member) {
+      base.*member = over.*member;
+    }
+  }
+  if (over.sanitizers) {
+    base.sanitizers = over.sanitizers;
+  }
+  if (over.hardening) {
+    base.hardening = over.hardening;
+  }
+  return base;
+}
+
+// The profiles every project has without declaring them
+std::optional<ProfileSection> builtin_profile(std::string_view name) {
+  ProfileSection profile;
+  if (name == "asan") {
+    profile.sanitizers = std::vector<std::string>{ "address", "undefined" };
+  } else if (name == "ubsan") {
+    profile.sanitizers = std::vector<std::string>{ "undefined" };
+  } else if (name == "tsan") {
+    profile.sanitizers = std::vector<std::string>{ "thread" };
+  } else if (name == "msan") {
+    profile.sanitizers = std::vector<std::string>{ "memory" };
+  } else if (name == "hardened") {
+    profile.inherits = "release";
+    profile.hardening = true;
+  } else {
+    return std::nullopt;
+  }
+  return profile;
+}
+
+}// namespace
+
+BuildProfile resolve_build_profile(const Manifest& manifest, const std::string& name) {
+  if (name == "dev" || name == "release") {
+    const bool release = name == "release";
+    return BuildProfile{ name, release, release ? "release" : "debug", release ? manifest.release_profile : manifest.dev_profile };
+  }
+  const auto declared = manifest.custom_profiles.find(name);
+  std::optional<ProfileSection> custom = builtin_profile(name);
+  if (declared != manifest.custom_profiles.end()) {
+    custom = overlay(custom.value_or(ProfileSection{}), declared->second);
+  }
+  if (!custom) {
+    throw std::runtime_error(fmt::format("Unknown profile '{}'; declare it as [profile.{}] in Sail.toml, or use dev, release, "
+                                         "asan, ubsan, tsan, msan or hardened", name, name));
+  }
+  const bool release = custom->inherits.value_or("dev") == "release";
+  return BuildProfile{ name, release, name, overlay(release ? manifest.release_profile : manifest.dev_profile, *custom) };
+}
+
+std::filesystem::path pgo_data_dir(const std::filesystem::path& target_dir) {
+  return target_dir / "pgo";
+}
+
+ProfileFlags profile_flags(const ProfileSection& profile, PgoMode pgo, const std::filesystem::path& pgo_dir, bool clang,
+                          bool release) {
+  ProfileFlags flags;
+  flags.compile = common_flags(profile, pgo, pgo_dir);
+  // Functions the training run never reached have no profile; that is expected
+  if (pgo == PgoMode::Use && !clang) {
+    flags.compile.emplace_back("-Wno-missing-profile");
+  }
+  if (uses_lto(profile)) {
+    flags.compile.push_back(lto_flag(*profile.lto, clang));
+  }
+  if (const std::string sanitize = sanitize_flag(profile); !sanitize.empty()) {
+    flags.compile.push_back(sanitize);
+  }
+  // LTO optimizes again at link time, and instrumented binaries need the profiling or sanitizer runtime
+  flags.link = flags.compile;
+  if (uses_hardening(profile)) {
+    flags.compile.emplace_back("-D_GLIBCXX_ASSERTIONS");
+    if (release) {
+      flags.compile.insert(flags.compile.end(), { "-U_FORTIFY_SOURCE", "-D_FORTIFY_SOURCE=3" });
+    }
+    flags.compile.emplace_back("-fstack-protector-strong");
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    flags.compile.emplace_back("-fcf-protection");
+#endif
+#ifdef __linux__
+    flags.compile.emplace_back("-fstack-clash-protection");
+#else
+    if (!clang) {
+      flags.compile.emplace_back("-fstack-clash-protection");
+    }
+#endif
+  }
+  return flags;
+}
+
+std::string profile_cmake_code(const ProfileSection& profile, PgoMode pgo, const std::filesystem::path& pgo_dir) {
+  const std::vector<std::string> flags = common_flags(profile, pgo, pgo_dir);
+  const std::string sanitize = sanitize_flag(profile);
+  if (flags.empty() && !uses_lto(profile) && sanitize.empty() && !uses_hardening(profile)) {
+    return {};
+  }
+
+  // MSVC has the address sanitizer and its own hardening flags, as in cmake/Sanitizers.cmake and cmake/Hardening.cmake
+  std::string content = "# [profile] and the --pgo options\nif(MSVC)\n";
+  const bool msvc_address = sanitize == "-fsanitize=address";
+  if (msvc_address) {
+    content += "  add_compile_options(/fsanitize=address /Zi /INCREMENTAL:NO)\n  add_link_options(/INCREMENTAL:NO)\n";
+  }
+  if (uses_hardening(profile)) {
+    content += "  add_compile_options(/sdl /DYNAMICBASE /guard:cf)\n  add_link_options(/NXCOMPAT /CETCOMPAT)\n";
+  }
+  if (!flags.empty() || uses_lto(profile) || (!sanitize.empty() && !msvc_address)) {
+    content += "  message(WARNING \"sail: [profile] settings other than hardening and the address sanitizer are only applied with GCC and Clang\")\n";
+  }
+  content += "else()\n";
+  std::string options;
+  for (const auto& flag : flags) {
+    options += " " + cmake_quote(flag);
+  }
+  if (!options.empty()) {
+    content += fmt::format("add_compile_options({})\nadd_link_options({})\n", options.substr(1), options.substr(1));
+  }
+  if (pgo == PgoMode::Use) {
+    content += "if(CMAKE_CXX_COMPILER_ID STREQUAL \"GNU\")\n  add_compile_options(-Wno-missing-profile)\nendif()\n";
+  }
+  if (uses_lto(profile)) {
+    content += fmt::format("if(CMAKE_CXX_COMPILER_ID MATCHES \"Clang\")\n"
+                           "  add_compile_options({0})\n  add_link_options({0})\n"
+                           "else()\n"
+                           "  add_compile_options({1})\n  add_link_options({1})\n"
+                           "endif()\n"
+                           "# Static libraries of LTO objects need the compiler's archiver wrapper\n"
+                           "if(CMAKE_CXX_COMPILER_AR AND CMAKE_CXX_COMPILER_RANLIB)\n"
+                           "  set(CMAKE_AR \"${{CMAKE_CXX_COMPILER_AR}}\")\n"
+                           "  set(CMAKE_RANLIB \"${{CMAKE_CXX_COMPILER_RANLIB}}\")\n"
+                           "endif()\n",
+      lto_flag(*profile.lto, true), lto_flag(*profile.lto, false));
+  }
+  if (!sanitize.empty()) {
+    content += fmt::format("add_compile_options({0})\nadd_link_options({0})\n", sanitize);
+  }
+  if (uses_hardening(profile)) {
+    content += "add_compile_definitions(_GLIBCXX_ASSERTIONS)\n"
+               "if(NOT CMAKE_BUILD_TYPE STREQUAL \"Debug\")\n"
+               "  add_compile_options(-U_FORTIFY_SOURCE -D_FORTIFY_SOURCE=3)\n"
+               "endif()\n"
+               "include(CheckCXXCompilerFlag)\n"
+               "check_cxx_compiler_flag(-fstack-protector-strong SAIL_STACK_PROTECTOR)\n"
+               "check_cxx_compiler_flag(-fcf-protection SAIL_CF_PROTECTION)\n"
+               "check_cxx_compiler_flag(-fstack-clash-protection SAIL_CLASH_PROTECTION)\n"
+               "if(SAIL_STACK_PROTECTOR)\n  add_compile_options(-fstack-protector-strong)\nendif()\n"
+               "if(SAIL_CF_PROTECTION)\n  add_compile_options(-fcf-protection)\nendif()\n"
+               "if(SAIL_CLASH_PROTECTION AND (LINUX OR CMAKE_CXX_COMPILER_ID STREQUAL \"GNU\"))\n"
+               "  add_compile_options(-fstack-clash-protection)\n"
+               "endif()\n";
+  }
+  return content + "endif()\n";
+}
+
+void prepare_pgo_data(PgoMode pgo, const std::filesystem::path& pgo_dir) {
+  if (pgo == PgoMode::Generate) {
+    // Counters from an older build of the code would not match the new one
+    std::filesystem::remove_all(pgo_dir);
+    std::filesystem::create_directories(pgo_dir);
+    return;
+  }
+  if (pgo != PgoMode::Use) {
+    return;
+  }
+
+  std::vector<std::filesystem::path> raw_profiles;
+  bool has_gcc_profiles = false;
+  if (std::filesystem::exists(pgo_dir)) {
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(pgo_dir)) {
+      const auto extension = entry.path().extension();
+      if (extension == ".profraw") {
+        raw_profiles.push_back(entry.path());
+      }
+      has_gcc_profiles = has_gcc_profiles || extension == ".gcda";
+    }
+  }
+
+  // Clang reads one merged file, which -fprofile-use=<dir> finds as <dir>/default.profdata
+  const std::filesystem::path merged = pgo_dir / "default.profdata";
+  if (!raw_profiles.empty()) {
+    std::string profdata = get_env("LLVM_PROFDATA");
+    if (profdata.empty()) {
+      const auto found = find_program("llvm-profdata");
+      if (!found) {
+        throw std::runtime_error("--pgo-use needs llvm-profdata to merge Clang profiles; put it on PATH or set LLVM_PROFDATA");
+      }
+      profdata = found->string();
+    }
+    std::vector<std::string> merge_command = { profdata, "merge", "-output=" + merged.string() };
+    for (const auto& raw_profile : raw_profiles) {
+      merge_command.push_back(raw_profile.string());
+    }
+    if (!run_process(merge_command).success()) {
+      throw std::runtime_error("Failed to merge the profiles in " + pgo_dir.string());
+    }
+    // The raw profiles are merged now; keeping them would merge them again next time
+    for (const auto& raw_profile : raw_profiles) {
+      std::filesystem::remove(raw_profile);
+    }
+    return;
+  }
+  if (!has_gcc_profiles && !std::filesystem::exists(merged)) {
+    throw std::runtime_error(fmt::format("no profile data in {}; build with --pgo-generate and run the program first", pgo_dir.string()));
+  }
+}
@@ -0,0 +1,57 @@
+#ifndef SAIL_PROFILES_HPP
+#define SAIL_PROFILES_HPP
+
+#include "manifest.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Profile-guided optimization step requested with --pgo-generate or --pgo-use
+enum class PgoMode : std::uint8_t { None, Generate, Use };
+
+// Flags a profile adds on top of the build type's defaults for GCC and Clang
+struct ProfileFlags
+{
+  std::vector<std::string> compile;
+  std::vector<std::string> link;
+};
+
+// A profile ready to build: dev, release, a built-in sanitizer or hardening profile, or a custom
+// [profile.<name>]
+struct BuildProfile
+{
+  std::string name;
+  // Built with CMake's Release build type rather than Debug
+  bool release = false;
+  // Where it builds under target/: debug for dev, and the profile's name otherwise
+  std::string directory;
+  // The profile's settings over those of the profile it inherits
+  ProfileSection settings;
+};
+
+// Resolve `name`. Besides dev and release there are asan (address and undefined behavior
+// sanitizers), ubsan, tsan, msan and hardened (release with hardening) without any table in
+// Sail.toml; a [profile.<name>] table with one of these names adjusts them. Throws
+// std::runtime_error for a profile that is neither.
+[[nodiscard]] BuildProfile resolve_build_profile(const Manifest& manifest, const std::string& name);
+
+// Collected profiles live in target/<mode>/pgo
+[[nodiscard]] std::filesystem::path pgo_data_dir(const std::filesystem::path& target_dir);
+
+// Flags for the native engine, which knows which compiler it runs. `release` tells whether the build
+// is optimized, which _FORTIFY_SOURCE needs.
+[[nodiscard]] ProfileFlags profile_flags(const ProfileSection& profile, PgoMode pgo, const std::filesystem::path& pgo_dir, bool clang,
+                                         bool release);
+
+// CMake code applying the profile, for the file included after the top-level project() through
+// CMAKE_PROJECT_INCLUDE; that works with any CMakeLists.txt and reaches dependencies built with
+// add_subdirectory. Empty when the profile changes nothing.
+[[nodiscard]] std::string profile_cmake_code(const ProfileSection& profile, PgoMode pgo, const std::filesystem::path& pgo_dir);
+
+// Get the profile directory ready: --pgo-generate starts a new training run, and --pgo-use merges
+// Clang's raw profiles with llvm-profdata. Throws std::runtime_error if there is nothing to use.
+void prepare_pgo_data(PgoMode pgo, const std::filesystem::path& pgo_dir);
+
+#endif
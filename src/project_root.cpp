@@ -0,0 +1,88 @@
+#include "project_root.hpp"
+#include "util.hpp"
+
+#include <map>
+#include <mutex>
+#include <system_error>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+bool exists_no_throw(const std::filesystem::path& path) {
+  std::error_code error;
+  return std::filesystem::exists(path, error);
+}
+
+// Device of a directory, used to detect mount points; nullopt where that is not available
+std::optional<unsigned long long> device_of(const std::filesystem::path& directory) {
+#ifdef _WIN32
+  (void)directory;
+  return std::nullopt;
+#else
+  struct stat status{};
+  if (stat(directory.c_str(), &status) != 0) {
+    return std::nullopt;
+  }
+  return static_cast<unsigned long long>(status.st_dev);
+#endif
+}
+
+// Each level costs a lookup of Sail.toml and .git plus a stat of the parent, whose device then
+// stands for the next level. Only git marks the top of a checkout: every further marker would be
+// another lookup per level, which network mounts pay for dearly. Starting in the project root,
+// as sail usually does, takes the one lookup.
+std::optional<std::filesystem::path> walk_up(std::filesystem::path current_path) {
+  std::optional<unsigned long long> start_device;
+  bool left_start = false;
+  while (true) {
+    if (exists_no_throw(current_path / "Sail.toml")) {
+      return current_path;
+    }
+    if (exists_no_throw(current_path / ".git") || current_path == current_path.root_path() || !current_path.has_parent_path()) {
+      return std::nullopt;
+    }
+    std::filesystem::path parent_path = current_path.parent_path();
+    if (parent_path == current_path) {
+      return std::nullopt;
+    }
+    if (!left_start) {
+      start_device = device_of(current_path);
+      left_start = true;
+    }
+    if (device_of(parent_path) != start_device) {
+      return std::nullopt;
+    }
+    current_path = std::move(parent_path);
+  }
+}
+
+}// namespace
+
+std::optional<std::filesystem::path> find_project_root(const std::filesystem::path& start) {
+  const std::string root_override = get_env("SAIL_PROJECT_ROOT");
+  if (!root_override.empty()) {
+    const std::filesystem::path override_path = std::filesystem::absolute(root_override);
+    return exists_no_throw(override_path / "Sail.toml") ? std::optional(override_path) : std::nullopt;
+  }
+
+  // Only calls within one process hit this, such as the daemon check and the command it falls
+  // back to, or sail daemon and sail watch, which look the root up again on every rebuild
+  static std::mutex memo_mutex;
+  static std::map<std::filesystem::path, std::optional<std::filesystem::path>> memo;
+
+  const std::lock_guard lock(memo_mutex);
+  if (const auto memoized = memo.find(start); memoized != memo.end() && memoized->second.has_value()
+                                               && exists_no_throw(*memoized->second / "Sail.toml")) {
+    return memoized->second;
+  }
+  auto project_root = walk_up(start);
+  memo[start] = project_root;
+  return project_root;
+}
+
+std::optional<std::filesystem::path> find_project_root() {
+  return find_project_root(std::filesystem::current_path());
+}
@@ -0,0 +1,17 @@
+#ifndef SAIL_PROJECT_ROOT_HPP
+#define SAIL_PROJECT_ROOT_HPP
+
+#include <filesystem>
+#include <optional>
+
+// Find the directory containing Sail.toml, starting at `start` and walking up.
+// SAIL_PROJECT_ROOT, when set, is used as-is. The walk stops at the root of
+// a git checkout and never crosses onto another filesystem. Results are
+// memoized per start directory for the lifetime of the process, which only
+// long-lived or repeated lookups within one sail benefit from.
+[[nodiscard]] std::optional<std::filesystem::path> find_project_root(const std::filesystem::path& start);
+
+// find_project_root() starting at the current working directory
+[[nodiscard]] std::optional<std::filesystem::path> find_project_root();
+
+#endif
@@ -1,13 +1,34 @@
 #include <sail/sample_library.hpp>
 
+#include <algorithm>
+
+namespace {
+
+// factorial_table with a trailing 0 that every out of range input is clamped to, so that each
+// element costs one unconditional load and the loop has no branch left to keep it from vectorizing
+constexpr std::array<std::uint64_t, factorial_table_size + 1> padded_factorial_table = []() {
+  std::array<std::uint64_t, factorial_table_size + 1> table{};
+  std::copy(factorial_table.begin(), factorial_table.end(), table.begin());
+  return table;
+}();
+
+}// namespace
+
 int factorial(int input) noexcept
 {
-  int result = 1;
+  // 12! is the largest factorial that fits in a 32-bit int
+  constexpr int largest = 12;
+  if (input < 0 || input > largest) { return 0; }
 
-  while (input > 0) {
-    result *= input;
-    --input;
-  }
+  return static_cast<int>(factorial_table[static_cast<std::size_t>(input)]);
+}
 
-  return result;
+void factorial(std::span<const int> inputs, std::span<std::uint64_t> results) noexcept
+{
+  const std::size_t count = std::min(inputs.size(), results.size());
+  for (std::size_t index = 0; index < count; ++index) {
+    // Negative inputs wrap to large unsigned values, so one clamp covers both ends
+    const auto input = static_cast<unsigned>(inputs[index]);
+    results[index] = padded_factorial_table[std::min(input, static_cast<unsigned>(factorial_table_size))];
+  }
 }
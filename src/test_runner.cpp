@@ -0,0 +1,130 @@
+#include "process.hpp"
+#include "test_runner.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <sstream>
+
+namespace {
+
+std::optional<unsigned> parse_unsigned(std::string_view text) {
+  unsigned value = 0;
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc() || end != text.data() + text.size() || text.empty()) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+double seconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+}// namespace
+
+std::optional<TestShard> parse_test_shard(std::string_view text) {
+  const size_t slash = text.find('/');
+  if (slash == std::string_view::npos) {
+    return std::nullopt;
+  }
+  const auto index = parse_unsigned(text.substr(0, slash));
+  const auto count = parse_unsigned(text.substr(slash + 1));
+  if (!index || !count || *index == 0 || *index > *count) {
+    return std::nullopt;
+  }
+  return TestShard{ *index, *count };
+}
+
+std::vector<std::string> select_test_shard(const std::vector<std::string>& sorted_names, const TestShard& shard) {
+  std::vector<std::string> selected;
+  for (size_t i = 0; i < sorted_names.size(); ++i) {
+    if (i % shard.count == shard.index - 1) {
+      selected.push_back(sorted_names[i]);
+    }
+  }
+  return selected;
+}
+
+std::vector<std::string> order_slowest_first(std::vector<std::string> names, const TestDurations& durations) {
+  const auto duration_of = [&](const std::string& name) {
+    const auto found = durations.find(name);
+    return found == durations.end() ? std::chrono::milliseconds::max() : found->second;
+  };
+  std::stable_sort(names.begin(), names.end(), [&](const std::string& left, const std::string& right) {
+    return duration_of(left) > duration_of(right);
+  });
+  return names;
+}
+
+std::filesystem::path test_durations_path(const std::filesystem::path& target_dir) {
+  return target_dir / "test-durations.txt";
+}
+
+TestDurations read_test_durations(const std::filesystem::path& path) {
+  TestDurations durations;
+  std::istringstream lines(read_file(path).value_or(std::string()));
+  std::string line;
+  while (std::getline(lines, line)) {
+    const size_t tab = line.find('\t');
+    const auto milliseconds = tab == std::string::npos ? std::nullopt : parse_unsigned(std::string_view(line).substr(0, tab));
+    if (milliseconds) {
+      durations[line.substr(tab + 1)] = std::chrono::milliseconds(*milliseconds);
+    }
+  }
+  return durations;
+}
+
+void write_test_durations(const std::filesystem::path& path, const TestDurations& durations) {
+  std::string content;
+  for (const auto& [name, duration] : durations) {
+    content += fmt::format("{}\t{}\n", duration.count(), name);
+  }
+  write_file_if_changed(path, content);
+}
+
+int run_tests(const TestRunRequest& request) {
+  const std::vector<std::string> selected = select_test_shard(request.names, request.shard);
+  const std::filesystem::path durations_path = test_durations_path(request.target_dir);
+  TestDurations durations = read_test_durations(durations_path);
+  const std::vector<std::string> ordered = order_slowest_first(selected, durations);
+
+  const std::string shard_note = request.shard.count > 1
+    ? fmt::format(" (shard {}/{} of {})", request.shard.index, request.shard.count, request.names.size()) : std::string();
+  fmt::print("Running {} test(s){}\n", ordered.size(), shard_note);
+
+  std::vector<std::vector<std::string>> commands;
+  for (const auto& name : ordered) {
+    std::vector<std::string> command = { get_executable_path(request.target_dir / "tests", name).string() };
+    command.insert(command.end(), request.args.begin(), request.args.end());
+    commands.push_back(std::move(command));
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  size_t failed = 0;
+  run_processes(commands, request.jobs, ProcessOptions{ ProcessOutput::Capture },
+    [&](size_t index, unsigned /*lane*/, const ProcessResult& result) {
+      const std::string& name = ordered[index];
+      durations[name] = std::chrono::duration_cast<std::chrono::milliseconds>(result.elapsed);
+      if (result.success()) {
+        fmt::print("test {} ... ok ({:.2f}s)\n", name, seconds(result.elapsed));
+        return;
+      }
+      ++failed;
+      fmt::print("test {} ... FAILED, exit code {} ({:.2f}s)\n", name, result.exit_code, seconds(result.elapsed));
+      if (!result.error.empty()) {
+        fmt::print("Error: {}\n", result.error);
+      }
+      if (!result.output.empty()) {
+        fmt::print("---- {} output ----\n{}{}", name, result.output, result.output.back() == '\n' ? "" : "\n");
+      }
+    },
+    true);
+  write_test_durations(durations_path, durations);
+
+  fmt::print("test result: {}. {} passed; {} failed; finished in {:.2f}s\n", failed == 0 ? "ok" : "FAILED",
+    ordered.size() - failed, failed, seconds(std::chrono::steady_clock::now() - start));
+  return failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
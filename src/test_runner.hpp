@@ -0,0 +1,53 @@
+#ifndef SAIL_TEST_RUNNER_HPP
+#define SAIL_TEST_RUNNER_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One slice of the test programs for --shard i/n; index is 1-based
+struct TestShard
+{
+  unsigned index = 1;
+  unsigned count = 1;
+};
+
+// Parse "i/n" with 1 <= i <= n; std::nullopt if it is anything else
+[[nodiscard]] std::optional<TestShard> parse_test_shard(std::string_view text);
+
+// The tests of one shard. Tests are dealt out by their position in the sorted list, so every
+// machine computes the same split whatever durations it has seen.
+[[nodiscard]] std::vector<std::string> select_test_shard(const std::vector<std::string>& sorted_names, const TestShard& shard);
+
+using TestDurations = std::map<std::string, std::chrono::milliseconds>;
+
+// Slowest first, so that the longest test does not start last and stretch the run; tests that
+// never ran are put before all others, since nothing says they are quick
+[[nodiscard]] std::vector<std::string> order_slowest_first(std::vector<std::string> names, const TestDurations& durations);
+
+// Durations of earlier runs, kept in target/<mode>/test-durations.txt
+[[nodiscard]] std::filesystem::path test_durations_path(const std::filesystem::path& target_dir);
+[[nodiscard]] TestDurations read_test_durations(const std::filesystem::path& path);
+void write_test_durations(const std::filesystem::path& path, const TestDurations& durations);
+
+struct TestRunRequest
+{
+  std::filesystem::path target_dir;
+  // Names of the test programs in target/<mode>/tests, sorted
+  std::vector<std::string> names;
+  TestShard shard;
+  unsigned jobs = 1;
+  // Passed to every test program
+  std::vector<std::string> args;
+};
+
+// Run the shard's test programs on up to `jobs` at a time, slowest first, and report each one.
+// The output of failing tests is printed once they finish. The durations are stored for the
+// next run. Returns EXIT_SUCCESS if every test passed.
+[[nodiscard]] int run_tests(const TestRunRequest& request);
+
+#endif
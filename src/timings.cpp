@@ -0,0 +1,184 @@
+#include "timings.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <array>
+#include <ctime>
+#include <fmt/format.h>
+#include <map>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+
+namespace {
+
+double to_seconds(BuildTimings::Clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+long long to_microseconds(BuildTimings::Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+bool ends_with(std::string_view text, std::string_view suffix) {
+  return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// CMake names objects CMakeFiles/<target>.dir/<source>.o; show them as the source they come from
+std::string object_to_source(std::string_view object) {
+  const size_t dir = object.find(".dir/");
+  if (object.compare(0, 11, "CMakeFiles/") == 0 && dir != std::string_view::npos) {
+    object.remove_prefix(dir + 5);
+  }
+  for (const std::string_view suffix : { ".o", ".obj" }) {
+    if (ends_with(object, suffix)) {
+      object.remove_suffix(suffix.size());
+      break;
+    }
+  }
+  return std::string(object);
+}
+
+}// namespace
+
+void BuildTimings::record(std::string name, std::string category, Clock::time_point start, Clock::time_point end, unsigned lane) {
+  const std::lock_guard lock(mutex);
+  recorded.push_back(Span{ std::move(name), std::move(category), start - origin, end - start, lane });
+}
+
+void BuildTimings::add_note(std::string note) {
+  const std::lock_guard lock(mutex);
+  notes.push_back(std::move(note));
+}
+
+bool BuildTimings::import_ninja_log(const std::filesystem::path& build_dir, std::uintmax_t log_offset, Clock::time_point build_start) {
+  const auto log = read_file(build_dir / ".ninja_log");
+  if (!log) {
+    return false;
+  }
+  // Ninja rewrites the log occasionally; then everything left in it is from this build or older
+  // and the newest entry per output wins below
+  std::istringstream lines(log->size() >= log_offset ? log->substr(log_offset) : *log);
+
+  // Columns: start ms, end ms, mtime, output, command hash
+  std::map<std::string, std::pair<long long, long long>> jobs;
+  std::string line;
+  while (std::getline(lines, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::array<std::string, 4> fields;
+    std::istringstream columns(line);
+    if (!std::getline(columns, fields[0], '\t') || !std::getline(columns, fields[1], '\t')
+        || !std::getline(columns, fields[2], '\t') || !std::getline(columns, fields[3], '\t')) {
+      continue;
+    }
+    // Re-running CMake is shown as its own phase by sail
+    if (fields[3] == "build.ninja") {
+      continue;
+    }
+    try {
+      jobs[fields[3]] = { std::stoll(fields[0]), std::stoll(fields[1]) };
+    } catch (const std::exception&) {
+      continue;
+    }
+  }
+
+  // Ninja does not log on which of its job slots a command ran, so lay the jobs out greedily
+  std::vector<std::pair<std::pair<long long, long long>, std::string>> ordered;
+  ordered.reserve(jobs.size());
+  for (auto& [output, times] : jobs) {
+    ordered.emplace_back(times, output);
+  }
+  std::sort(ordered.begin(), ordered.end());
+  std::vector<long long> lane_ends;
+  for (const auto& [times, output] : ordered) {
+    const auto free_lane = std::find_if(lane_ends.begin(), lane_ends.end(), [&](long long end) { return end <= times.first; });
+    unsigned lane = 0;
+    if (free_lane == lane_ends.end()) {
+      lane_ends.push_back(times.second);
+      lane = static_cast<unsigned>(lane_ends.size());
+    } else {
+      *free_lane = times.second;
+      lane = static_cast<unsigned>(free_lane - lane_ends.begin()) + 1;
+    }
+    const bool is_object = ends_with(output, ".o") || ends_with(output, ".obj");
+    record(is_object ? object_to_source(output) : output,
+      is_object ? "compile" : "link",
+      build_start + std::chrono::milliseconds(times.first),
+      build_start + std::chrono::milliseconds(times.second),
+      lane);
+  }
+  return true;
+}
+
+std::vector<BuildTimings::Span> BuildTimings::spans() const {
+  const std::lock_guard lock(mutex);
+  std::vector<Span> sorted = recorded;
+  std::stable_sort(sorted.begin(), sorted.end(), [](const Span& lhs, const Span& rhs) { return lhs.start < rhs.start; });
+  return sorted;
+}
+
+void BuildTimings::write_chrome_trace(const std::filesystem::path& trace_path) const {
+  std::string trace = "{\"traceEvents\":[\n";
+  bool first = true;
+  for (const auto& span : spans()) {
+    trace += fmt::format("{}{{\"name\":{},\"cat\":{},\"ph\":\"X\",\"ts\":{},\"dur\":{},\"pid\":1,\"tid\":{}}}",
+      first ? "" : ",\n",
+      json_quote(span.name),
+      json_quote(span.category),
+      to_microseconds(span.start),
+      to_microseconds(span.duration),
+      span.lane);
+    first = false;
+  }
+  trace += "\n],\"displayTimeUnit\":\"ms\"}\n";
+  write_file_if_changed(trace_path, trace);
+}
+
+void BuildTimings::print_summary() const {
+  const std::vector<Span> all_spans = spans();
+  std::vector<const Span*> units;
+  BuildTimings::Clock::duration compile_total{};
+  fmt::print("\nTimings:\n");
+  for (const auto& span : all_spans) {
+    if (span.category == "phase") {
+      fmt::print("  {:<28} {:>9.3f}s\n", span.name, to_seconds(span.duration));
+    } else if (span.category == "compile") {
+      units.push_back(&span);
+      compile_total += span.duration;
+    } else {
+      fmt::print("  {:<28} {:>9.3f}s\n", "link " + span.name, to_seconds(span.duration));
+    }
+  }
+  if (!units.empty()) {
+    std::sort(units.begin(), units.end(), [](const Span* lhs, const Span* rhs) { return lhs->duration > rhs->duration; });
+    fmt::print("\n  {} translation units, {:.3f}s of compile time. Slowest:\n", units.size(), to_seconds(compile_total));
+    constexpr size_t slowest_shown = 10;
+    for (size_t i = 0; i < std::min(units.size(), slowest_shown); ++i) {
+      fmt::print("  {:>9.3f}s  {}\n", to_seconds(units[i]->duration), units[i]->name);
+    }
+  }
+
+  const std::lock_guard lock(mutex);
+  for (const auto& note : notes) {
+    fmt::print("\n  Note: {}\n", note);
+  }
+}
+
+std::filesystem::path report_timings(const BuildTimings& timings, const std::filesystem::path& target_dir) {
+  const std::filesystem::path timings_dir = target_dir / "timings";
+  std::filesystem::create_directories(timings_dir);
+
+  std::array<char, 32> stamp{};
+  const std::time_t now = std::time(nullptr);
+  std::strftime(stamp.data(), stamp.size(), "%Y%m%dT%H%M%S", std::localtime(&now));// NOLINT(concurrency-mt-unsafe)
+  const std::filesystem::path trace_path = timings_dir / fmt::format("sail-timing-{}.json", stamp.data());
+
+  timings.print_summary();
+  timings.write_chrome_trace(trace_path);
+  std::error_code error;
+  std::filesystem::copy_file(trace_path, timings_dir / "sail-timing.json", std::filesystem::copy_options::overwrite_existing, error);
+  fmt::print("\nWrote {}\n", trace_path.string());
+  return trace_path;
+}
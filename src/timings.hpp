@@ -0,0 +1,85 @@
+#ifndef SAIL_TIMINGS_HPP
+#define SAIL_TIMINGS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Wall-clock profile of one build: sail's own phases plus every compile and link job.
+// Spans can be recorded from any thread.
+class BuildTimings
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Span
+  {
+    std::string name;
+    // "phase", "compile" or "link"
+    std::string category;
+    Clock::duration start{};
+    Clock::duration duration{};
+    // Row in the trace viewer; 0 holds the phases, jobs are spread over the rows after it
+    unsigned lane = 0;
+  };
+
+  BuildTimings() : origin(Clock::now()) {}
+
+  void record(std::string name, std::string category, Clock::time_point start, Clock::time_point end, unsigned lane = 0);
+
+  // Printed at the end of the summary
+  void add_note(std::string note);
+
+  // Add the jobs Ninja logged after `log_offset` bytes of <build_dir>/.ninja_log, taking
+  // `build_start` as the moment Ninja started. Returns false if there is no log.
+  bool import_ninja_log(const std::filesystem::path& build_dir, std::uintmax_t log_offset, Clock::time_point build_start);
+
+  [[nodiscard]] std::vector<Span> spans() const;
+
+  // Chrome trace event format, viewable in chrome://tracing or https://ui.perfetto.dev
+  void write_chrome_trace(const std::filesystem::path& trace_path) const;
+
+  // Time per phase and the slowest translation units
+  void print_summary() const;
+
+private:
+  Clock::time_point origin;
+  mutable std::mutex mutex;
+  std::vector<Span> recorded;
+  std::vector<std::string> notes;
+};
+
+// Records a phase from construction until it goes out of scope; does nothing without timings
+class ScopedTiming
+{
+public:
+  ScopedTiming(BuildTimings* build_timings, std::string phase_name)
+    : timings(build_timings), name(std::move(phase_name)), start(BuildTimings::Clock::now()) {}
+  ScopedTiming(const ScopedTiming&) = delete;
+  ScopedTiming& operator=(const ScopedTiming&) = delete;
+  ScopedTiming(ScopedTiming&&) = delete;
+  ScopedTiming& operator=(ScopedTiming&&) = delete;
+  ~ScopedTiming() {
+    if (timings != nullptr) {
+      try {
+        timings->record(std::move(name), "phase", start, BuildTimings::Clock::now());
+      } catch (...) {// NOLINT(bugprone-empty-catch)
+        // A lost span is not worth failing the build over
+      }
+    }
+  }
+
+private:
+  BuildTimings* timings;
+  std::string name;
+  BuildTimings::Clock::time_point start;
+};
+
+// Write the trace to target/<mode>/timings/ and print the summary. Returns the trace path.
+std::filesystem::path report_timings(const BuildTimings& timings, const std::filesystem::path& target_dir);
+
+#endif
@@ -0,0 +1,536 @@
+#include "toml.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <iterator>
+#include <set>
+#include <utility>
+
+const TomlValue* TomlValue::find(std::string_view key) const noexcept {
+  if (type != Type::Table) {
+    return nullptr;
+  }
+  const auto found = std::find(keys.begin(), keys.end(), key);
+  return found == keys.end() ? nullptr : &values[static_cast<size_t>(found - keys.begin())];
+}
+
+TomlValue* TomlValue::find(std::string_view key) noexcept {
+  return const_cast<TomlValue*>(std::as_const(*this).find(key));  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+}
+
+const TomlValue* TomlValue::find_path(std::string_view dotted_path) const noexcept {
+  const TomlValue* current = this;
+  while (current != nullptr && !dotted_path.empty()) {
+    const size_t dot = dotted_path.find('.');
+    current = current->find(dotted_path.substr(0, dot));
+    dotted_path = dot == std::string_view::npos ? std::string_view() : dotted_path.substr(dot + 1);
+  }
+  return current;
+}
+
+std::string_view toml_type_name(TomlValue::Type type) noexcept {
+  switch (type) {
+  case TomlValue::Type::String: return "string";
+  case TomlValue::Type::Integer: return "integer";
+  case TomlValue::Type::Float: return "float";
+  case TomlValue::Type::Boolean: return "boolean";
+  case TomlValue::Type::Array: return "array";
+  case TomlValue::Type::Table: return "table";
+  }
+  return "value";
+}
+
+namespace {
+
+// Recursive descent parser for the subset of TOML 1.0 that manifests use
+class TomlParser
+{
+public:
+  TomlParser(std::string_view document, std::string_view source_name) : text(document), source(source_name) {}
+
+  TomlValue parse() {
+    TomlValue root;
+    TomlValue* current_table = &root;
+    while (true) {
+      skip_blank_lines();
+      if (at_end()) {
+        return root;
+      }
+      if (peek() == '[') {
+        current_table = parse_table_header(root);
+      } else {
+        std::vector<std::string> key_path = parse_key_path();
+        skip_whitespace();
+        expect('=');
+        skip_whitespace();
+        TomlValue value = parse_value();
+        insert(*current_table, key_path, std::move(value));
+      }
+      expect_end_of_line();
+    }
+  }
+
+private:
+  // Arrays and inline tables nested deeper than this are rejected before they exhaust the stack;
+  // the manifest snapshot reader stops at the same depth
+  static constexpr int max_nesting = 64;
+
+  std::string_view text;
+  std::string_view source;
+  size_t pos = 0;
+  size_t line = 1;
+  // Tables opened by a [header], each identified by its path; arrays of tables count by element
+  std::set<std::string> defined_tables;
+
+  [[noreturn]] void fail(std::string_view message) const {
+    throw TomlParseError(fmt::format("{}:{}: {}", source, line, message));
+  }
+
+  [[nodiscard]] bool at_end() const noexcept { return pos >= text.size(); }
+  [[nodiscard]] char peek(size_t offset = 0) const noexcept {
+    return pos + offset < text.size() ? text[pos + offset] : '\0';
+  }
+  [[nodiscard]] bool starts_with(std::string_view prefix) const noexcept {
+    return text.substr(pos, prefix.size()) == prefix;
+  }
+
+  char advance() {
+    const char character = text[pos++];
+    if (character == '\n') {
+      ++line;
+    }
+    return character;
+  }
+
+  void expect(char character) {
+    if (peek() != character) {
+      fail(fmt::format("expected '{}'", character));
+    }
+    advance();
+  }
+
+  void skip_whitespace() {
+    while (peek() == ' ' || peek() == '\t') {
+      advance();
+    }
+  }
+
+  void skip_comment() {
+    if (peek() == '#') {
+      while (!at_end() && peek() != '\n') {
+        advance();
+      }
+    }
+  }
+
+  // Whitespace, comments and newlines, as allowed between statements and inside arrays
+  void skip_blank_lines() {
+    while (true) {
+      skip_whitespace();
+      skip_comment();
+      if (peek() == '\r' && peek(1) == '\n') {
+        advance();
+      }
+      if (peek() != '\n') {
+        return;
+      }
+      advance();
+    }
+  }
+
+  void expect_end_of_line() {
+    skip_whitespace();
+    skip_comment();
+    if (peek() == '\r') {
+      advance();
+    }
+    if (!at_end() && peek() != '\n') {
+      fail("expected a newline after the value");
+    }
+  }
+
+  static bool is_bare_key_char(char character) noexcept {
+    return (character >= 'A' && character <= 'Z') || (character >= 'a' && character <= 'z')
+           || (character >= '0' && character <= '9') || character == '_' || character == '-';
+  }
+
+  std::string parse_key() {
+    if (peek() == '"') {
+      return parse_basic_string();
+    }
+    if (peek() == '\'') {
+      return parse_literal_string();
+    }
+    std::string key;
+    while (is_bare_key_char(peek())) {
+      key += advance();
+    }
+    if (key.empty()) {
+      fail("expected a key");
+    }
+    return key;
+  }
+
+  std::vector<std::string> parse_key_path() {
+    std::vector<std::string> key_path{ parse_key() };
+    skip_whitespace();
+    while (peek() == '.') {
+      advance();
+      skip_whitespace();
+      key_path.push_back(parse_key());
+      skip_whitespace();
+    }
+    return key_path;
+  }
+
+  // Walk to (creating as needed) the table at key_path; arrays of tables resolve to their last element
+  TomlValue& descend(TomlValue& table, const std::vector<std::string>& key_path, size_t count) {
+    TomlValue* current = &table;
+    for (size_t i = 0; i < count; ++i) {
+      TomlValue* next = current->find(key_path[i]);
+      if (next == nullptr) {
+        current->keys.push_back(key_path[i]);
+        current->values.emplace_back();
+        next = &current->values.back();
+      }
+      if (next->type == TomlValue::Type::Array && !next->array.empty() && next->array.back().is_table()) {
+        next = &next->array.back();
+      }
+      if (!next->is_table()) {
+        fail(fmt::format("key '{}' is not a table", key_path[i]));
+      }
+      current = next;
+    }
+    return *current;
+  }
+
+  void insert(TomlValue& table, const std::vector<std::string>& key_path, TomlValue value) {
+    TomlValue& parent = descend(table, key_path, key_path.size() - 1);
+    if (parent.find(key_path.back()) != nullptr) {
+      fail(fmt::format("duplicate key '{}'", key_path.back()));
+    }
+    parent.keys.push_back(key_path.back());
+    parent.values.push_back(std::move(value));
+  }
+
+  TomlValue* parse_table_header(TomlValue& root) {
+    advance();
+    const bool is_array_of_tables = peek() == '[';
+    if (is_array_of_tables) {
+      advance();
+    }
+    skip_whitespace();
+    const std::vector<std::string> key_path = parse_key_path();
+    expect(']');
+    if (is_array_of_tables) {
+      expect(']');
+      TomlValue& parent = descend(root, key_path, key_path.size() - 1);
+      TomlValue* array = parent.find(key_path.back());
+      if (array == nullptr) {
+        parent.keys.push_back(key_path.back());
+        parent.values.emplace_back();
+        array = &parent.values.back();
+        array->type = TomlValue::Type::Array;
+      }
+      if (array->type != TomlValue::Type::Array) {
+        fail(fmt::format("key '{}' is not an array of tables", key_path.back()));
+      }
+      array->array.emplace_back();
+      return &array->array.back();
+    }
+    // A table may be created implicitly by the headers below it, but only opened by its own header once
+    if (!defined_tables.insert(table_identity(root, key_path)).second) {
+      fail(fmt::format("table [{}] is defined more than once", fmt::join(key_path, ".")));
+    }
+    return &descend(root, key_path, key_path.size());
+  }
+
+  // The keys of a path, with the element an array of tables resolves to, so that the same subtable
+  // of two elements is told apart
+  std::string table_identity(const TomlValue& root, const std::vector<std::string>& key_path) const {
+    std::string identity;
+    const TomlValue* current = &root;
+    for (const auto& key : key_path) {
+      identity += fmt::format("{}:{}", key.size(), key);
+      current = current != nullptr ? current->find(key) : nullptr;
+      if (current != nullptr && current->type == TomlValue::Type::Array && !current->array.empty()) {
+        identity += fmt::format("[{}]", current->array.size() - 1);
+        current = &current->array.back();
+      }
+    }
+    return identity;
+  }
+
+  void append_utf8(std::string& out, std::uint32_t code_point) {
+    if (code_point < 0x80) {
+      out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+      out += static_cast<char>(0xC0 | (code_point >> 6));
+      out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+      out += static_cast<char>(0xE0 | (code_point >> 12));
+      out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x110000) {
+      out += static_cast<char>(0xF0 | (code_point >> 18));
+      out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+      fail("invalid unicode escape");
+    }
+  }
+
+  void parse_escape(std::string& out) {
+    const char escaped = at_end() ? '\0' : advance();
+    switch (escaped) {
+    case 'b': out += '\b'; return;
+    case 't': out += '\t'; return;
+    case 'n': out += '\n'; return;
+    case 'f': out += '\f'; return;
+    case 'r': out += '\r'; return;
+    case '"': out += '"'; return;
+    case '\\': out += '\\'; return;
+    case 'u':
+    case 'U': {
+      const size_t digits = escaped == 'u' ? 4 : 8;
+      if (pos + digits > text.size()) {
+        fail("truncated unicode escape");
+      }
+      const std::string hex(text.substr(pos, digits));
+      char* end = nullptr;
+      const auto code_point = std::strtoul(hex.c_str(), &end, 16);
+      if (end != hex.c_str() + hex.size()) {
+        fail("invalid unicode escape");
+      }
+      pos += digits;
+      append_utf8(out, static_cast<std::uint32_t>(code_point));
+      return;
+    }
+    default: fail("invalid escape sequence");
+    }
+  }
+
+  std::string parse_basic_string() {
+    if (starts_with("\"\"\"")) {
+      return parse_multiline_basic_string();
+    }
+    advance();
+    std::string result;
+    while (true) {
+      if (at_end() || peek() == '\n') {
+        fail("unterminated string");
+      }
+      const char character = advance();
+      if (character == '"') {
+        return result;
+      }
+      if (character == '\\') {
+        parse_escape(result);
+      } else {
+        result += character;
+      }
+    }
+  }
+
+  std::string parse_multiline_basic_string() {
+    pos += 3;
+    if (peek() == '\n') {
+      advance();
+    } else if (peek() == '\r' && peek(1) == '\n') {
+      advance();
+      advance();
+    }
+    std::string result;
+    while (true) {
+      if (at_end()) {
+        fail("unterminated multi-line string");
+      }
+      if (starts_with("\"\"\"") && !starts_with("\"\"\"\"")) {
+        pos += 3;
+        return result;
+      }
+      const char character = advance();
+      if (character != '\\') {
+        result += character;
+        continue;
+      }
+      // A backslash at the end of a line trims the newline and the leading whitespace that follows
+      size_t lookahead = pos;
+      while (lookahead < text.size() && (text[lookahead] == ' ' || text[lookahead] == '\t')) {
+        ++lookahead;
+      }
+      if (lookahead < text.size() && (text[lookahead] == '\n' || text[lookahead] == '\r')) {
+        while (!at_end() && (peek() == ' ' || peek() == '\t' || peek() == '\n' || peek() == '\r')) {
+          advance();
+        }
+      } else {
+        parse_escape(result);
+      }
+    }
+  }
+
+  std::string parse_literal_string() {
+    if (starts_with("'''")) {
+      pos += 3;
+      if (peek() == '\n') {
+        advance();
+      }
+      const size_t end = text.find("'''", pos);
+      if (end == std::string_view::npos) {
+        fail("unterminated multi-line string");
+      }
+      std::string result(text.substr(pos, end - pos));
+      line += static_cast<size_t>(std::count(result.begin(), result.end(), '\n'));
+      pos = end + 3;
+      return result;
+    }
+    advance();
+    const size_t end = text.find_first_of("'\n", pos);
+    if (end == std::string_view::npos || text[end] != '\'') {
+      fail("unterminated string");
+    }
+    std::string result(text.substr(pos, end - pos));
+    pos = end + 1;
+    return result;
+  }
+
+  TomlValue parse_array(int depth) {
+    if (depth > max_nesting) {
+      fail("arrays and inline tables are nested too deeply");
+    }
+    advance();
+    TomlValue array;
+    array.type = TomlValue::Type::Array;
+    while (true) {
+      skip_blank_lines();
+      if (peek() == ']') {
+        advance();
+        return array;
+      }
+      array.array.push_back(parse_value(depth + 1));
+      skip_blank_lines();
+      if (peek() == ',') {
+        advance();
+      } else if (peek() != ']') {
+        fail("expected ',' or ']' in array");
+      }
+    }
+  }
+
+  TomlValue parse_inline_table(int depth) {
+    if (depth > max_nesting) {
+      fail("arrays and inline tables are nested too deeply");
+    }
+    advance();
+    TomlValue table;
+    skip_whitespace();
+    if (peek() == '}') {
+      advance();
+      return table;
+    }
+    while (true) {
+      skip_whitespace();
+      const std::vector<std::string> key_path = parse_key_path();
+      skip_whitespace();
+      expect('=');
+      skip_whitespace();
+      TomlValue value = parse_value(depth + 1);
+      insert(table, key_path, std::move(value));
+      skip_whitespace();
+      if (peek() == '}') {
+        advance();
+        return table;
+      }
+      expect(',');
+    }
+  }
+
+  TomlValue parse_scalar() {
+    std::string token;
+    while (!at_end()) {
+      const char character = peek();
+      if (character == ',' || character == ']' || character == '}' || character == '#' || character == '\n'
+          || character == '\r' || character == '\t') {
+        break;
+      }
+      // A space is only part of a value between a date and a time
+      if (character == ' ' && !(token.size() == 10 && token[4] == '-' && peek(1) >= '0' && peek(1) <= '9')) {
+        break;
+      }
+      token += advance();
+    }
+    if (token.empty()) {
+      fail("expected a value");
+    }
+
+    TomlValue value;
+    if (token == "true" || token == "false") {
+      value.type = TomlValue::Type::Boolean;
+      value.boolean = token == "true";
+      return value;
+    }
+
+    // Dates and times are kept as text; manifests do not interpret them
+    if (token.find(':') != std::string::npos || (token.size() >= 10 && token[4] == '-' && token[7] == '-')) {
+      value.type = TomlValue::Type::String;
+      value.string = token;
+      return value;
+    }
+
+    std::string digits;
+    std::copy_if(token.begin(), token.end(), std::back_inserter(digits), [](char character) { return character != '_'; });
+    const std::string unsigned_digits = digits.substr(digits[0] == '+' || digits[0] == '-' ? 1 : 0);
+    int base = 10;
+    std::string number = digits;
+    if (unsigned_digits.size() > 2 && unsigned_digits[0] == '0' && (unsigned_digits[1] == 'x' || unsigned_digits[1] == 'o' || unsigned_digits[1] == 'b')) {
+      base = unsigned_digits[1] == 'x' ? 16 : unsigned_digits[1] == 'o' ? 8 : 2;
+      number = unsigned_digits.substr(2);
+    }
+
+    const bool is_float = base == 10
+                          && (unsigned_digits == "inf" || unsigned_digits == "nan"
+                              || digits.find_first_of(".eE") != std::string::npos);
+    errno = 0;
+    char* end = nullptr;
+    if (is_float) {
+      value.type = TomlValue::Type::Float;
+      value.floating = std::strtod(digits.c_str(), &end);
+      if (end != digits.c_str() + digits.size()) {
+        fail(fmt::format("invalid value '{}'", token));
+      }
+      return value;
+    }
+    value.type = TomlValue::Type::Integer;
+    value.integer = std::strtoll(number.c_str(), &end, base);
+    if (number.empty() || end != number.c_str() + number.size() || errno == ERANGE) {
+      fail(fmt::format("invalid value '{}'", token));
+    }
+    return value;
+  }
+
+  TomlValue parse_value(int depth = 0) {
+    if (peek() == '"' || peek() == '\'') {
+      TomlValue value;
+      value.type = TomlValue::Type::String;
+      value.string = peek() == '"' ? parse_basic_string() : parse_literal_string();
+      return value;
+    }
+    if (peek() == '[') {
+      return parse_array(depth);
+    }
+    if (peek() == '{') {
+      return parse_inline_table(depth);
+    }
+    return parse_scalar();
+  }
+};
+
+}// namespace
+
+TomlValue parse_toml(std::string_view document, std::string_view source) {
+  return TomlParser(document, source).parse();
+}
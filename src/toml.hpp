@@ -0,0 +1,49 @@
+#ifndef SAIL_TOML_HPP
+#define SAIL_TOML_HPP
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Thrown for malformed documents; the message carries the file name and line number
+class TomlParseError : public std::runtime_error
+{
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// A parsed TOML value. Tables keep their keys in document order.
+// Offset date-times and local dates/times are kept as their source text in a String.
+struct TomlValue
+{
+  enum class Type : std::uint8_t { String, Integer, Float, Boolean, Array, Table };
+
+  Type type = Type::Table;
+  std::string string;
+  std::int64_t integer = 0;
+  double floating = 0.0;
+  bool boolean = false;
+  std::vector<TomlValue> array;
+  std::vector<std::string> keys;
+  std::vector<TomlValue> values;
+
+  [[nodiscard]] bool is_table() const noexcept { return type == Type::Table; }
+
+  // Look up a key in a table, nullptr if missing or if this is not a table
+  [[nodiscard]] const TomlValue* find(std::string_view key) const noexcept;
+  [[nodiscard]] TomlValue* find(std::string_view key) noexcept;
+
+  // Look up a dotted path of keys such as "profile.release.lto"
+  [[nodiscard]] const TomlValue* find_path(std::string_view dotted_path) const noexcept;
+};
+
+// Human readable name of a value type, used in error messages
+[[nodiscard]] std::string_view toml_type_name(TomlValue::Type type) noexcept;
+
+// Parse a whole TOML document into its root table; throws TomlParseError, naming `source` as the file
+// the document came from
+[[nodiscard]] TomlValue parse_toml(std::string_view document, std::string_view source = "Sail.toml");
+
+#endif
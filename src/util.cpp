@@ -0,0 +1,186 @@
+#include "util.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+
+std::filesystem::path get_executable_path(const std::filesystem::path& target_dir, const std::string& project_name) {
+  return target_dir / (project_name + std::string(EXECUTABLE_EXTENSION));
+}
+
+std::uint64_t fnv1a_hash(std::string_view data, std::uint64_t hash) noexcept {
+  for (const char byte : data) {
+    hash ^= static_cast<std::uint8_t>(byte);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::optional<std::string> read_file(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return std::nullopt;
+  }
+  return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::string get_env(const char* name) {
+  const char* value = std::getenv(name);  // NOLINT(concurrency-mt-unsafe)
+  return value != nullptr ? std::string(value) : std::string();
+}
+
+std::optional<std::filesystem::path> find_program(std::string_view name) {
+#ifdef _WIN32
+  constexpr char path_separator = ';';
+#else
+  constexpr char path_separator = ':';
+#endif
+  const std::string path_env = get_env("PATH");
+  const std::string file_name = std::string(name) + std::string(EXECUTABLE_EXTENSION);
+  size_t begin = 0;
+  while (begin <= path_env.size()) {
+    size_t end = path_env.find(path_separator, begin);
+    if (end == std::string::npos) {
+      end = path_env.size();
+    }
+    if (end > begin) {
+      const std::filesystem::path candidate = std::filesystem::path(path_env.substr(begin, end - begin)) / file_name;
+      std::error_code error;
+      if (std::filesystem::is_regular_file(candidate, error)) {
+        return candidate;
+      }
+    }
+    begin = end + 1;
+  }
+  return std::nullopt;
+}
+
+bool write_file_if_changed(const std::filesystem::path& path, std::string_view content) {
+  if (read_file(path) == content) {
+    return false;
+  }
+  std::ofstream file(path, std::ios::binary);
+  if (!file || !(file << content)) {
+    throw std::runtime_error("Failed to write " + path.string());
+  }
+  return true;
+}
+
+std::string cmake_quote(std::string_view value) {
+  std::string result = "\"";
+  for (const char character : value) {
+    if (character == '\\' || character == '"' || character == '$' || character == ';') {
+      result += '\\';
+    }
+    result += character;
+  }
+  result += '"';
+  return result;
+}
+
+std::string json_quote(std::string_view text) {
+  std::string quoted = "\"";
+  for (const char character : text) {
+    switch (character) {
+    case '"': quoted += "\\\""; break;
+    case '\\': quoted += "\\\\"; break;
+    case '\n': quoted += "\\n"; break;
+    case '\t': quoted += "\\t"; break;
+    default:
+      if (static_cast<unsigned char>(character) < 0x20) {
+        quoted += fmt::format("\\u{:04x}", static_cast<unsigned>(character));
+      } else {
+        quoted += character;
+      }
+      break;
+    }
+  }
+  quoted += '"';
+  return quoted;
+}
+
+void link_compilation_database(const std::filesystem::path& database, const std::filesystem::path& project_root) {
+  std::error_code error;
+  if (!std::filesystem::exists(database, error)) {
+    return;
+  }
+  const std::filesystem::path link = project_root / "compile_commands.json";
+  const std::filesystem::path copy_note = project_root / "target" / "compile_commands.copied";
+  const auto status = std::filesystem::symlink_status(link, error);
+  if (std::filesystem::is_symlink(status)) {
+    if (std::filesystem::read_symlink(link, error) == database) {
+      return;
+    }
+    std::filesystem::remove(link, error);
+  } else if (std::filesystem::exists(status)) {
+    // A copy made here is recognised by the hash noted next to it in target/
+    const auto content = read_file(link);
+    if (!content || read_file(copy_note) != fmt::format("{:016x}", fnv1a_hash(*content))) {
+      return;
+    }
+  }
+  std::filesystem::create_symlink(database, link, error);
+  if (!error) {
+    return;
+  }
+  const auto content = read_file(database);
+  if (content && std::filesystem::copy_file(database, link, std::filesystem::copy_options::overwrite_existing, error)) {
+    write_file_if_changed(copy_note, fmt::format("{:016x}", fnv1a_hash(*content)));
+  }
+}
+
+std::string pch_include_spelling(const std::string& header, const std::filesystem::path& project_root) {
+  if (header.size() > 2 && ((header.front() == '<' && header.back() == '>') || (header.front() == '"' && header.back() == '"'))) {
+    return header;
+  }
+  std::error_code error;
+  if (std::filesystem::is_regular_file(project_root / header, error)) {
+    return "\"" + (project_root / header).generic_string() + "\"";
+  }
+  return "\"" + header + "\"";
+}
+
+namespace {
+
+std::vector<std::filesystem::path> collect_files(const std::filesystem::path& src_dir,
+                                                 std::initializer_list<std::string_view> extensions) {
+  std::vector<std::filesystem::path> files;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(src_dir)) {
+    const std::string extension = entry.path().extension().string();
+    if (entry.is_regular_file() && std::find(extensions.begin(), extensions.end(), extension) != extensions.end()) {
+      files.push_back(entry.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+}// namespace
+
+std::vector<std::filesystem::path> collect_sources(const std::filesystem::path& src_dir) {
+  return collect_files(src_dir, { ".cpp", ".c" });
+}
+
+std::vector<std::filesystem::path> collect_module_sources(const std::filesystem::path& src_dir) {
+  return collect_files(src_dir, { ".cppm", ".ixx" });
+}
+
+std::vector<std::filesystem::path> collect_program_sources(const std::filesystem::path& programs_dir) {
+  std::vector<std::filesystem::path> tests;
+  std::error_code error;
+  for (std::filesystem::directory_iterator entry(programs_dir, error), end; !error && entry != end; entry.increment(error)) {
+    if (entry->is_regular_file(error) && entry->path().extension() == ".cpp") {
+      tests.push_back(entry->path());
+    }
+  }
+  std::sort(tests.begin(), tests.end());
+  return tests;
+}
+
+bool is_main_source(const std::filesystem::path& source, const std::filesystem::path& src_dir) {
+  return source.parent_path() == src_dir && source.stem() == "main";
+}
@@ -0,0 +1,64 @@
+#ifndef SAIL_UTIL_HPP
+#define SAIL_UTIL_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+    constexpr std::string_view EXECUTABLE_EXTENSION{".exe"};
+#else
+    constexpr std::string_view EXECUTABLE_EXTENSION{};
+#endif
+
+// Get executable path with correct extension
+[[nodiscard]] std::filesystem::path get_executable_path(const std::filesystem::path& target_dir, const std::string& project_name);
+
+// Hash data with 64-bit FNV-1a (stable across runs and platforms)
+[[nodiscard]] std::uint64_t fnv1a_hash(std::string_view data, std::uint64_t hash = 14695981039346656037ULL) noexcept;
+
+// Read a whole file; returns std::nullopt if it cannot be opened
+[[nodiscard]] std::optional<std::string> read_file(const std::filesystem::path& path);
+
+// Read an environment variable, empty if unset
+[[nodiscard]] std::string get_env(const char* name);
+
+// Look up an executable on PATH
+[[nodiscard]] std::optional<std::filesystem::path> find_program(std::string_view name);
+
+// Write a file only if its content differs, so its timestamp only moves on real changes;
+// returns true if the file was written. Throws std::runtime_error if it cannot be written.
+bool write_file_if_changed(const std::filesystem::path& path, std::string_view content);
+
+// Quote a string as a CMake quoted argument
+[[nodiscard]] std::string cmake_quote(std::string_view value);
+
+// Quote a string as a JSON string
+[[nodiscard]] std::string json_quote(std::string_view text);
+
+// Point <project_root>/compile_commands.json at `database`, the compilation database clangd and
+// IDEs look for at the root. A symlink, or a copy where symlinks cannot be made; a regular file
+// that sail did not copy there is left alone. Does nothing if `database` does not exist.
+void link_compilation_database(const std::filesystem::path& database, const std::filesystem::path& project_root);
+
+// Spell a [build] pch entry the way both #include and target_precompile_headers() accept it:
+// <system> headers as they are, files that exist under the project root as an absolute quoted
+// path, and anything else as a quoted name found through the include path
+[[nodiscard]] std::string pch_include_spelling(const std::string& header, const std::filesystem::path& project_root);
+
+// List the translation units under src/, sorted so the list is stable
+[[nodiscard]] std::vector<std::filesystem::path> collect_sources(const std::filesystem::path& src_dir);
+
+// List the C++20 module interface units (.cppm, .ixx) under src/, sorted the same way
+[[nodiscard]] std::vector<std::filesystem::path> collect_module_sources(const std::filesystem::path& src_dir);
+
+// List the programs of tests/ or benches/: every .cpp directly in the directory, sorted; empty if it does not exist
+[[nodiscard]] std::vector<std::filesystem::path> collect_program_sources(const std::filesystem::path& programs_dir);
+
+// Whether a source is src/main.cpp or src/main.c, the one source test and bench programs are built without
+[[nodiscard]] bool is_main_source(const std::filesystem::path& source, const std::filesystem::path& src_dir);
+
+#endif
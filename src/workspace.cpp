@@ -0,0 +1,191 @@
+#include "workspace.hpp"
+#include "util.hpp"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Members a path dependency can point at, keyed by canonical directory
+using MemberIndex = std::map<std::filesystem::path, size_t>;
+
+std::filesystem::path path_dependency_dir(const WorkspaceMember& member, const DependencySpec& dependency) {
+  return std::filesystem::weakly_canonical(member.root / dependency.path);
+}
+
+std::vector<std::filesystem::path> expand_member_patterns(const WorkspaceSection& workspace,
+                                                          const std::filesystem::path& workspace_root) {
+  std::vector<std::filesystem::path> roots;
+  for (const auto& pattern : workspace.members) {
+    if (pattern.size() >= 2 && pattern.compare(pattern.size() - 2, 2, "/*") == 0) {
+      const std::filesystem::path parent = workspace_root / pattern.substr(0, pattern.size() - 2);
+      std::vector<std::filesystem::path> found;
+      if (std::filesystem::is_directory(parent)) {
+        for (const auto& entry : std::filesystem::directory_iterator(parent)) {
+          if (entry.is_directory() && std::filesystem::exists(entry.path() / "Sail.toml")) {
+            found.push_back(std::filesystem::weakly_canonical(entry.path()));
+          }
+        }
+      }
+      std::sort(found.begin(), found.end());
+      roots.insert(roots.end(), found.begin(), found.end());
+      continue;
+    }
+    const std::filesystem::path root = std::filesystem::weakly_canonical(workspace_root / pattern);
+    if (!std::filesystem::exists(root / "Sail.toml")) {
+      throw std::runtime_error(fmt::format("workspace member '{}' has no Sail.toml", pattern));
+    }
+    roots.push_back(root);
+  }
+  return roots;
+}
+
+bool same_source(const DependencySpec& lhs, const DependencySpec& rhs) {
+  return lhs.version == rhs.version && lhs.git == rhs.git && lhs.tag == rhs.tag && lhs.branch == rhs.branch
+         && lhs.rev == rhs.rev && lhs.path == rhs.path && lhs.options == rhs.options && lhs.targets == rhs.targets;
+}
+
+}// namespace
+
+std::vector<WorkspaceMember> load_workspace_members(const WorkspaceSection& workspace,
+                                                    const std::filesystem::path& workspace_root) {
+  std::vector<WorkspaceMember> members;
+  MemberIndex index;
+  std::map<std::string, std::filesystem::path> names;
+  for (const auto& root : expand_member_patterns(workspace, workspace_root)) {
+    if (index.count(root) != 0) {
+      continue;
+    }
+    WorkspaceMember member{ root, load_manifest(root) };
+    if (member.manifest.workspace) {
+      throw std::runtime_error(fmt::format("workspace member {} is a workspace itself", root.string()));
+    }
+    const std::string& name = member.manifest.project.name;
+    if (name.empty()) {
+      throw std::runtime_error(fmt::format("workspace member {} has no [project] name", root.string()));
+    }
+    if (const auto existing = names.find(name); existing != names.end()) {
+      throw std::runtime_error(fmt::format("workspace members {} and {} are both named '{}'",
+        existing->second.string(), root.string(), name));
+    }
+    names.emplace(name, root);
+    index.emplace(root, members.size());
+    members.push_back(std::move(member));
+  }
+
+  // Depth-first, so that each member is added after the members it links
+  std::vector<WorkspaceMember> ordered;
+  std::vector<int> state(members.size(), 0);
+  const auto visit = [&](const auto& self, size_t member_index) -> void {
+    if (state[member_index] == 2) {
+      return;
+    }
+    if (state[member_index] == 1) {
+      throw std::runtime_error(fmt::format("workspace member '{}' depends on itself through its path dependencies",
+        members[member_index].manifest.project.name));
+    }
+    state[member_index] = 1;
+    for (const auto& dependency : members[member_index].manifest.dependencies) {
+      if (dependency.path.empty()) {
+        continue;
+      }
+      const auto target = index.find(path_dependency_dir(members[member_index], dependency));
+      if (target != index.end()) {
+        self(self, target->second);
+      }
+    }
+    state[member_index] = 2;
+    ordered.push_back(members[member_index]);
+  };
+  for (size_t i = 0; i < members.size(); ++i) {
+    visit(visit, i);
+  }
+  return ordered;
+}
+
+Manifest merge_member_dependencies(const Manifest& workspace,
+                                   const std::vector<WorkspaceMember>& members,
+                                   const std::filesystem::path& workspace_root) {
+  MemberIndex index;
+  for (size_t i = 0; i < members.size(); ++i) {
+    index.emplace(members[i].root, i);
+  }
+
+  Manifest merged = workspace;
+  merged.dependencies.clear();
+  std::map<std::string, std::string> declared_by;
+  for (const auto& member : members) {
+    for (DependencySpec dependency : member.manifest.dependencies) {
+      if (!dependency.path.empty()) {
+        const std::filesystem::path dependency_dir = path_dependency_dir(member, dependency);
+        if (index.count(dependency_dir) != 0) {
+          continue;
+        }
+        dependency.path = dependency_dir.lexically_relative(std::filesystem::weakly_canonical(workspace_root)).generic_string();
+      }
+      const auto existing = std::find_if(merged.dependencies.begin(), merged.dependencies.end(),
+        [&](const DependencySpec& other) { return other.name == dependency.name; });
+      if (existing == merged.dependencies.end()) {
+        declared_by.emplace(dependency.name, member.manifest.project.name);
+        merged.dependencies.push_back(std::move(dependency));
+      } else if (!same_source(*existing, dependency)) {
+        throw std::runtime_error(fmt::format("workspace members '{}' and '{}' declare dependency '{}' differently",
+          declared_by[dependency.name], member.manifest.project.name, dependency.name));
+      } else {
+        existing->prebuilt = existing->prebuilt && dependency.prebuilt;
+      }
+    }
+  }
+  return merged;
+}
+
+std::filesystem::path member_target_dir(const std::filesystem::path& target_dir, const WorkspaceMember& member) {
+  return target_dir / "members" / member.manifest.project.name;
+}
+
+void write_workspace_manifest(const std::filesystem::path& target_dir,
+                              const std::vector<WorkspaceMember>& members,
+                              const std::vector<ResolvedDependency>& shared) {
+  MemberIndex index;
+  for (size_t i = 0; i < members.size(); ++i) {
+    index.emplace(members[i].root, i);
+  }
+
+  std::string content = "# Generated by sail from [workspace] in Sail.toml. Do not edit.\n";
+  for (const auto& member : members) {
+    const std::filesystem::path member_dir = member_target_dir(target_dir, member);
+    std::filesystem::create_directories(member_dir);
+
+    // Shared dependencies were added by the workspace root and members by earlier entries here;
+    // the member only has to know which targets to link
+    std::vector<ResolvedDependency> linked;
+    for (const auto& dependency : member.manifest.dependencies) {
+      if (!dependency.path.empty() && index.count(path_dependency_dir(member, dependency)) != 0) {
+        ResolvedDependency sibling;
+        sibling.name = dependency.name;
+        sibling.targets = dependency.targets;
+        linked.push_back(std::move(sibling));
+        continue;
+      }
+      const auto resolved = std::find_if(shared.begin(), shared.end(),
+        [&](const ResolvedDependency& candidate) { return candidate.name == dependency.name; });
+      if (resolved != shared.end()) {
+        linked.push_back(*resolved);
+      }
+    }
+    write_dependency_targets_manifest(member_dir / "dependencies.cmake", linked);
+
+    const BuildSection& build = member.manifest.build;
+    content += fmt::format("\n# {}\n", member.manifest.project.name);
+    content += fmt::format("set(SAIL_SOURCES_FILE {})\n", cmake_quote((member_dir / "sources.cmake").generic_string()));
+    content += fmt::format("set(SAIL_DEPENDENCIES_FILE {})\n", cmake_quote((member_dir / "dependencies.cmake").generic_string()));
+    content += fmt::format("set(CMAKE_UNITY_BUILD {})\nset(CMAKE_UNITY_BUILD_BATCH_SIZE {})\n", build.unity ? "ON" : "OFF", build.unity_batch_size);
+    content += fmt::format("add_subdirectory({} {})\n", cmake_quote(member.root.generic_string()),
+      cmake_quote("members/" + member.manifest.project.name));
+  }
+  content += "\nunset(SAIL_SOURCES_FILE)\nunset(SAIL_DEPENDENCIES_FILE)\nunset(CMAKE_UNITY_BUILD)\nunset(CMAKE_UNITY_BUILD_BATCH_SIZE)\n";
+  write_file_if_changed(target_dir / "workspace.cmake", content);
+}
@@ -0,0 +1,41 @@
+#ifndef SAIL_WORKSPACE_HPP
+#define SAIL_WORKSPACE_HPP
+
+#include "dependencies.hpp"
+#include "manifest.hpp"
+
+#include <filesystem>
+#include <vector>
+
+// A [workspace] member: a sail project built as part of the workspace's build tree
+struct WorkspaceMember
+{
+  std::filesystem::path root;
+  Manifest manifest;
+};
+
+// Load the projects listed in [workspace] members, ordered so that every member comes after the
+// members it has path dependencies on. Throws std::runtime_error for missing or duplicate members,
+// nested workspaces and dependency cycles between members.
+[[nodiscard]] std::vector<WorkspaceMember> load_workspace_members(const WorkspaceSection& workspace,
+                                                                  const std::filesystem::path& workspace_root);
+
+// The members' [dependencies] merged into `workspace` for resolve_dependencies(), so that every
+// dependency is fetched and built once and pinned in the workspace's Sail.lock. Paths are made
+// relative to the workspace root, and path dependencies on members are left out because the
+// members are in the build already. Throws std::runtime_error if two members declare the same
+// dependency differently.
+[[nodiscard]] Manifest merge_member_dependencies(const Manifest& workspace,
+                                                 const std::vector<WorkspaceMember>& members,
+                                                 const std::filesystem::path& workspace_root);
+
+// Where a member's generated files live: target/<mode>/members/<name>
+[[nodiscard]] std::filesystem::path member_target_dir(const std::filesystem::path& target_dir, const WorkspaceMember& member);
+
+// Write target/<mode>/workspace.cmake, which adds the members in order, and each member's
+// dependencies.cmake listing the targets it links from `shared` and from other members
+void write_workspace_manifest(const std::filesystem::path& target_dir,
+                              const std::vector<WorkspaceMember>& members,
+                              const std::vector<ResolvedDependency>& shared);
+
+#endif
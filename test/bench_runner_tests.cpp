@@ -0,0 +1,79 @@
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <vector>
+
+#include "bench_runner.hpp"
+
+
+TEST_CASE("Outliers beyond the Tukey fences are rejected", "[bench]")
+{
+  const BenchStatistics statistics = summarize_samples({ 100, 102, 98, 101, 99, 100, 400 });
+  CHECK(statistics.samples == 6);
+  CHECK(statistics.outliers == 1);
+  CHECK(statistics.mean == Catch::Approx(100));
+  CHECK(statistics.median == Catch::Approx(100));
+  CHECK(statistics.min == Catch::Approx(98));
+  CHECK(statistics.max == Catch::Approx(102));
+  CHECK(statistics.ci_low < statistics.mean);
+  CHECK(statistics.ci_high > statistics.mean);
+}
+
+TEST_CASE("A single sample has no spread", "[bench]")
+{
+  const BenchStatistics statistics = summarize_samples({ 42 });
+  CHECK(statistics.samples == 1);
+  CHECK(statistics.stddev == 0);
+  CHECK(statistics.ci_low == Catch::Approx(42));
+  CHECK(statistics.ci_high == Catch::Approx(42));
+}
+
+TEST_CASE("Student's t quantiles approach the normal one", "[bench]")
+{
+  CHECK(t_quantile_95(1) == Catch::Approx(12.706));
+  CHECK(t_quantile_95(9) == Catch::Approx(2.262));
+  CHECK(t_quantile_95(9.7) == Catch::Approx(2.262));
+  CHECK(t_quantile_95(1000) < 1.97);
+  CHECK(t_quantile_95(1000) > 1.96);
+}
+
+TEST_CASE("Only changes beyond the noise are reported", "[bench]")
+{
+  const BenchStatistics baseline = summarize_samples({ 100, 101, 99, 100, 102, 98 });
+  const BenchStatistics slower = summarize_samples({ 120, 121, 119, 120, 122, 118 });
+  const BenchStatistics faster = summarize_samples({ 80, 81, 79, 80, 82, 78 });
+  const BenchStatistics same = summarize_samples({ 101, 100, 99, 100, 98, 102 });
+
+  const BenchComparison regression = compare_to_baseline(baseline, slower);
+  CHECK(regression.verdict == BenchVerdict::Regressed);
+  CHECK(regression.change == Catch::Approx(0.2));
+  CHECK(regression.ci_low < 0.2);
+  CHECK(regression.ci_high > 0.2);
+  CHECK(compare_to_baseline(baseline, faster).verdict == BenchVerdict::Improved);
+  CHECK(compare_to_baseline(baseline, same).verdict == BenchVerdict::Unchanged);
+
+  // A change within a noisy baseline's confidence interval is no change
+  const BenchStatistics noisy = summarize_samples({ 60, 140, 80, 120, 100, 100 });
+  CHECK(compare_to_baseline(noisy, slower).verdict == BenchVerdict::Unchanged);
+}
+
+TEST_CASE("Bench results survive a round trip through their JSON file", "[bench]")
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "sail_bench_results_test";
+  std::filesystem::remove_all(directory);
+  const std::filesystem::path path = directory / "main.json";
+
+  const std::vector<double> samples = { 1500, 1520, 1480, 1510 };
+  write_bench_results(path, { BenchResult{ "parse \"big\" file", summarize_samples(samples), samples },
+                              BenchResult{ "lex", summarize_samples({ 10 }), { 10 } } });
+  const std::vector<BenchResult> results = read_bench_results(path);
+  REQUIRE(results.size() == 2);
+  CHECK(results[0].name == "parse \"big\" file");
+  CHECK(results[0].statistics.samples == 4);
+  CHECK(results[0].statistics.mean == Catch::Approx(1502.5));
+  CHECK(results[0].statistics.stddev == Catch::Approx(summarize_samples(samples).stddev).margin(0.1));
+  CHECK(results[1].name == "lex");
+  CHECK(results[1].statistics.mean == Catch::Approx(10));
+  CHECK(read_bench_results(directory / "missing.json").empty());
+}
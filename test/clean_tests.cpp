@@ -0,0 +1,110 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "clean.hpp"
+
+
+namespace {
+
+std::filesystem::path make_test_dir(const char* name)
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  return directory;
+}
+
+void write_bytes(const std::filesystem::path& path, size_t size)
+{
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream(path, std::ios::binary) << std::string(size, 'x');
+}
+
+}// namespace
+
+TEST_CASE("Cache sizes are read with binary suffixes", "[clean]")
+{
+  CHECK(parse_byte_size("512") == 512U);
+  CHECK(parse_byte_size("512M") == 512ULL << 20U);
+  CHECK(parse_byte_size("10g") == 10ULL << 30U);
+  CHECK(parse_byte_size("1.5GiB") == 3ULL << 29U);
+  CHECK(parse_byte_size("2KB") == 2048U);
+  CHECK_FALSE(parse_byte_size("").has_value());
+  CHECK_FALSE(parse_byte_size("G").has_value());
+  CHECK_FALSE(parse_byte_size("10X").has_value());
+  CHECK_FALSE(parse_byte_size("1.2.3M").has_value());
+
+  CHECK(format_bytes(100) == "100 B");
+  CHECK(format_bytes(3ULL << 29U) == "1.50 GiB");
+}
+
+TEST_CASE("Only the objects of deleted sources are orphaned", "[clean]")
+{
+  const std::filesystem::path project = make_test_dir("sail_clean_orphans_test");
+  write_bytes(project / "src" / "main.cpp", 1);
+  write_bytes(project / "tests" / "kept.cpp", 1);
+  const std::filesystem::path mode_dir = project / "target" / "debug";
+  const std::filesystem::path obj = mode_dir / "obj";
+  write_bytes(obj / "main.cpp.o", 10);
+  write_bytes(obj / "main.cpp.d", 10);
+  write_bytes(obj / "gone.cpp.o", 10);
+  write_bytes(obj / "gone.cpp.d", 10);
+  write_bytes(obj / "compile.fingerprint", 10);
+  write_bytes(obj / "unity" / "unity_0.cpp.o", 10);
+  write_bytes(obj / "tests" / "kept.cpp.o", 10);
+  write_bytes(obj / "tests" / "kept.link.fingerprint", 10);
+  write_bytes(obj / "tests" / "dropped.cpp.o", 10);
+  write_bytes(obj / "tests" / "dropped.link.fingerprint", 10);
+  write_bytes(mode_dir / "tests" / "kept", 10);
+  write_bytes(mode_dir / "tests" / "dropped", 10);
+  const std::filesystem::path cmake_objects = mode_dir / "build" / "CMakeFiles" / "app.dir";
+  write_bytes(cmake_objects / "src" / "main.cpp.o", 10);
+  write_bytes(cmake_objects / "src" / "gone.cpp.o", 10);
+  write_bytes(cmake_objects / "src" / "gone.cpp.o.d", 10);
+  // Sources of a dependency built in the tree are not the project's to judge
+  write_bytes(mode_dir / "build" / "_deps" / "fmt-build" / "CMakeFiles" / "fmt.dir" / "src" / "format.cc.o", 10);
+
+  const Reclaimed reclaimed = remove_orphaned_objects(project, mode_dir);
+  CHECK(reclaimed.files == 7U);
+  CHECK(reclaimed.bytes == 70U);
+  CHECK_FALSE(std::filesystem::exists(obj / "gone.cpp.o"));
+  CHECK_FALSE(std::filesystem::exists(obj / "tests" / "dropped.link.fingerprint"));
+  CHECK_FALSE(std::filesystem::exists(mode_dir / "tests" / "dropped"));
+  CHECK_FALSE(std::filesystem::exists(cmake_objects / "src" / "gone.cpp.o.d"));
+  CHECK(std::filesystem::exists(obj / "main.cpp.o"));
+  CHECK(std::filesystem::exists(obj / "compile.fingerprint"));
+  CHECK(std::filesystem::exists(obj / "unity" / "unity_0.cpp.o"));
+  CHECK(std::filesystem::exists(obj / "tests" / "kept.link.fingerprint"));
+  CHECK(std::filesystem::exists(mode_dir / "tests" / "kept"));
+  CHECK(std::filesystem::exists(cmake_objects / "src" / "main.cpp.o"));
+  CHECK(std::filesystem::exists(mode_dir / "build" / "_deps" / "fmt-build" / "CMakeFiles" / "fmt.dir" / "src" / "format.cc.o"));
+  std::filesystem::remove_all(project);
+}
+
+TEST_CASE("Caches are evicted least recently used first", "[clean]")
+{
+  const std::filesystem::path cache = make_test_dir("sail_clean_eviction_test");
+  const auto now = std::filesystem::file_time_type::clock::now();
+  for (const auto& [name, age] : { std::pair{ "old", 3 }, std::pair{ "recent", 1 }, std::pair{ "older", 4 } }) {
+    write_bytes(cache / name / "lib.a", 100);
+    std::filesystem::last_write_time(cache / name, now - std::chrono::hours(age));
+  }
+  write_bytes(cache / "key.tmp-1234" / "lib.a", 100);
+
+  const Reclaimed evicted = evict_least_recently_used(cache, 150, EvictionUnit::Entries);
+  CHECK(evicted.files == 2U);
+  CHECK(evicted.bytes == 200U);
+  CHECK(std::filesystem::exists(cache / "recent"));
+  CHECK_FALSE(std::filesystem::exists(cache / "old"));
+  CHECK_FALSE(std::filesystem::exists(cache / "older"));
+  // Still being filled by another sail
+  CHECK(std::filesystem::exists(cache / "key.tmp-1234"));
+
+  CHECK(evict_least_recently_used(cache, 1000, EvictionUnit::Files).files == 0U);
+  CHECK(evict_least_recently_used(cache, 0, EvictionUnit::Files).files == 2U);
+  std::filesystem::remove_all(cache);
+}
@@ -10,3 +10,27 @@ TEST_CASE("Factorials are computed with constexpr", "[factorial]")
   STATIC_REQUIRE(factorial_constexpr(3) == 6);
   STATIC_REQUIRE(factorial_constexpr(10) == 3628800);
 }
+
+TEST_CASE("The factorial table is built at compile time", "[factorial]")
+{
+  STATIC_REQUIRE(factorial_table[0] == 1);
+  STATIC_REQUIRE(factorial_table[12] == 479001600);
+  STATIC_REQUIRE(factorial_table[20] == 2432902008176640000ULL);
+  STATIC_REQUIRE(factorial_constexpr(-1) == 0);
+  STATIC_REQUIRE(factorial_constexpr(12) == 479001600);
+  STATIC_REQUIRE(factorial_constexpr(13) == 0);
+  STATIC_REQUIRE(factorial_constexpr(1000) == 0);
+}
+
+TEST_CASE("Checked factorials report overflow", "[factorial]")
+{
+  STATIC_REQUIRE(factorial_checked(5) == 120U);
+  STATIC_REQUIRE(factorial_checked(20) == 2432902008176640000ULL);
+  STATIC_REQUIRE_FALSE(factorial_checked(21).has_value());
+  STATIC_REQUIRE_FALSE(factorial_checked(-1).has_value());
+#ifdef __SIZEOF_INT128__
+  STATIC_REQUIRE(factorial_checked_wide(21) == factorial_uint128{ 21 } * 2432902008176640000ULL);
+  STATIC_REQUIRE(factorial_checked_wide(34).has_value());
+  STATIC_REQUIRE_FALSE(factorial_checked_wide(35).has_value());
+#endif
+}
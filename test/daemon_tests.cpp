@@ -0,0 +1,143 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "daemon.hpp"
+
+#ifndef _WIN32
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+
+namespace {
+
+std::filesystem::path make_test_dir(const char* name)
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  return std::filesystem::canonical(directory);
+}
+
+// Start a daemon in a child process whose commands write their arguments, working directory and
+// SAIL_DAEMON_TEST to command.txt and exit with 7
+pid_t start_daemon(const std::filesystem::path& socket_path)
+{
+  const pid_t pid = fork();
+  if (pid == 0) {
+    DaemonHandlers handlers;
+    handlers.run = [](const std::vector<std::string>& args) {
+      std::ofstream file("command.txt");
+      for (const auto& arg : args) {
+        file << arg << '\n';
+      }
+      const char* variable = std::getenv("SAIL_DAEMON_TEST");// NOLINT(concurrency-mt-unsafe)
+      file << std::filesystem::current_path().string() << '\n' << (variable != nullptr ? variable : "unset") << '\n';
+      return 7;
+    };
+    _exit(serve_daemon(socket_path, handlers));
+  }
+  for (int attempt = 0; attempt < 500 && !std::filesystem::is_socket(socket_path); ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return pid;
+}
+
+// Connect to the daemon without sending anything
+int connect_silently(const std::filesystem::path& socket_path)
+{
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  REQUIRE(connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+  return fd;
+}
+
+}// namespace
+
+TEST_CASE("Commands are carried out by the daemon with the client's directory and environment", "[daemon]")
+{
+  const std::filesystem::path directory = make_test_dir("sail_daemon_test");
+  const std::filesystem::path socket_path = daemon_socket_path(directory);
+  REQUIRE(socket_path == directory / "target" / "daemon.sock");
+  REQUIRE_FALSE(forward_to_daemon(socket_path, { "build" }));
+
+  const pid_t daemon = start_daemon(socket_path);
+  REQUIRE(std::filesystem::is_socket(socket_path));
+
+  const std::filesystem::path previous_directory = std::filesystem::current_path();
+  std::filesystem::current_path(directory);
+  setenv("SAIL_DAEMON_TEST", "forwarded", 1);// NOLINT(concurrency-mt-unsafe)
+  const auto exit_code = forward_to_daemon(socket_path, { "build", "--release", "" });
+  unsetenv("SAIL_DAEMON_TEST");// NOLINT(concurrency-mt-unsafe)
+  std::filesystem::current_path(previous_directory);
+
+  REQUIRE(exit_code == 7);
+  std::ifstream file(directory / "command.txt");
+  const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  REQUIRE(content == "build\n--release\n\n" + directory.string() + "\nforwarded\n");
+
+  REQUIRE(stop_daemon(socket_path));
+  int status = 0;
+  REQUIRE(waitpid(daemon, &status, 0) == daemon);
+  REQUIRE(WIFEXITED(status));
+  REQUIRE(WEXITSTATUS(status) == EXIT_SUCCESS);
+  REQUIRE_FALSE(std::filesystem::exists(socket_path));
+  REQUIRE_FALSE(stop_daemon(socket_path));
+}
+
+TEST_CASE("A daemon does not start where another one listens, and replaces a stale socket", "[daemon]")
+{
+  const std::filesystem::path directory = make_test_dir("sail_daemon_stale_test");
+  const std::filesystem::path socket_path = daemon_socket_path(directory);
+  std::filesystem::create_directories(socket_path.parent_path());
+  std::ofstream(socket_path) << "left behind";
+
+  const pid_t daemon = start_daemon(socket_path);
+  REQUIRE(serve_daemon(socket_path, DaemonHandlers{}) == EXIT_FAILURE);
+  REQUIRE(stop_daemon(socket_path));
+  int status = 0;
+  REQUIRE(waitpid(daemon, &status, 0) == daemon);
+  REQUIRE(WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+TEST_CASE("A client that connects and sends nothing holds up no other client", "[daemon]")
+{
+  const std::filesystem::path directory = make_test_dir("sail_daemon_stall_test");
+  const std::filesystem::path socket_path = daemon_socket_path(directory);
+  const pid_t daemon = start_daemon(socket_path);
+  const int stalled = connect_silently(socket_path);
+
+  const std::filesystem::path previous_directory = std::filesystem::current_path();
+  std::filesystem::current_path(directory);
+  const auto started = std::chrono::steady_clock::now();
+  const auto exit_code = forward_to_daemon(socket_path, { "build" });
+  const auto waited = std::chrono::steady_clock::now() - started;
+  std::filesystem::current_path(previous_directory);
+  REQUIRE(exit_code == 7);
+  REQUIRE(waited < std::chrono::seconds(1));
+
+  // The daemon gives up on the silent client, closing its connection
+  char byte = 0;
+  REQUIRE(read(stalled, &byte, 1) == 0);
+  close(stalled);
+
+  REQUIRE(stop_daemon(socket_path));
+  int status = 0;
+  REQUIRE(waitpid(daemon, &status, 0) == daemon);
+  REQUIRE(WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+#endif
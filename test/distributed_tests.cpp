@@ -0,0 +1,64 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "distributed.hpp"
+#include "util.hpp"
+
+
+#ifndef _WIN32
+namespace {
+
+// A directory holding empty stand-ins for the backends, to put on PATH
+std::filesystem::path make_fake_backends(const char* name)
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  for (const std::string backend : { "distcc", "icecc", "recc", "ccache" }) {
+    std::ofstream(directory / backend) << "";
+  }
+  return directory;
+}
+
+}// namespace
+
+TEST_CASE("Distributed backends are put in front of the compiler", "[distributed]")
+{
+  const std::filesystem::path backends = make_fake_backends("sail_distributed_test");
+  const std::string saved_path = get_env("PATH");
+  setenv("PATH", backends.c_str(), 1);// NOLINT(concurrency-mt-unsafe)
+
+  DistributedSection distcc{ "distcc", "farm1/32 farm2/32", std::nullopt, std::nullopt, std::nullopt };
+  const DistributedCompilation alone = resolve_distributed(distcc, "", 8);
+  CHECK(alone.launcher == (backends / "distcc").string());
+  CHECK(alone.jobs == 32U);
+  CHECK(alone.environment == std::vector<std::pair<std::string, std::string>>{ { "DISTCC_HOSTS", "farm1/32 farm2/32" } });
+
+  // Behind ccache, only the objects ccache does not have go to the farm
+  distcc.jobs = 200;
+  const DistributedCompilation cached = resolve_distributed(distcc, (backends / "ccache").string(), 8);
+  CHECK(cached.launcher == (backends / "ccache").string());
+  CHECK(cached.jobs == 200U);
+  CHECK(cached.environment.front() == std::pair<std::string, std::string>{ "CCACHE_PREFIX", (backends / "distcc").string() });
+
+  const DistributedSection recc{ "recc", std::nullopt, "http://farm:8980", "main", std::nullopt };
+  const DistributedCompilation remote = resolve_distributed(recc, (backends / "ccache").string(), 2);
+  CHECK(remote.launcher == (backends / "recc").string());
+  CHECK(remote.environment == std::vector<std::pair<std::string, std::string>>{ { "RECC_SERVER", "http://farm:8980" }, { "RECC_INSTANCE", "main" } });
+
+  CHECK_THROWS_AS(resolve_distributed(DistributedSection{ "sccache", {}, {}, {}, {} }, "", 8), std::runtime_error);
+
+  setenv("PATH", saved_path.c_str(), 1);// NOLINT(concurrency-mt-unsafe)
+  std::filesystem::remove_all(backends);
+}
+#endif
+
+TEST_CASE("Links keep to the local cores in a distributed CMake build", "[distributed]")
+{
+  REQUIRE(distributed_cmake_code(6) == "set_property(GLOBAL APPEND PROPERTY JOB_POOLS sail_link=6)\nset(CMAKE_JOB_POOL_LINK sail_link)\n");
+}
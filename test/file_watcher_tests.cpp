@@ -0,0 +1,64 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "file_watcher.hpp"
+
+
+namespace {
+
+std::filesystem::path make_test_dir(const char* name)
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory / "src");
+  std::ofstream(directory / "Sail.toml") << "[project]\nname = \"watched\"\n";
+  std::ofstream(directory / "notes.txt") << "not watched\n";
+  return std::filesystem::absolute(directory);
+}
+
+bool contains(const std::vector<std::filesystem::path>& paths, const std::filesystem::path& path)
+{
+  return std::find(paths.begin(), paths.end(), path) != paths.end();
+}
+
+constexpr std::chrono::milliseconds timeout{ 5000 };
+constexpr std::chrono::milliseconds quiet_period{ 100 };
+
+}// namespace
+
+TEST_CASE("New and changed sources anywhere below a watched directory are reported", "[watch]")
+{
+  const std::filesystem::path directory = make_test_dir("sail_watch_tree_test");
+  FileWatcher watcher({ directory / "src", directory / "Sail.toml" });
+
+  std::ofstream(directory / "src" / "main.cpp") << "int main() { return 0; }\n";
+  const auto changes = watcher.wait_for_changes(timeout, quiet_period);
+  REQUIRE(contains(changes, directory / "src" / "main.cpp"));
+}
+
+TEST_CASE("Only the named file of a directory watched for a single file is reported", "[watch]")
+{
+  const std::filesystem::path directory = make_test_dir("sail_watch_file_test");
+  FileWatcher watcher({ directory / "src", directory / "Sail.toml" });
+
+  std::ofstream(directory / "notes.txt") << "changed\n";
+  std::ofstream(directory / "Sail.toml", std::ios::app) << "[build]\n";
+  const auto changes = watcher.wait_for_changes(timeout, quiet_period);
+  REQUIRE(contains(changes, directory / "Sail.toml"));
+  REQUIRE_FALSE(contains(changes, directory / "notes.txt"));
+}
+
+TEST_CASE("Hidden files and editor backups are ignored", "[watch]")
+{
+  const std::filesystem::path directory = make_test_dir("sail_watch_ignored_test");
+  FileWatcher watcher({ directory / "src" });
+
+  std::ofstream(directory / "src" / ".main.cpp.swp") << "swap\n";
+  std::ofstream(directory / "src" / "main.cpp~") << "backup\n";
+  REQUIRE(watcher.wait_for_changes(std::chrono::milliseconds(600), quiet_period).empty());
+}
@@ -0,0 +1,291 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "manifest.hpp"
+#include "profiles.hpp"
+#include "toml.hpp"
+
+
+TEST_CASE("TOML scalars are parsed", "[toml]")
+{
+  const TomlValue document = parse_toml(R"(
+title = "sail" # trailing comment
+literal = 'C:\path'
+escaped = "tab\there \u00e9"
+count = 1_000
+hex = 0xff
+ratio = 0.5
+enabled = true
+)");
+
+  REQUIRE(document.find("title")->string == "sail");
+  REQUIRE(document.find("literal")->string == "C:\\path");
+  REQUIRE(document.find("escaped")->string == "tab\there \xc3\xa9");
+  REQUIRE(document.find("count")->integer == 1000);
+  REQUIRE(document.find("hex")->integer == 255);
+  REQUIRE(document.find("ratio")->floating == 0.5);
+  REQUIRE(document.find("enabled")->boolean);
+}
+
+TEST_CASE("TOML tables, arrays and inline tables are parsed", "[toml]")
+{
+  const TomlValue document = parse_toml(R"(
+[profile.release]
+lto = "thin"
+
+[build]
+pch = [
+  "<vector>", # comment inside an array
+  "fmt/format.h",
+]
+
+[dependencies]
+fmt = { git = "https://github.com/fmtlib/fmt", tag = "11.1.4" }
+
+[[bin]]
+name = "first"
+
+[[bin]]
+name = "second"
+)");
+
+  REQUIRE(document.find_path("profile.release.lto")->string == "thin");
+  REQUIRE(document.find_path("build.pch")->array.size() == 2);
+  REQUIRE(document.find_path("dependencies.fmt.tag")->string == "11.1.4");
+  REQUIRE(document.find("bin")->array.size() == 2);
+  REQUIRE(document.find("bin")->array[1].find("name")->string == "second");
+}
+
+TEST_CASE("Malformed TOML is rejected", "[toml]")
+{
+  REQUIRE_THROWS_AS(parse_toml("name = \"unterminated\n"), TomlParseError);
+  REQUIRE_THROWS_AS(parse_toml("a = 1\na = 2\n"), TomlParseError);
+  REQUIRE_THROWS_AS(parse_toml("[table\n"), TomlParseError);
+  REQUIRE_THROWS_AS(parse_toml("key = 1 2\n"), TomlParseError);
+  REQUIRE_THROWS_AS(parse_toml("[build]\njobs = 2\n[build]\nunity = true\n"), TomlParseError);
+  REQUIRE_THROWS_AS(parse_toml("x = " + std::string(100, '[') + std::string(100, ']') + "\n"), TomlParseError);
+  std::string nested_tables = "x = ";
+  for (int level = 0; level < 100; ++level) {
+    nested_tables += "{ a = ";
+  }
+  nested_tables += "1" + std::string(100, '}') + "\n";
+  REQUIRE_THROWS_AS(parse_toml(nested_tables), TomlParseError);
+
+  // A table created by the headers below it may still get its own, and every array element its subtables
+  REQUIRE_NOTHROW(parse_toml("[profile.dev]\nopt-level = 1\n[profile]\n"));
+  REQUIRE_NOTHROW(parse_toml("[[package]]\n[package.meta]\n[[package]]\n[package.meta]\n"));
+  REQUIRE_NOTHROW(parse_toml("x = " + std::string(64, '[') + std::string(64, ']') + "\n"));
+
+  try {
+    static_cast<void>(parse_toml("\nkey = \n", "member/Sail.toml"));
+    FAIL("no error");
+  } catch (const TomlParseError& error) {
+    REQUIRE(std::string(error.what()).rfind("member/Sail.toml:2: ", 0) == 0);
+  }
+}
+
+TEST_CASE("Manifests are mapped to typed sections", "[manifest]")
+{
+  const Manifest manifest = manifest_from_toml(parse_toml(R"(
+[project]
+name="compact"
+version = "1.2.0"
+
+[dependencies]
+name = "3.0.0"
+spdlog = { git = "https://github.com/gabime/spdlog", tag = "v1.15.2" }
+
+[build]
+jobs = 8
+engine = "native"
+linker = "mold"
+std = 20
+unity = true
+unity-batch-size = 16
+pch = ["<vector>", "fmt/format.h"]
+)"));
+
+  REQUIRE(manifest.project.name == "compact");
+  REQUIRE(manifest.project.version == "1.2.0");
+  REQUIRE(manifest.dependencies.size() == 2);
+  REQUIRE(manifest.dependencies[0].name == "name");
+  REQUIRE(manifest.dependencies[0].version == "3.0.0");
+  REQUIRE(manifest.dependencies[1].git == "https://github.com/gabime/spdlog");
+  REQUIRE(manifest.build.jobs == 8U);
+  REQUIRE(manifest.build.engine == "native");
+  REQUIRE(manifest.build.cxx_standard == 20U);
+  REQUIRE(manifest.build.linker == "mold");
+  REQUIRE(manifest.build.unity);
+  REQUIRE(manifest.build.unity_batch_size == 16U);
+  REQUIRE(manifest.build.pch == std::vector<std::string>{ "<vector>", "fmt/format.h" });
+  REQUIRE_FALSE(manifest.build.generator.has_value());
+}
+
+TEST_CASE("Dependency tables accept targets and options", "[manifest]")
+{
+  const Manifest manifest = manifest_from_toml(parse_toml(R"(
+[dependencies]
+spdlog = { git = "https://github.com/gabime/spdlog", tag = "v1.15.2", targets = ["spdlog::spdlog"], options = { SPDLOG_FMT_EXTERNAL = true } }
+local = { path = "../local", prebuilt = false }
+)"));
+
+  REQUIRE(manifest.dependencies[0].targets == std::vector<std::string>{ "spdlog::spdlog" });
+  REQUIRE(manifest.dependencies[0].options.size() == 1);
+  REQUIRE(manifest.dependencies[0].options[0].second == "ON");
+  REQUIRE(manifest.dependencies[0].prebuilt);
+  REQUIRE(manifest.dependencies[1].path == "../local");
+  REQUIRE_FALSE(manifest.dependencies[1].prebuilt);
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[dependencies]\nx = { git = \"u\", tag = \"a\", branch = \"b\" }\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[dependencies]\nx = { git = \"u\", rev = \"abc1234\" }\n")));
+}
+
+TEST_CASE("Profiles map to optimization settings", "[manifest]")
+{
+  const Manifest manifest = manifest_from_toml(parse_toml(R"(
+[profile.dev]
+opt-level = 1
+
+[profile.release]
+lto = true
+opt-level = "s"
+target-cpu = "native"
+)"));
+
+  REQUIRE(manifest.dev_profile.opt_level == "1");
+  REQUIRE_FALSE(manifest.dev_profile.lto.has_value());
+  REQUIRE(manifest.release_profile.lto == "full");
+  REQUIRE(manifest.release_profile.opt_level == "s");
+  REQUIRE(manifest.release_profile.target_cpu == "native");
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[profile.release]\nlto = \"fat\"\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[profile.release]\nopt-level = 4\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[profile.debug]\nopt-level = 3\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[profile.dev]\ninherits = \"release\"\n")));
+}
+
+TEST_CASE("Custom profiles inherit and add sanitizers or hardening", "[manifest]")
+{
+  const Manifest manifest = manifest_from_toml(parse_toml(R"(
+[profile.release]
+opt-level = 3
+
+[profile.fuzz]
+sanitizers = ["address", "undefined"]
+
+[profile.production]
+inherits = "release"
+hardening = true
+
+[profile.asan]
+opt-level = 1
+)"));
+
+  const BuildProfile fuzz = resolve_build_profile(manifest, "fuzz");
+  CHECK_FALSE(fuzz.release);
+  CHECK(fuzz.directory == "fuzz");
+  CHECK(fuzz.settings.sanitizers == std::vector<std::string>{ "address", "undefined" });
+
+  const BuildProfile production = resolve_build_profile(manifest, "production");
+  CHECK(production.release);
+  CHECK(production.settings.opt_level == "3");
+  CHECK(production.settings.hardening == true);
+
+  // Built-in profiles need no table, and a table adjusts them
+  const BuildProfile asan = resolve_build_profile(manifest, "asan");
+  CHECK(asan.settings.sanitizers == std::vector<std::string>{ "address", "undefined" });
+  CHECK(asan.settings.opt_level == "1");
+  CHECK(resolve_build_profile(manifest, "hardened").release);
+  CHECK(resolve_build_profile(manifest, "dev").directory == "debug");
+  CHECK_THROWS(resolve_build_profile(manifest, "staging"));
+
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[profile.race]\nsanitizers = [\"thread\", \"address\"]\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[profile.x]\nsanitizers = [\"bounds\"]\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[profile.x]\ninherits = \"asan\"\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[profile.Big]\nopt-level = 1\n")));
+}
+
+TEST_CASE("Sanitizer and hardening profiles reach the CMake build", "[manifest]")
+{
+  ProfileSection profile;
+  profile.sanitizers = std::vector<std::string>{ "address" };
+  profile.hardening = true;
+  const std::string code = profile_cmake_code(profile, PgoMode::None, {});
+  CHECK(code.find("add_compile_options(-fsanitize=address)") != std::string::npos);
+  CHECK(code.find("add_compile_definitions(_GLIBCXX_ASSERTIONS)") != std::string::npos);
+  CHECK(code.find("/fsanitize=address") != std::string::npos);
+
+  const ProfileFlags release = profile_flags(profile, PgoMode::None, {}, false, true);
+  CHECK(std::find(release.link.begin(), release.link.end(), "-fsanitize=address") != release.link.end());
+  CHECK(std::find(release.compile.begin(), release.compile.end(), "-D_FORTIFY_SOURCE=3") != release.compile.end());
+  const ProfileFlags debug = profile_flags(profile, PgoMode::None, {}, false, false);
+  CHECK(std::find(debug.compile.begin(), debug.compile.end(), "-D_FORTIFY_SOURCE=3") == debug.compile.end());
+}
+
+TEST_CASE("Distributed compilation names a backend and its settings", "[manifest]")
+{
+  REQUIRE(manifest_from_toml(parse_toml("[build]\ndistributed = \"icecc\"\n")).build.distributed->backend == "icecc");
+  REQUIRE_FALSE(manifest_from_toml(parse_toml("[build]\njobs = 4\n")).build.distributed);
+
+  const Manifest manifest = manifest_from_toml(parse_toml(R"([build.distributed]
+backend = "recc"
+endpoint = "http://farm:8980"
+instance = "main"
+jobs = 256
+)"));
+  REQUIRE(manifest.build.distributed->backend == "recc");
+  REQUIRE(manifest.build.distributed->endpoint == "http://farm:8980");
+  REQUIRE(manifest.build.distributed->instance == "main");
+  REQUIRE(manifest.build.distributed->jobs == 256U);
+
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[build]\ndistributed = \"goma\"\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[build]\ndistributed = true\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[build]\ndistributed = { backend = \"icecc\", hosts = \"a b\" }\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[build]\ndistributed = { backend = \"distcc\", endpoint = \"http://farm\" }\n")));
+}
+
+TEST_CASE("Workspace roots list their members", "[manifest]")
+{
+  const Manifest manifest = manifest_from_toml(parse_toml("[workspace]\nmembers = [\"apps/*\", \"lib\"]\n"));
+  REQUIRE(manifest.workspace.has_value());
+  REQUIRE(manifest.workspace->members == std::vector<std::string>{ "apps/*", "lib" });
+  REQUIRE_FALSE(manifest_from_toml(parse_toml("[project]\nname = \"app\"\n")).workspace.has_value());
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[project]\nname = \"app\"\n\n[workspace]\nmembers = []\n")));
+}
+
+TEST_CASE("Manifest type errors are reported", "[manifest]")
+{
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[build]\njobs = \"four\"\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[build]\njobs = 0\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[build]\nprebuilt = \"yes\"\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[build]\nstd = 19\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[build]\nlinker = \"link.exe\"\n")));
+  REQUIRE_THROWS(manifest_from_toml(parse_toml("[dependencies]\nfmt = {}\n")));
+}
+
+TEST_CASE("Parsed manifests are cached under target", "[manifest]")
+{
+  const std::filesystem::path project_root = std::filesystem::temp_directory_path() / "sail_manifest_cache_test";
+  std::filesystem::remove_all(project_root);
+  std::filesystem::create_directories(project_root);
+  {
+    std::ofstream toml_file(project_root / "Sail.toml");
+    toml_file << "[project]\nname = \"cached\"\n";
+  }
+
+  REQUIRE(load_manifest(project_root).project.name == "cached");
+  REQUIRE(std::filesystem::exists(project_root / "target" / "manifest.cache"));
+  REQUIRE(load_manifest(project_root).project.name == "cached");
+
+  // A changed manifest must not be served from the stale snapshot
+  {
+    std::ofstream toml_file(project_root / "Sail.toml");
+    toml_file << "[project]\nname = \"renamed\"\n";
+  }
+  REQUIRE(load_manifest(project_root).project.name == "renamed");
+
+  std::filesystem::remove_all(project_root);
+}
@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+#include "modules.hpp"
+
+
+TEST_CASE("Module interface units provide their module", "[modules]")
+{
+  const ModuleUnit unit = scan_module_unit("module;\n#include <vector>\nexport module math;\nexport import :detail;\nimport util;\nexport int square(int x) { return x * x; }\n");
+  REQUIRE(unit.is_module_unit);
+  REQUIRE(unit.provides == "math");
+  REQUIRE(unit.imports == std::vector<std::string>{ "math:detail", "util" });
+}
+
+TEST_CASE("Partitions and implementation units are told apart", "[modules]")
+{
+  const ModuleUnit partition = scan_module_unit("export module math : detail;\n");
+  REQUIRE(partition.provides == "math:detail");
+  REQUIRE(partition.imports.empty());
+
+  const ModuleUnit implementation = scan_module_unit("module math;\nint square(int x) { return x * x; }\nmodule :private;\n");
+  REQUIRE(implementation.is_module_unit);
+  REQUIRE(implementation.provides.empty());
+  REQUIRE(implementation.imports == std::vector<std::string>{ "math" });
+}
+
+TEST_CASE("Comments, literals, header units and identifiers named module are ignored", "[modules]")
+{
+  const ModuleUnit unit = scan_module_unit(
+    "// import commented;\n"
+    "/* import\nblock; */\n"
+    "import <vector>;\n"
+    "import \"local.hpp\";\n"
+    "const char* text = \"import quoted;\";\n"
+    "const char* raw = R\"(\nimport raw;\n)\";\n"
+    "int module = 1;\n"
+    "module = 2;\n"
+    "import std;\n");
+  REQUIRE_FALSE(unit.is_module_unit);
+  REQUIRE(unit.imports == std::vector<std::string>{ "std" });
+}
+
+TEST_CASE("BMI names of partitions avoid ':'", "[modules]")
+{
+  REQUIRE(module_bmi_stem("math") == "math");
+  REQUIRE(module_bmi_stem("math:detail") == "math-detail");
+}
@@ -0,0 +1,103 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "process.hpp"
+
+
+namespace {
+
+const std::string cmake_command = SAIL_TEST_CMAKE_COMMAND;
+
+}// namespace
+
+TEST_CASE("Arguments reach the child without a shell", "[process]")
+{
+  const auto output = run_capture({ cmake_command, "-E", "echo", "two words", "$HOME", "a;b" });
+  REQUIRE(output);
+  REQUIRE(output->find("two words $HOME a;b") != std::string::npos);
+}
+
+TEST_CASE("Exit codes are reported", "[process]")
+{
+  const ProcessResult failed = run_process({ cmake_command, "-E", "false" }, ProcessOptions{ ProcessOutput::Capture });
+  REQUIRE_FALSE(failed.success());
+  REQUIRE(failed.exit_code != 0);
+  REQUIRE_FALSE(failed.timed_out);
+  REQUIRE_FALSE(run_capture({ cmake_command, "-E", "false" }));
+}
+
+TEST_CASE("Missing programs are an error, not a crash", "[process]")
+{
+  const ProcessResult result = run_process({ "sail-test-no-such-program" }, ProcessOptions{ ProcessOutput::Capture });
+  REQUIRE_FALSE(result.success());
+  REQUIRE_FALSE(result.error.empty());
+}
+
+TEST_CASE("Children that run too long are killed", "[process]")
+{
+  const auto start = std::chrono::steady_clock::now();
+  const ProcessResult result = run_process({ cmake_command, "-E", "sleep", "30" },
+                                           ProcessOptions{ ProcessOutput::Capture, std::chrono::milliseconds(200) });
+  REQUIRE(result.timed_out);
+  REQUIRE_FALSE(result.success());
+  REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+}
+
+TEST_CASE("Commands run concurrently with their output kept apart", "[process]")
+{
+  std::vector<std::vector<std::string>> commands;
+  for (int i = 0; i < 8; ++i) {
+    commands.push_back({ cmake_command, "-E", "echo", "job " + std::to_string(i) });
+  }
+  // Catch2 assertions are not thread-safe, so the callback only records what it saw
+  std::vector<std::string> outputs(commands.size());
+  std::vector<unsigned> lanes(commands.size());
+  const bool succeeded = run_processes(commands, 4, ProcessOptions{ ProcessOutput::Capture },
+    [&](std::size_t index, unsigned lane, const ProcessResult& result) {
+      lanes[index] = lane;
+      outputs[index] = result.output;
+    });
+  REQUIRE(succeeded);
+  for (std::size_t i = 0; i < outputs.size(); ++i) {
+    REQUIRE(outputs[i].find("job " + std::to_string(i)) == 0);
+    REQUIRE(lanes[i] >= 1);
+    REQUIRE(lanes[i] <= 4);
+  }
+}
+
+TEST_CASE("No new commands start after a failure", "[process]")
+{
+  const std::vector<std::vector<std::string>> commands = { { cmake_command, "-E", "false" },
+    { cmake_command, "-E", "echo", "never" } };
+  std::size_t finished = 0;
+  REQUIRE_FALSE(run_processes(commands, 1, ProcessOptions{ ProcessOutput::Capture },
+    [&](std::size_t, unsigned, const ProcessResult&) { ++finished; }));
+  REQUIRE(finished == 1);
+}
+
+TEST_CASE("Background programs can be polled and stopped", "[process]")
+{
+  ChildProcess sleeper({ cmake_command, "-E", "sleep", "30" });
+  REQUIRE(sleeper.error().empty());
+  REQUIRE_FALSE(sleeper.poll());
+  const auto start = std::chrono::steady_clock::now();
+  sleeper.stop();
+  REQUIRE(sleeper.poll());
+  REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+
+  ChildProcess quick({ cmake_command, "-E", "true" });
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (!quick.poll() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(quick.poll() == 0);
+}
+
+TEST_CASE("Commands are formatted with the arguments that need it quoted", "[process]")
+{
+  REQUIRE(format_command({ "c++", "-c", "my file.cpp", "" }) == "c++ -c \"my file.cpp\" \"\"");
+}
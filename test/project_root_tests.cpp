@@ -0,0 +1,63 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include "project_root.hpp"
+
+
+namespace {
+
+std::filesystem::path make_test_dir(const char* name)
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  return directory;
+}
+
+void touch(const std::filesystem::path& path) { std::ofstream{ path }; }
+
+}// namespace
+
+TEST_CASE("Project root is found from a nested directory", "[project_root]")
+{
+  const std::filesystem::path project = make_test_dir("sail_root_nested_test");
+  touch(project / "Sail.toml");
+  std::filesystem::create_directories(project / "src" / "deep");
+
+  REQUIRE(find_project_root(project / "src" / "deep") == project);
+  // The memoized answer is still checked against the file system
+  REQUIRE(find_project_root(project / "src" / "deep") == project);
+  std::filesystem::remove(project / "Sail.toml");
+  REQUIRE_FALSE(find_project_root(project / "src" / "deep").has_value());
+
+  std::filesystem::remove_all(project);
+}
+
+TEST_CASE("Project root discovery stops at the checkout root", "[project_root]")
+{
+  const std::filesystem::path outer = make_test_dir("sail_root_vcs_test");
+  touch(outer / "Sail.toml");
+  std::filesystem::create_directories(outer / "checkout" / ".git");
+  std::filesystem::create_directories(outer / "checkout" / "src");
+
+  REQUIRE_FALSE(find_project_root(outer / "checkout" / "src").has_value());
+
+  std::filesystem::remove_all(outer);
+}
+
+#ifndef _WIN32
+TEST_CASE("SAIL_PROJECT_ROOT overrides the search", "[project_root]")
+{
+  const std::filesystem::path project = make_test_dir("sail_root_override_test");
+  touch(project / "Sail.toml");
+
+  setenv("SAIL_PROJECT_ROOT", project.c_str(), 1);// NOLINT(concurrency-mt-unsafe)
+  REQUIRE(find_project_root(std::filesystem::temp_directory_path()) == project);
+  unsetenv("SAIL_PROJECT_ROOT");// NOLINT(concurrency-mt-unsafe)
+
+  std::filesystem::remove_all(project);
+}
+#endif
@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "test_runner.hpp"
+
+
+TEST_CASE("Shards are parsed as i/n", "[test_runner]")
+{
+  const auto shard = parse_test_shard("2/4");
+  REQUIRE(shard.has_value());
+  CHECK(shard->index == 2);
+  CHECK(shard->count == 4);
+
+  CHECK_FALSE(parse_test_shard("0/4").has_value());
+  CHECK_FALSE(parse_test_shard("5/4").has_value());
+  CHECK_FALSE(parse_test_shard("1/0").has_value());
+  CHECK_FALSE(parse_test_shard("2").has_value());
+  CHECK_FALSE(parse_test_shard("a/b").has_value());
+  CHECK_FALSE(parse_test_shard("1/2/3").has_value());
+}
+
+TEST_CASE("Every test lands in exactly one shard", "[test_runner]")
+{
+  const std::vector<std::string> names = { "a", "b", "c", "d", "e" };
+  CHECK(select_test_shard(names, TestShard{ 1, 2 }) == std::vector<std::string>{ "a", "c", "e" });
+  CHECK(select_test_shard(names, TestShard{ 2, 2 }) == std::vector<std::string>{ "b", "d" });
+  CHECK(select_test_shard(names, TestShard{}) == names);
+  CHECK(select_test_shard(names, TestShard{ 5, 6 }) == std::vector<std::string>{ "e" });
+  CHECK(select_test_shard(names, TestShard{ 6, 6 }).empty());
+}
+
+TEST_CASE("Slow and new tests run first", "[test_runner]")
+{
+  const TestDurations durations = {
+    { "fast", std::chrono::milliseconds(5) },
+    { "slow", std::chrono::milliseconds(900) },
+    { "medium", std::chrono::milliseconds(80) },
+  };
+  const std::vector<std::string> ordered = order_slowest_first({ "fast", "medium", "new", "slow" }, durations);
+  CHECK(ordered == std::vector<std::string>{ "new", "slow", "medium", "fast" });
+}
+
+TEST_CASE("Test durations survive a round trip through the durations file", "[test_runner]")
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / "sail_test_durations_test";
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  const std::filesystem::path path = test_durations_path(directory);
+
+  CHECK(read_test_durations(path).empty());
+  const TestDurations durations = {
+    { "parser test", std::chrono::milliseconds(1250) },
+    { "lexer", std::chrono::milliseconds(0) },
+  };
+  write_test_durations(path, durations);
+  CHECK(read_test_durations(path) == durations);
+}
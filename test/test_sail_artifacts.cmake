@@ -0,0 +1,153 @@
+
+# Create a temporary directory for testing, with its own sail home so the real cache is untouched
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+set(ENV{SAIL_HOME} "${TEST_WORKING_DIR}/sail_home")
+
+# Publish a library that installs a CMake package
+set(LIBRARY_DIR "${TEST_WORKING_DIR}/greet")
+file(WRITE "${LIBRARY_DIR}/CMakeLists.txt" "cmake_minimum_required(VERSION 3.21)
+project(greet LANGUAGES CXX)
+add_library(greet STATIC greet.cpp)
+target_include_directories(greet PUBLIC \"$<BUILD_INTERFACE:\${CMAKE_CURRENT_SOURCE_DIR}/include>\" \"$<INSTALL_INTERFACE:include>\")
+install(TARGETS greet EXPORT greetTargets ARCHIVE DESTINATION lib)
+install(DIRECTORY include/ DESTINATION include)
+install(EXPORT greetTargets NAMESPACE greet:: DESTINATION lib/cmake/greet FILE greetConfig.cmake)
+")
+file(WRITE "${LIBRARY_DIR}/include/greet.hpp" "const char* greet();\n")
+file(WRITE "${LIBRARY_DIR}/greet.cpp" "#include <greet.hpp>\nconst char* greet() { return \"Hello from a prebuilt dependency\"; }\n")
+foreach(GIT_ARGS IN ITEMS "init;--quiet" "add;." "-c;user.name=sail;-c;user.email=sail@example.com;commit;--quiet;-m;initial" "tag;v1.0")
+  execute_process(COMMAND "${GIT_EXECUTABLE}" ${GIT_ARGS} WORKING_DIRECTORY "${LIBRARY_DIR}" RESULT_VARIABLE GIT_RESULT)
+  if(NOT GIT_RESULT EQUAL 0)
+    message(FATAL_ERROR "git ${GIT_ARGS} failed")
+  endif()
+endforeach()
+
+foreach(PROJECT_NAME IN ITEMS first_consumer second_consumer)
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+    WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+    RESULT_VARIABLE NEW_RESULT
+    OUTPUT_VARIABLE NEW_OUTPUT
+    ERROR_VARIABLE NEW_ERROR
+    TIMEOUT 30
+  )
+
+  if(NOT NEW_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+  endif()
+
+  set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+  file(APPEND "${PROJECT_DIR}/Sail.toml" "greet = { git = \"${LIBRARY_DIR}\", tag = \"v1.0\", targets = [\"greet::greet\"] }\n")
+  file(WRITE "${PROJECT_DIR}/src/main.cpp" "#include <iostream>\n#include <greet.hpp>\nint main() { std::cout << greet() << std::endl; return 0; }\n")
+
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" run
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE RUN_RESULT
+    OUTPUT_VARIABLE RUN_OUTPUT
+    ERROR_VARIABLE RUN_ERROR
+    TIMEOUT 120
+  )
+
+  string(FIND "${RUN_OUTPUT}" "Hello from a prebuilt dependency" GREETING_FOUND)
+  if(NOT RUN_RESULT EQUAL 0 OR GREETING_FOUND EQUAL -1)
+    message(FATAL_ERROR "${PROJECT_NAME} did not build against the dependency: ${RUN_OUTPUT} ${RUN_ERROR}")
+  endif()
+  if(EXISTS "${PROJECT_DIR}/target/debug/build/_deps/greet")
+    message(FATAL_ERROR "${PROJECT_NAME} compiled greet itself instead of linking the prebuilt artifact")
+  endif()
+  string(FIND "${RUN_OUTPUT}" "Building greet" BUILD_FOUND)
+  list(APPEND BUILD_RESULTS ${BUILD_FOUND})
+endforeach()
+
+# Only the first project may compile greet; the second one links the cached artifact
+list(GET BUILD_RESULTS 0 FIRST_BUILD)
+list(GET BUILD_RESULTS 1 SECOND_BUILD)
+if(FIRST_BUILD EQUAL -1 OR NOT SECOND_BUILD EQUAL -1)
+  message(FATAL_ERROR "Expected exactly one build of greet, got: ${BUILD_RESULTS}")
+endif()
+
+file(GLOB CACHED_ARTIFACTS "$ENV{SAIL_HOME}/cache/artifacts/greet-*/lib/cmake/greet/greetConfig.cmake")
+list(LENGTH CACHED_ARTIFACTS ARTIFACT_COUNT)
+if(NOT ARTIFACT_COUNT EQUAL 1)
+  message(FATAL_ERROR "Expected one installed greet artifact, found: ${CACHED_ARTIFACTS}")
+endif()
+
+# A sanitizer profile needs an instrumented greet of its own; building it next to dev must not reuse dev's
+if(NOT CMAKE_HOST_WIN32)
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" build --profile dev,asan
+    WORKING_DIRECTORY "${TEST_WORKING_DIR}/first_consumer"
+    RESULT_VARIABLE PROFILES_RESULT
+    OUTPUT_VARIABLE PROFILES_OUTPUT
+    ERROR_VARIABLE PROFILES_ERROR
+    TIMEOUT 240
+  )
+  if(NOT PROFILES_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail build --profile dev,asan failed: ${PROFILES_OUTPUT} ${PROFILES_ERROR}")
+  endif()
+  file(GLOB CACHED_ARTIFACTS "$ENV{SAIL_HOME}/cache/artifacts/greet-*/lib/cmake/greet/greetConfig.cmake")
+  list(LENGTH CACHED_ARTIFACTS ARTIFACT_COUNT)
+  if(NOT ARTIFACT_COUNT EQUAL 2)
+    message(FATAL_ERROR "Expected separate greet artifacts for dev and asan, found: ${CACHED_ARTIFACTS}")
+  endif()
+  file(GLOB CACHED_LIBRARIES "$ENV{SAIL_HOME}/cache/artifacts/greet-*/lib/libgreet.a")
+  set(INSTRUMENTED_COUNT 0)
+  foreach(LIBRARY IN LISTS CACHED_LIBRARIES)
+    file(STRINGS "${LIBRARY}" ASAN_SYMBOLS REGEX "__asan")
+    if(ASAN_SYMBOLS)
+      math(EXPR INSTRUMENTED_COUNT "${INSTRUMENTED_COUNT} + 1")
+    endif()
+  endforeach()
+  if(NOT INSTRUMENTED_COUNT EQUAL 1)
+    message(FATAL_ERROR "Expected exactly one greet artifact built with the address sanitizer, found ${INSTRUMENTED_COUNT}")
+  endif()
+endif()
+
+# The native engine links the artifact's library, and rejects a dependency it has no artifact of
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new native_consumer
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+set(PROJECT_DIR "${TEST_WORKING_DIR}/native_consumer")
+file(READ "${PROJECT_DIR}/Sail.toml" NATIVE_TOML)
+file(WRITE "${PROJECT_DIR}/src/main.cpp" "#include <iostream>\n#include <greet.hpp>\nint main() { std::cout << greet() << std::endl; return 0; }\n")
+file(WRITE "${PROJECT_DIR}/Sail.toml" "${NATIVE_TOML}greet = { git = \"${LIBRARY_DIR}\", tag = \"v1.0\", targets = [\"greet::greet\"] }\n\n[build]\nengine = \"native\"\n")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE RUN_RESULT
+  OUTPUT_VARIABLE RUN_OUTPUT
+  ERROR_VARIABLE RUN_ERROR
+  TIMEOUT 120
+)
+string(FIND "${RUN_OUTPUT}" "Hello from a prebuilt dependency" GREETING_FOUND)
+if(NOT RUN_RESULT EQUAL 0 OR GREETING_FOUND EQUAL -1)
+  message(FATAL_ERROR "The native engine did not link the prebuilt dependency: ${RUN_OUTPUT} ${RUN_ERROR}")
+endif()
+
+file(WRITE "${PROJECT_DIR}/Sail.toml" "${NATIVE_TOML}greet = { path = \"${LIBRARY_DIR}\", targets = [\"greet::greet\"] }\n\n[build]\nengine = \"native\"\n")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE BUILD_RESULT
+  OUTPUT_VARIABLE BUILD_OUTPUT
+  ERROR_VARIABLE BUILD_ERROR
+  TIMEOUT 120
+)
+string(FIND "${BUILD_OUTPUT}" "Dependency 'greet' has no prebuilt artifact" REJECTION_FOUND)
+if(BUILD_RESULT EQUAL 0 OR REJECTION_FOUND EQUAL -1)
+  message(FATAL_ERROR "Expected the native engine to reject a path dependency: ${BUILD_OUTPUT} ${BUILD_ERROR}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail prebuilt dependency test passed - dependency built once per set of flags and linked from the cache")
@@ -0,0 +1,84 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+# The benchmark calls into the project and prints a report of its own
+set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[build]\nengine = \"native\"\n")
+file(WRITE "${PROJECT_DIR}/src/triple.hpp" "int triple(int value);\n")
+file(WRITE "${PROJECT_DIR}/src/triple.cpp" "#include \"triple.hpp\"\nint triple(int value) { return 3 * value; }\n")
+file(WRITE "${PROJECT_DIR}/benches/triples.cpp" "#include \"triple.hpp\"\n#include <cstdio>\nint main() { volatile int total = 0; for (int i = 0; i < 1000; ++i) { total = total + triple(i); } std::printf(\"own report %d\\n\", total); }\n")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" bench --warmup 0 --runs 3 --save-baseline main
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE BENCH_RESULT
+  OUTPUT_VARIABLE BENCH_OUTPUT
+  ERROR_VARIABLE BENCH_ERROR
+  TIMEOUT 120
+)
+
+if(NOT BENCH_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail bench failed: ${BENCH_OUTPUT} ${BENCH_ERROR}")
+endif()
+foreach(EXPECTED "bench triples ... " "3 run(s)" "own report 1498500")
+  string(FIND "${BENCH_OUTPUT}" "${EXPECTED}" EXPECTED_FOUND)
+  if(EXPECTED_FOUND EQUAL -1)
+    message(FATAL_ERROR "Expected '${EXPECTED}' in the output: ${BENCH_OUTPUT}")
+  endif()
+endforeach()
+foreach(EXPECTED_FILE "target/release/benches/triples" "target/bench/latest.json" "target/bench/main.json")
+  if(NOT EXISTS "${PROJECT_DIR}/${EXPECTED_FILE}" AND NOT EXISTS "${PROJECT_DIR}/${EXPECTED_FILE}.exe")
+    message(FATAL_ERROR "sail bench did not write ${EXPECTED_FILE}")
+  endif()
+endforeach()
+file(READ "${PROJECT_DIR}/target/bench/main.json" RESULTS_JSON)
+string(JSON MEAN GET "${RESULTS_JSON}" benchmarks 0 mean_ns)
+if(NOT MEAN GREATER 0)
+  message(FATAL_ERROR "Unexpected results in main.json: ${RESULTS_JSON}")
+endif()
+
+# Timing noise decides the verdict here, so only the comparison itself is checked
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" bench --warmup 0 --runs 3 --baseline main
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  OUTPUT_VARIABLE COMPARE_OUTPUT
+  ERROR_VARIABLE COMPARE_ERROR
+  TIMEOUT 120
+)
+
+string(FIND "${COMPARE_OUTPUT}" "vs main: " COMPARISON_FOUND)
+if(COMPARISON_FOUND EQUAL -1)
+  message(FATAL_ERROR "sail bench --baseline main did not compare: ${COMPARE_OUTPUT} ${COMPARE_ERROR}")
+endif()
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" bench --baseline missing
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE MISSING_RESULT
+  OUTPUT_VARIABLE MISSING_OUTPUT
+  ERROR_VARIABLE MISSING_ERROR
+  TIMEOUT 120
+)
+
+if(MISSING_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail bench accepted a baseline that was never saved: ${MISSING_OUTPUT}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail bench test passed - benchmarks were timed, saved and compared")
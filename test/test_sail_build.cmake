@@ -0,0 +1,118 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+# First create a new project
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+
+# Now try to build the project (debug mode)
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE BUILD_RESULT
+  OUTPUT_VARIABLE BUILD_OUTPUT
+  ERROR_VARIABLE BUILD_ERROR
+  TIMEOUT 60
+)
+
+if(NOT BUILD_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail build failed: ${BUILD_OUTPUT} ${BUILD_ERROR}")
+endif()
+
+# Check if target directory was created
+set(TARGET_DEBUG_DIR "${PROJECT_DIR}/target/debug")
+if(NOT EXISTS "${TARGET_DEBUG_DIR}")
+  message(FATAL_ERROR "target/debug directory was not created")
+endif()
+
+# Check if executable was created (handle Windows .exe extension)
+if(WIN32)
+  set(EXECUTABLE_PATH "${TARGET_DEBUG_DIR}/${PROJECT_NAME}.exe")
+else()
+  set(EXECUTABLE_PATH "${TARGET_DEBUG_DIR}/${PROJECT_NAME}")
+endif()
+if(NOT EXISTS "${EXECUTABLE_PATH}")
+  message(FATAL_ERROR "Executable was not created at ${EXECUTABLE_PATH}")
+endif()
+
+# Test build from subdirectory (src)
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build --release
+  WORKING_DIRECTORY "${PROJECT_DIR}/src"
+  RESULT_VARIABLE BUILD_RELEASE_RESULT
+  OUTPUT_VARIABLE BUILD_RELEASE_OUTPUT
+  ERROR_VARIABLE BUILD_RELEASE_ERROR
+  TIMEOUT 60
+)
+
+if(NOT BUILD_RELEASE_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail build --release from subdirectory failed: ${BUILD_RELEASE_OUTPUT} ${BUILD_RELEASE_ERROR}")
+endif()
+
+# Check if release executable was created (handle Windows .exe extension)
+set(TARGET_RELEASE_DIR "${PROJECT_DIR}/target/release")
+if(WIN32)
+  set(RELEASE_EXECUTABLE_PATH "${TARGET_RELEASE_DIR}/${PROJECT_NAME}.exe")
+else()
+  set(RELEASE_EXECUTABLE_PATH "${TARGET_RELEASE_DIR}/${PROJECT_NAME}")
+endif()
+if(NOT EXISTS "${RELEASE_EXECUTABLE_PATH}")
+  message(FATAL_ERROR "Release executable was not created at ${RELEASE_EXECUTABLE_PATH}")
+endif()
+
+# sail keeps the CMakeLists.txt it generated up to date while it carries sail's marker line
+file(READ "${PROJECT_DIR}/CMakeLists.txt" GENERATED_CMAKELISTS)
+string(FIND "${GENERATED_CMAKELISTS}" "# Generated by sail" MARKER_POSITION)
+if(NOT MARKER_POSITION EQUAL 0)
+  message(FATAL_ERROR "Generated CMakeLists.txt does not start with sail's marker: ${GENERATED_CMAKELISTS}")
+endif()
+string(REPLACE "SAIL_DEPENDENCIES_FILE" "SAIL_STALE_FILE" STALE_CMAKELISTS "${GENERATED_CMAKELISTS}")
+file(WRITE "${PROJECT_DIR}/CMakeLists.txt" "${STALE_CMAKELISTS}")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE REGENERATE_RESULT
+  OUTPUT_VARIABLE REGENERATE_OUTPUT
+  ERROR_VARIABLE REGENERATE_ERROR
+  TIMEOUT 60
+)
+file(READ "${PROJECT_DIR}/CMakeLists.txt" REGENERATED_CMAKELISTS)
+if(NOT REGENERATE_RESULT EQUAL 0 OR NOT REGENERATED_CMAKELISTS STREQUAL GENERATED_CMAKELISTS)
+  message(FATAL_ERROR "sail did not regenerate its CMakeLists.txt: ${REGENERATE_OUTPUT} ${REGENERATE_ERROR}")
+endif()
+
+# A CMakeLists.txt of the project's own is left alone, with a warning when sail cannot reach it
+string(REPLACE "# Generated by sail" "# Written by hand" OWN_CMAKELISTS "${GENERATED_CMAKELISTS}")
+string(REPLACE "SAIL_SOURCES_FILE" "OWN_SOURCES_FILE" OWN_CMAKELISTS "${OWN_CMAKELISTS}")
+file(WRITE "${PROJECT_DIR}/CMakeLists.txt" "${OWN_CMAKELISTS}")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE OWN_RESULT
+  OUTPUT_VARIABLE OWN_OUTPUT
+  ERROR_VARIABLE OWN_ERROR
+  TIMEOUT 60
+)
+file(READ "${PROJECT_DIR}/CMakeLists.txt" OWN_AFTER)
+string(FIND "${OWN_OUTPUT}" "does not include SAIL_SOURCES_FILE" HOOK_WARNING_FOUND)
+if(NOT OWN_RESULT EQUAL 0 OR HOOK_WARNING_FOUND EQUAL -1 OR NOT OWN_AFTER STREQUAL OWN_CMAKELISTS)
+  message(FATAL_ERROR "Expected the project's own CMakeLists.txt to be kept, with a warning: ${OWN_OUTPUT} ${OWN_ERROR}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail build test passed - project compiled successfully")
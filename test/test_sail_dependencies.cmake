@@ -0,0 +1,69 @@
+
+# Create a temporary directory for testing, with its own sail home so the real cache is untouched
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+set(ENV{SAIL_HOME} "${TEST_WORKING_DIR}/sail_home")
+
+# Publish a small library as a local git repository with a tag
+set(LIBRARY_DIR "${TEST_WORKING_DIR}/greet")
+file(WRITE "${LIBRARY_DIR}/CMakeLists.txt" "cmake_minimum_required(VERSION 3.21)\nproject(greet LANGUAGES CXX)\nadd_library(greet STATIC greet.cpp)\ntarget_include_directories(greet PUBLIC include)\n")
+file(WRITE "${LIBRARY_DIR}/include/greet.hpp" "const char* greet();\n")
+file(WRITE "${LIBRARY_DIR}/greet.cpp" "#include <greet.hpp>\nconst char* greet() { return \"Hello from a dependency\"; }\n")
+foreach(GIT_ARGS IN ITEMS "init;--quiet" "add;." "-c;user.name=sail;-c;user.email=sail@example.com;commit;--quiet;-m;initial" "tag;v1.0")
+  execute_process(COMMAND "${GIT_EXECUTABLE}" ${GIT_ARGS} WORKING_DIRECTORY "${LIBRARY_DIR}" RESULT_VARIABLE GIT_RESULT)
+  if(NOT GIT_RESULT EQUAL 0)
+    message(FATAL_ERROR "git ${GIT_ARGS} failed")
+  endif()
+endforeach()
+
+foreach(PROJECT_NAME IN ITEMS first_consumer second_consumer)
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+    WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+    RESULT_VARIABLE NEW_RESULT
+    OUTPUT_VARIABLE NEW_OUTPUT
+    ERROR_VARIABLE NEW_ERROR
+    TIMEOUT 30
+  )
+
+  if(NOT NEW_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+  endif()
+
+  set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+  file(APPEND "${PROJECT_DIR}/Sail.toml" "greet = { git = \"${LIBRARY_DIR}\", tag = \"v1.0\" }\n")
+  file(WRITE "${PROJECT_DIR}/src/main.cpp" "#include <iostream>\n#include <greet.hpp>\nint main() { std::cout << greet() << std::endl; return 0; }\n")
+
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" run
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE RUN_RESULT
+    OUTPUT_VARIABLE RUN_OUTPUT
+    ERROR_VARIABLE RUN_ERROR
+    TIMEOUT 120
+  )
+
+  string(FIND "${RUN_OUTPUT}" "Hello from a dependency" GREETING_FOUND)
+  if(GREETING_FOUND EQUAL -1)
+    message(FATAL_ERROR "${PROJECT_NAME} did not build against the dependency: ${RUN_OUTPUT} ${RUN_ERROR}")
+  endif()
+  string(FIND "${RUN_OUTPUT}" "Fetching greet" FETCH_FOUND)
+  list(APPEND FETCH_RESULTS ${FETCH_FOUND})
+endforeach()
+
+# Only the first project may download; the second one reuses the shared cache
+list(GET FETCH_RESULTS 0 FIRST_FETCH)
+list(GET FETCH_RESULTS 1 SECOND_FETCH)
+if(FIRST_FETCH EQUAL -1 OR NOT SECOND_FETCH EQUAL -1)
+  message(FATAL_ERROR "Expected exactly one fetch of greet, got: ${FETCH_RESULTS}")
+endif()
+
+file(GLOB CACHED_CHECKOUTS "$ENV{SAIL_HOME}/cache/git/*")
+list(LENGTH CACHED_CHECKOUTS CACHED_COUNT)
+if(NOT CACHED_COUNT EQUAL 1)
+  message(FATAL_ERROR "Expected one cached checkout, found: ${CACHED_CHECKOUTS}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail dependency test passed - dependency fetched once and shared")
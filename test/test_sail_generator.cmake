@@ -0,0 +1,77 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}/fake_ninja")
+find_program(REAL_NINJA ninja)
+set(ORIGINAL_PATH "$ENV{PATH}")
+unset(ENV{CMAKE_GENERATOR})
+
+# A ninja that cannot build anything, to show when sail would have picked it
+file(WRITE "${TEST_WORKING_DIR}/fake_ninja/ninja" "#!/bin/sh\nexit 1\n")
+file(CHMOD "${TEST_WORKING_DIR}/fake_ninja/ninja" PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE)
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new generator_test
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+set(PROJECT_DIR "${TEST_WORKING_DIR}/generator_test")
+set(CACHE_FILE "${PROJECT_DIR}/target/debug/build/CMakeCache.txt")
+file(READ "${PROJECT_DIR}/Sail.toml" BASE_TOML)
+
+# Build with `BUILD_TABLE` appended to Sail.toml, keeping the existing build tree, and check which
+# generator the tree ends up configured with
+function(build_expecting_generator BUILD_TABLE EXPECTED_GENERATOR DESCRIPTION)
+  file(WRITE "${PROJECT_DIR}/Sail.toml" "${BASE_TOML}\n${BUILD_TABLE}\n")
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" build
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE BUILD_RESULT
+    OUTPUT_VARIABLE BUILD_OUTPUT
+    ERROR_VARIABLE BUILD_ERROR
+    TIMEOUT 120
+  )
+  if(NOT BUILD_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail build failed ${DESCRIPTION}: ${BUILD_OUTPUT} ${BUILD_ERROR}")
+  endif()
+  file(STRINGS "${CACHE_FILE}" GENERATOR_LINE REGEX "^CMAKE_GENERATOR:INTERNAL=")
+  string(REPLACE "CMAKE_GENERATOR:INTERNAL=" "" GENERATOR "${GENERATOR_LINE}")
+  if(NOT GENERATOR STREQUAL EXPECTED_GENERATOR)
+    message(FATAL_ERROR "Expected the ${EXPECTED_GENERATOR} generator ${DESCRIPTION}, got '${GENERATOR}'")
+  endif()
+endfunction()
+
+# [build] generator is used over CMAKE_GENERATOR, which would not even configure here
+set(ENV{CMAKE_GENERATOR} "No Such Generator")
+build_expecting_generator("[build]\ngenerator = \"Unix Makefiles\"" "Unix Makefiles" "with [build] generator over CMAKE_GENERATOR")
+
+# CMAKE_GENERATOR is used over a ninja found on PATH
+set(ENV{CMAKE_GENERATOR} "Unix Makefiles")
+set(ENV{PATH} "${TEST_WORKING_DIR}/fake_ninja:${ORIGINAL_PATH}")
+build_expecting_generator("" "Unix Makefiles" "with CMAKE_GENERATOR over a ninja on PATH")
+set(ENV{PATH} "${ORIGINAL_PATH}")
+unset(ENV{CMAKE_GENERATOR})
+
+# Switching generators starts the build tree over instead of failing on the old CMakeCache.txt
+if(REAL_NINJA)
+  build_expecting_generator("" "Ninja" "with ninja detected on PATH")
+  build_expecting_generator("[build]\ngenerator = \"Unix Makefiles\"" "Unix Makefiles" "after switching back from Ninja")
+else()
+  # Without ninja here, leave the tree as a Ninja build would have
+  file(READ "${CACHE_FILE}" CACHE_CONTENT)
+  string(REPLACE "CMAKE_GENERATOR:INTERNAL=Unix Makefiles" "CMAKE_GENERATOR:INTERNAL=Ninja" CACHE_CONTENT "${CACHE_CONTENT}")
+  file(WRITE "${CACHE_FILE}" "${CACHE_CONTENT}")
+  build_expecting_generator("[build]\ngenerator = \"Unix Makefiles\"\n# switched" "Unix Makefiles" "after switching from Ninja")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail generator test passed - [build] generator wins, and switching generators rebuilds cleanly")
@@ -0,0 +1,40 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+# Run sail init in the test directory
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" init
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE INIT_RESULT
+  OUTPUT_VARIABLE INIT_OUTPUT
+  ERROR_VARIABLE INIT_ERROR
+  TIMEOUT 30
+)
+
+if(NOT INIT_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail init failed with result: ${INIT_RESULT}\nOutput: ${INIT_OUTPUT}\nError: ${INIT_ERROR}")
+endif()
+
+# Check if Sail.toml was created
+set(TOML_FILE "${TEST_WORKING_DIR}/Sail.toml")
+if(NOT EXISTS "${TOML_FILE}")
+  message(FATAL_ERROR "Sail.toml was not created in ${TEST_WORKING_DIR}")
+endif()
+
+# Check content contains expected sections
+file(READ "${TOML_FILE}" TOML_CONTENT)
+string(FIND "${TOML_CONTENT}" "[project]" PROJECT_FOUND)
+string(FIND "${TOML_CONTENT}" "[dependencies]" DEPS_FOUND)
+
+if(PROJECT_FOUND EQUAL -1)
+  message(FATAL_ERROR "Sail.toml missing [project] section")
+endif()
+if(DEPS_FOUND EQUAL -1)
+  message(FATAL_ERROR "Sail.toml missing [dependencies] section")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail init test passed - Sail.toml created successfully")
@@ -0,0 +1,70 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}/bin")
+
+# The compiler launcher records the flags make hands down, which carry the number of jobs
+file(WRITE "${TEST_WORKING_DIR}/bin/record-launcher" "#!/bin/sh\necho \"MAKEFLAGS=$MAKEFLAGS\" >> \"${TEST_WORKING_DIR}/launches.log\"\nexec \"$@\"\n")
+file(CHMOD "${TEST_WORKING_DIR}/bin/record-launcher" PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE)
+set(ENV{PATH} "${TEST_WORKING_DIR}/bin:$ENV{PATH}")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new jobs_test
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+set(PROJECT_DIR "${TEST_WORKING_DIR}/jobs_test")
+file(READ "${PROJECT_DIR}/Sail.toml" BASE_TOML)
+
+# Build from scratch with `JOBS_ENTRY` in [build] and the remaining arguments on the command line,
+# and report the number of jobs make was given; empty for one job, which make does not pass down
+function(build_with_jobs JOBS_ENTRY RESULT_VARIABLE_NAME)
+  file(WRITE "${PROJECT_DIR}/Sail.toml" "${BASE_TOML}\n[build]\ngenerator = \"Unix Makefiles\"\ncache = \"record-launcher\"\n${JOBS_ENTRY}\n")
+  file(REMOVE_RECURSE "${PROJECT_DIR}/target")
+  file(REMOVE "${TEST_WORKING_DIR}/launches.log")
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" build ${ARGN}
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE BUILD_RESULT
+    OUTPUT_VARIABLE BUILD_OUTPUT
+    ERROR_VARIABLE BUILD_ERROR
+    TIMEOUT 120
+  )
+  if(NOT BUILD_RESULT EQUAL 0 OR NOT EXISTS "${TEST_WORKING_DIR}/launches.log")
+    message(FATAL_ERROR "sail build ${ARGN} with '${JOBS_ENTRY}' failed: ${BUILD_OUTPUT} ${BUILD_ERROR}")
+  endif()
+  file(READ "${TEST_WORKING_DIR}/launches.log" LAUNCHES)
+  string(REGEX MATCH "-j([0-9]+)" JOBS_FLAG "${LAUNCHES}")
+  set(${RESULT_VARIABLE_NAME} "${CMAKE_MATCH_1}" PARENT_SCOPE)
+endfunction()
+
+# [build] jobs is used over the number of cores
+build_with_jobs("jobs = 3" MANIFEST_JOBS)
+if(NOT MANIFEST_JOBS STREQUAL "3")
+  message(FATAL_ERROR "Expected [build] jobs = 3 to build with 3 jobs, got '${MANIFEST_JOBS}'")
+endif()
+
+# --jobs is used over [build] jobs
+build_with_jobs("jobs = 3" FLAG_JOBS --jobs 2)
+if(NOT FLAG_JOBS STREQUAL "2")
+  message(FATAL_ERROR "Expected --jobs 2 to win over [build] jobs = 3, got '${FLAG_JOBS}'")
+endif()
+
+# Without either, the build still runs on the cores, and --jobs still wins
+build_with_jobs("" AUTO_JOBS)
+build_with_jobs("" AUTO_FLAG_JOBS -j 4)
+if(NOT AUTO_FLAG_JOBS STREQUAL "4")
+  message(FATAL_ERROR "Expected -j 4 to build with 4 jobs, got '${AUTO_FLAG_JOBS}'")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail jobs test passed - --jobs wins over [build] jobs, which wins over the core count")
@@ -0,0 +1,77 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}/bin")
+set(ORIGINAL_PATH "$ENV{PATH}")
+find_program(REAL_CCACHE ccache)
+
+# Compiler caches that only pass the compiler command through
+foreach(LAUNCHER ccache sccache record-launcher)
+  file(WRITE "${TEST_WORKING_DIR}/bin/${LAUNCHER}" "#!/bin/sh\nexec \"$@\"\n")
+  file(CHMOD "${TEST_WORKING_DIR}/bin/${LAUNCHER}" PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE)
+endforeach()
+set(ENV{PATH} "${TEST_WORKING_DIR}/bin:${ORIGINAL_PATH}")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new launcher_test
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+set(PROJECT_DIR "${TEST_WORKING_DIR}/launcher_test")
+file(READ "${PROJECT_DIR}/Sail.toml" BASE_TOML)
+
+# Build with `BUILD_TABLE` appended to Sail.toml and check the compiler launcher the build was configured with
+function(build_expecting_launcher BUILD_TABLE EXPECTED_LAUNCHER DESCRIPTION)
+  file(WRITE "${PROJECT_DIR}/Sail.toml" "${BASE_TOML}\n${BUILD_TABLE}\n")
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" build
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE BUILD_RESULT
+    OUTPUT_VARIABLE BUILD_OUTPUT
+    ERROR_VARIABLE BUILD_ERROR
+    TIMEOUT 120
+  )
+  if(NOT BUILD_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail build failed ${DESCRIPTION}: ${BUILD_OUTPUT} ${BUILD_ERROR}")
+  endif()
+  file(STRINGS "${PROJECT_DIR}/target/debug/build/CMakeCache.txt" LAUNCHER_LINE REGEX "^CMAKE_CXX_COMPILER_LAUNCHER:")
+  string(REGEX REPLACE "^[^=]*=" "" LAUNCHER "${LAUNCHER_LINE}")
+  if(EXPECTED_LAUNCHER STREQUAL "")
+    set(EXPECTED_PATH "")
+  else()
+    set(EXPECTED_PATH "${TEST_WORKING_DIR}/bin/${EXPECTED_LAUNCHER}")
+  endif()
+  if(NOT LAUNCHER STREQUAL EXPECTED_PATH)
+    message(FATAL_ERROR "Expected the compiler launcher '${EXPECTED_PATH}' ${DESCRIPTION}, got '${LAUNCHER}'")
+  endif()
+  set(BUILD_OUTPUT "${BUILD_OUTPUT}" PARENT_SCOPE)
+endfunction()
+
+# [build] cache is used over the caches found on PATH
+build_expecting_launcher("[build]\ncache = \"record-launcher\"" "record-launcher" "with [build] cache")
+
+# Without it, ccache is used over sccache
+build_expecting_launcher("" "ccache" "without [build] cache")
+if(NOT REAL_CCACHE)
+  file(REMOVE "${TEST_WORKING_DIR}/bin/ccache")
+  build_expecting_launcher("" "sccache" "with only sccache on PATH")
+endif()
+
+# "none" turns the cache off, and a cache that is not installed warns and builds without one
+build_expecting_launcher("[build]\ncache = \"none\"" "" "with [build] cache = \"none\"")
+build_expecting_launcher("[build]\ncache = \"no-such-cache\"" "" "with a missing [build] cache")
+if(NOT BUILD_OUTPUT MATCHES "compiler cache 'no-such-cache' is enabled but was not found")
+  message(FATAL_ERROR "Expected a warning about the missing compiler cache, got: ${BUILD_OUTPUT}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail launcher test passed - [build] cache wins over the caches found on PATH")
@@ -0,0 +1,45 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}/bin")
+
+# A mold on PATH that cannot link anything must not break the build
+file(WRITE "${TEST_WORKING_DIR}/bin/mold" "#!/bin/sh\nexit 1\n")
+file(CHMOD "${TEST_WORKING_DIR}/bin/mold" PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE)
+set(ENV{PATH} "${TEST_WORKING_DIR}/bin:$ENV{PATH}")
+
+foreach(ENGINE IN ITEMS cmake native)
+  set(PROJECT_NAME "linker_${ENGINE}")
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+    WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+    RESULT_VARIABLE NEW_RESULT
+    OUTPUT_VARIABLE NEW_OUTPUT
+    ERROR_VARIABLE NEW_ERROR
+    TIMEOUT 30
+  )
+
+  if(NOT NEW_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+  endif()
+
+  set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+  file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[build]\nengine = \"${ENGINE}\"\n")
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" run
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE RUN_RESULT
+    OUTPUT_VARIABLE RUN_OUTPUT
+    ERROR_VARIABLE RUN_ERROR
+    TIMEOUT 120
+  )
+
+  string(FIND "${RUN_OUTPUT}" "Hello, World!" HELLO_FOUND)
+  if(NOT RUN_RESULT EQUAL 0 OR HELLO_FOUND EQUAL -1)
+    message(FATAL_ERROR "A broken auto-detected linker failed the ${ENGINE} build: ${RUN_OUTPUT} ${RUN_ERROR}")
+  endif()
+endforeach()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail linker test passed - unusable linkers fall back to the default")
@@ -0,0 +1,120 @@
+
+# Create a temporary directory for testing, with its own sail home so the real cache is untouched
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+set(ENV{SAIL_HOME} "${TEST_WORKING_DIR}/sail_home")
+
+# Publish a small library as a local git repository with a tag
+set(LIBRARY_DIR "${TEST_WORKING_DIR}/greet")
+file(WRITE "${LIBRARY_DIR}/CMakeLists.txt" "cmake_minimum_required(VERSION 3.21)\nproject(greet LANGUAGES CXX)\nadd_library(greet STATIC greet.cpp)\ntarget_include_directories(greet PUBLIC include)\n")
+file(WRITE "${LIBRARY_DIR}/include/greet.hpp" "const char* greet();\n")
+file(WRITE "${LIBRARY_DIR}/greet.cpp" "#include <greet.hpp>\nconst char* greet() { return \"Hello from a locked dependency\"; }\n")
+foreach(GIT_ARGS IN ITEMS "init;--quiet" "add;." "-c;user.name=sail;-c;user.email=sail@example.com;commit;--quiet;-m;initial" "tag;v1.0")
+  execute_process(COMMAND "${GIT_EXECUTABLE}" ${GIT_ARGS} WORKING_DIRECTORY "${LIBRARY_DIR}" RESULT_VARIABLE GIT_RESULT)
+  if(NOT GIT_RESULT EQUAL 0)
+    message(FATAL_ERROR "git ${GIT_ARGS} failed")
+  endif()
+endforeach()
+execute_process(COMMAND "${GIT_EXECUTABLE}" rev-parse HEAD WORKING_DIRECTORY "${LIBRARY_DIR}" OUTPUT_VARIABLE LIBRARY_COMMIT OUTPUT_STRIP_TRAILING_WHITESPACE)
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new locked_consumer
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+set(PROJECT_DIR "${TEST_WORKING_DIR}/locked_consumer")
+file(APPEND "${PROJECT_DIR}/Sail.toml" "greet = { git = \"${LIBRARY_DIR}\", tag = \"v1.0\" }\n")
+file(WRITE "${PROJECT_DIR}/src/main.cpp" "#include <iostream>\n#include <greet.hpp>\nint main() { std::cout << greet() << std::endl; return 0; }\n")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE BUILD_RESULT
+  OUTPUT_VARIABLE BUILD_OUTPUT
+  ERROR_VARIABLE BUILD_ERROR
+  TIMEOUT 120
+)
+
+if(NOT BUILD_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail build failed: ${BUILD_OUTPUT} ${BUILD_ERROR}")
+endif()
+
+# The first build pins the tag to its commit
+file(READ "${PROJECT_DIR}/Sail.lock" LOCK_CONTENT)
+string(FIND "${LOCK_CONTENT}" "commit = \"${LIBRARY_COMMIT}\"" COMMIT_FOUND)
+if(COMMIT_FOUND EQUAL -1)
+  message(FATAL_ERROR "Sail.lock does not pin greet to ${LIBRARY_COMMIT}: ${LOCK_CONTENT}")
+endif()
+
+# With the lock and the cached checkout, the remote is never contacted again
+file(RENAME "${LIBRARY_DIR}" "${TEST_WORKING_DIR}/greet_offline")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run --locked
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE RUN_RESULT
+  OUTPUT_VARIABLE RUN_OUTPUT
+  ERROR_VARIABLE RUN_ERROR
+  TIMEOUT 120
+)
+
+string(FIND "${RUN_OUTPUT}" "Hello from a locked dependency" GREETING_FOUND)
+if(NOT RUN_RESULT EQUAL 0 OR GREETING_FOUND EQUAL -1)
+  message(FATAL_ERROR "Locked build needed the remote: ${RUN_OUTPUT} ${RUN_ERROR}")
+endif()
+
+# Re-pointing the tag does not move the lock: an empty cache fetches the locked commit itself
+file(RENAME "${TEST_WORKING_DIR}/greet_offline" "${LIBRARY_DIR}")
+file(WRITE "${LIBRARY_DIR}/greet.cpp" "#include <greet.hpp>\nconst char* greet() { return \"Hello from a moved tag\"; }\n")
+foreach(GIT_ARGS IN ITEMS "-c;user.name=sail;-c;user.email=sail@example.com;commit;--quiet;-am;moved" "tag;-f;v1.0")
+  execute_process(COMMAND "${GIT_EXECUTABLE}" ${GIT_ARGS} WORKING_DIRECTORY "${LIBRARY_DIR}" RESULT_VARIABLE GIT_RESULT OUTPUT_QUIET)
+  if(NOT GIT_RESULT EQUAL 0)
+    message(FATAL_ERROR "git ${GIT_ARGS} failed")
+  endif()
+endforeach()
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}/sail_home" "${PROJECT_DIR}/target")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run --locked
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE REFETCH_RESULT
+  OUTPUT_VARIABLE REFETCH_OUTPUT
+  ERROR_VARIABLE REFETCH_ERROR
+  TIMEOUT 120
+)
+
+string(FIND "${REFETCH_OUTPUT}" "Hello from a locked dependency" LOCKED_GREETING_FOUND)
+if(NOT REFETCH_RESULT EQUAL 0 OR LOCKED_GREETING_FOUND EQUAL -1)
+  message(FATAL_ERROR "Locked build did not fetch the locked commit after the tag moved: ${REFETCH_OUTPUT} ${REFETCH_ERROR}")
+endif()
+
+# Changing the declared source invalidates the entry, which --locked refuses to update
+file(READ "${PROJECT_DIR}/Sail.toml" TOML_CONTENT)
+string(REPLACE "v1.0" "v2.0" TOML_CONTENT "${TOML_CONTENT}")
+file(WRITE "${PROJECT_DIR}/Sail.toml" "${TOML_CONTENT}")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build --locked
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE STALE_RESULT
+  OUTPUT_VARIABLE STALE_OUTPUT
+  ERROR_VARIABLE STALE_ERROR
+  TIMEOUT 120
+)
+
+if(STALE_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail build --locked succeeded with a stale Sail.lock: ${STALE_OUTPUT} ${STALE_ERROR}")
+endif()
+file(READ "${PROJECT_DIR}/Sail.lock" LOCK_AFTER)
+if(NOT LOCK_AFTER STREQUAL LOCK_CONTENT)
+  message(FATAL_ERROR "sail build --locked modified Sail.lock")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail lockfile test passed - locked build worked offline")
@@ -0,0 +1,92 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new modules_project
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+# A module with a partition, an independent module and a plain source importing both
+set(PROJECT_DIR "${TEST_WORKING_DIR}/modules_project")
+file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[build]\nengine = \"native\"\nstd = 20\n")
+file(WRITE "${PROJECT_DIR}/src/math-detail.cppm" "export module math:detail;\nexport int twice(int x) { return 2 * x; }\n")
+file(WRITE "${PROJECT_DIR}/src/math.cppm" "export module math;\nexport import :detail;\nexport int square(int x) { return x * x; }\n")
+file(WRITE "${PROJECT_DIR}/src/answer.cppm" "export module answer;\nexport int answer() { return 42; }\n")
+file(WRITE "${PROJECT_DIR}/src/main.cpp" "#include <iostream>\nimport math;\nimport answer;\nint main() { std::cout << \"result \" << twice(square(3)) + answer() << std::endl; return 0; }\n")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE RUN_RESULT
+  OUTPUT_VARIABLE RUN_OUTPUT
+  ERROR_VARIABLE RUN_ERROR
+  TIMEOUT 120
+)
+
+string(FIND "${RUN_OUTPUT}" "result 60" RESULT_FOUND)
+if(NOT RUN_RESULT EQUAL 0 OR RESULT_FOUND EQUAL -1)
+  message(FATAL_ERROR "Build with modules failed: ${RUN_OUTPUT} ${RUN_ERROR}")
+endif()
+
+# Nothing is recompiled when nothing changed
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE NOOP_RESULT
+  OUTPUT_VARIABLE NOOP_OUTPUT
+  ERROR_VARIABLE NOOP_ERROR
+  TIMEOUT 60
+)
+
+string(FIND "${NOOP_OUTPUT}" "Compiling src/" COMPILING_FOUND)
+if(NOT NOOP_RESULT EQUAL 0 OR NOT COMPILING_FOUND EQUAL -1)
+  message(FATAL_ERROR "An up to date build with modules recompiled: ${NOOP_OUTPUT} ${NOOP_ERROR}")
+endif()
+
+# Editing a partition rebuilds its importers, but not the independent module
+file(WRITE "${PROJECT_DIR}/src/math-detail.cppm" "export module math:detail;\nexport int twice(int x) { return 3 * x; }\n")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE RERUN_RESULT
+  OUTPUT_VARIABLE RERUN_OUTPUT
+  ERROR_VARIABLE RERUN_ERROR
+  TIMEOUT 120
+)
+
+string(FIND "${RERUN_OUTPUT}" "result 69" UPDATED_FOUND)
+string(FIND "${RERUN_OUTPUT}" "Compiling src/answer.cppm" ANSWER_REBUILT)
+if(NOT RERUN_RESULT EQUAL 0 OR UPDATED_FOUND EQUAL -1 OR NOT ANSWER_REBUILT EQUAL -1)
+  message(FATAL_ERROR "Editing a module partition did not rebuild exactly its importers: ${RERUN_OUTPUT} ${RERUN_ERROR}")
+endif()
+
+# Import cycles are reported instead of being built in some order
+file(WRITE "${PROJECT_DIR}/src/answer.cppm" "export module answer;\nimport math;\nexport int answer() { return 42; }\n")
+file(WRITE "${PROJECT_DIR}/src/math.cppm" "export module math;\nexport import :detail;\nimport answer;\nexport int square(int x) { return x * x; }\n")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE CYCLE_RESULT
+  OUTPUT_VARIABLE CYCLE_OUTPUT
+  ERROR_VARIABLE CYCLE_ERROR
+  TIMEOUT 60
+)
+
+string(FIND "${CYCLE_OUTPUT}" "imports itself" CYCLE_FOUND)
+if(CYCLE_RESULT EQUAL 0 OR CYCLE_FOUND EQUAL -1)
+  message(FATAL_ERROR "An import cycle was not reported: ${CYCLE_OUTPUT} ${CYCLE_ERROR}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail modules test passed - interface units were built before their importers")
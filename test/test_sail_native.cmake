@@ -0,0 +1,92 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+# First create a new project and opt into the native engine
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[build]\nengine = \"native\"\n")
+file(WRITE "${PROJECT_DIR}/src/greeting.cpp" "const char* greeting() { return \"Hello from native\"; }\n")
+file(WRITE "${PROJECT_DIR}/src/main.cpp" "#include <iostream>\nconst char* greeting();\nint main() { std::cout << greeting() << std::endl; return 0; }\n")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE RUN_RESULT
+  OUTPUT_VARIABLE RUN_OUTPUT
+  ERROR_VARIABLE RUN_ERROR
+  TIMEOUT 60
+)
+
+string(FIND "${RUN_OUTPUT}" "Hello from native" GREETING_FOUND)
+if(GREETING_FOUND EQUAL -1)
+  message(FATAL_ERROR "sail run with the native engine failed: ${RUN_OUTPUT} ${RUN_ERROR}")
+endif()
+
+if(EXISTS "${PROJECT_DIR}/target/debug/build/CMakeCache.txt")
+  message(FATAL_ERROR "The native engine should not configure a CMake build tree")
+endif()
+
+if(NOT EXISTS "${PROJECT_DIR}/target/debug/obj/main.cpp.o" OR NOT EXISTS "${PROJECT_DIR}/target/debug/obj/main.cpp.d")
+  message(FATAL_ERROR "Object and depfile were not written to target/debug/obj")
+endif()
+
+# The compile commands are written for editors and linked from the project root
+file(READ "${PROJECT_DIR}/compile_commands.json" DATABASE)
+string(JSON DATABASE_LENGTH LENGTH "${DATABASE}")
+string(JSON DATABASE_FILE GET "${DATABASE}" 0 file)
+if(NOT DATABASE_LENGTH EQUAL 2 OR NOT DATABASE_FILE STREQUAL "${PROJECT_DIR}/src/greeting.cpp")
+  message(FATAL_ERROR "Unexpected compile_commands.json at the project root: ${DATABASE}")
+endif()
+
+# A no-op build must not compile or link anything
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE NOOP_RESULT
+  OUTPUT_VARIABLE NOOP_OUTPUT
+  ERROR_VARIABLE NOOP_ERROR
+  TIMEOUT 60
+)
+
+string(FIND "${NOOP_OUTPUT}" "Compiling src" NOOP_COMPILE_FOUND)
+string(FIND "${NOOP_OUTPUT}" "Linking" NOOP_LINK_FOUND)
+if(NOT NOOP_COMPILE_FOUND EQUAL -1 OR NOT NOOP_LINK_FOUND EQUAL -1)
+  message(FATAL_ERROR "Expected a no-op build, got: ${NOOP_OUTPUT}")
+endif()
+
+# Changing one source only recompiles that translation unit
+file(WRITE "${PROJECT_DIR}/src/greeting.cpp" "const char* greeting() { return \"Hello again\"; }\n")
+file(TOUCH_NOCREATE "${PROJECT_DIR}/src/greeting.cpp")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE REBUILD_RESULT
+  OUTPUT_VARIABLE REBUILD_OUTPUT
+  ERROR_VARIABLE REBUILD_ERROR
+  TIMEOUT 60
+)
+
+string(FIND "${REBUILD_OUTPUT}" "Compiling src/greeting.cpp" GREETING_COMPILED)
+string(FIND "${REBUILD_OUTPUT}" "Compiling src/main.cpp" MAIN_COMPILED)
+string(FIND "${REBUILD_OUTPUT}" "Hello again" NEW_GREETING_FOUND)
+if(GREETING_COMPILED EQUAL -1 OR NOT MAIN_COMPILED EQUAL -1 OR NEW_GREETING_FOUND EQUAL -1)
+  message(FATAL_ERROR "Expected only greeting.cpp to be recompiled, got: ${REBUILD_OUTPUT} ${REBUILD_ERROR}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail native engine test passed - incremental rebuild only touched the changed source")
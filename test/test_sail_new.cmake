@@ -0,0 +1,60 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+# Run sail new in the test directory
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed with result: ${NEW_RESULT}\nOutput: ${NEW_OUTPUT}\nError: ${NEW_ERROR}")
+endif()
+
+# Check if project directory was created
+set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+if(NOT EXISTS "${PROJECT_DIR}")
+  message(FATAL_ERROR "Project directory '${PROJECT_NAME}' was not created")
+endif()
+
+# Check if Sail.toml was created
+set(TOML_FILE "${PROJECT_DIR}/Sail.toml")
+if(NOT EXISTS "${TOML_FILE}")
+  message(FATAL_ERROR "Sail.toml was not created in project directory")
+endif()
+
+# Check if src directory was created
+set(SRC_DIR "${PROJECT_DIR}/src")
+if(NOT EXISTS "${SRC_DIR}")
+  message(FATAL_ERROR "src directory was not created")
+endif()
+
+# Check if main.cpp was created
+set(MAIN_CPP "${SRC_DIR}/main.cpp")
+if(NOT EXISTS "${MAIN_CPP}")
+  message(FATAL_ERROR "src/main.cpp was not created")
+endif()
+
+# Check Sail.toml content
+file(READ "${TOML_FILE}" TOML_CONTENT)
+string(FIND "${TOML_CONTENT}" "name = \"${PROJECT_NAME}\"" NAME_FOUND)
+if(NAME_FOUND EQUAL -1)
+  message(FATAL_ERROR "Sail.toml does not contain correct project name")
+endif()
+
+# Check main.cpp content
+file(READ "${MAIN_CPP}" CPP_CONTENT)
+string(FIND "${CPP_CONTENT}" "Hello, World!" HELLO_FOUND)
+if(HELLO_FOUND EQUAL -1)
+  message(FATAL_ERROR "main.cpp does not contain Hello World message")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail new test passed - project structure created successfully")
@@ -0,0 +1,70 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+foreach(ENGINE IN ITEMS cmake native)
+  set(PROJECT_NAME "pch_${ENGINE}")
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+    WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+    RESULT_VARIABLE NEW_RESULT
+    OUTPUT_VARIABLE NEW_OUTPUT
+    ERROR_VARIABLE NEW_ERROR
+    TIMEOUT 30
+  )
+
+  if(NOT NEW_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+  endif()
+
+  # A system header and a project header, both precompiled
+  set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+  file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[build]\nengine = \"${ENGINE}\"\npch = [\"<vector>\", \"src/common.hpp\"]\n")
+  file(WRITE "${PROJECT_DIR}/src/common.hpp" "#pragma once\ninline int answer() { return 42; }\n")
+  file(WRITE "${PROJECT_DIR}/src/main.cpp" "#include <iostream>\n#include <vector>\n#include \"common.hpp\"\nint main() { std::vector<int> values{ answer() }; std::cout << \"answer \" << values[0] << std::endl; return 0; }\n")
+
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" run
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE RUN_RESULT
+    OUTPUT_VARIABLE RUN_OUTPUT
+    ERROR_VARIABLE RUN_ERROR
+    TIMEOUT 120
+  )
+
+  string(FIND "${RUN_OUTPUT}" "answer 42" ANSWER_FOUND)
+  if(NOT RUN_RESULT EQUAL 0 OR ANSWER_FOUND EQUAL -1)
+    message(FATAL_ERROR "Build with precompiled headers failed with the ${ENGINE} engine: ${RUN_OUTPUT} ${RUN_ERROR}")
+  endif()
+
+  if(ENGINE STREQUAL "native")
+    file(GLOB PCH_FILES "${PROJECT_DIR}/target/debug/obj/pch/sail_pch.hpp.*ch")
+  else()
+    file(GLOB_RECURSE PCH_FILES "${PROJECT_DIR}/target/debug/build/CMakeFiles/cmake_pch.hxx")
+  endif()
+  if(NOT PCH_FILES)
+    message(FATAL_ERROR "No precompiled header was produced with the ${ENGINE} engine")
+  endif()
+endforeach()
+
+# Editing a precompiled project header rebuilds the PCH and the sources using it
+set(PROJECT_DIR "${TEST_WORKING_DIR}/pch_native")
+file(WRITE "${PROJECT_DIR}/src/common.hpp" "#pragma once\ninline int answer() { return 43; }\n")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE RERUN_RESULT
+  OUTPUT_VARIABLE RERUN_OUTPUT
+  ERROR_VARIABLE RERUN_ERROR
+  TIMEOUT 120
+)
+
+string(FIND "${RERUN_OUTPUT}" "answer 43" UPDATED_FOUND)
+if(NOT RERUN_RESULT EQUAL 0 OR UPDATED_FOUND EQUAL -1)
+  message(FATAL_ERROR "The precompiled header was not rebuilt: ${RERUN_OUTPUT} ${RERUN_ERROR}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail precompiled header test passed - both engines used [build] pch")
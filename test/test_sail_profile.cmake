@@ -0,0 +1,77 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+foreach(ENGINE IN ITEMS cmake native)
+  set(PROJECT_NAME "profile_${ENGINE}")
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+    WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+    RESULT_VARIABLE NEW_RESULT
+    OUTPUT_VARIABLE NEW_OUTPUT
+    ERROR_VARIABLE NEW_ERROR
+    TIMEOUT 30
+  )
+
+  if(NOT NEW_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+  endif()
+
+  set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+  set(EXECUTABLE "${PROJECT_DIR}/target/release/${PROJECT_NAME}${CMAKE_EXECUTABLE_SUFFIX}")
+  file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[build]\nengine = \"${ENGINE}\"\n\n[profile.release]\nlto = \"thin\"\nopt-level = 2\n")
+
+  # Using profiles before any were collected is an error
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" build --release --pgo-use
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE EARLY_RESULT
+    OUTPUT_VARIABLE EARLY_OUTPUT
+    ERROR_VARIABLE EARLY_ERROR
+    TIMEOUT 60
+  )
+
+  string(FIND "${EARLY_OUTPUT}" "no profile data" NO_DATA_FOUND)
+  if(EARLY_RESULT EQUAL 0 OR NO_DATA_FOUND EQUAL -1)
+    message(FATAL_ERROR "--pgo-use without profiles was not reported with the ${ENGINE} engine: ${EARLY_OUTPUT} ${EARLY_ERROR}")
+  endif()
+
+  # Instrumented build, training run, optimized build
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" build --release --pgo-generate
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE GENERATE_RESULT
+    OUTPUT_VARIABLE GENERATE_OUTPUT
+    ERROR_VARIABLE GENERATE_ERROR
+    TIMEOUT 120
+  )
+
+  if(NOT GENERATE_RESULT EQUAL 0)
+    message(FATAL_ERROR "Instrumented build failed with the ${ENGINE} engine: ${GENERATE_OUTPUT} ${GENERATE_ERROR}")
+  endif()
+
+  execute_process(COMMAND "${EXECUTABLE}" RESULT_VARIABLE TRAINING_RESULT TIMEOUT 30)
+  file(GLOB_RECURSE PROFILES "${PROJECT_DIR}/target/release/pgo/*.gcda" "${PROJECT_DIR}/target/release/pgo/*.profraw")
+  if(NOT TRAINING_RESULT EQUAL 0 OR NOT PROFILES)
+    message(FATAL_ERROR "The instrumented ${ENGINE} build wrote no profiles")
+  endif()
+
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" run --release --pgo-use
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE USE_RESULT
+    OUTPUT_VARIABLE USE_OUTPUT
+    ERROR_VARIABLE USE_ERROR
+    TIMEOUT 120
+  )
+
+  string(FIND "${USE_OUTPUT}" "Hello, World!" HELLO_FOUND)
+  if(NOT USE_RESULT EQUAL 0 OR HELLO_FOUND EQUAL -1)
+    message(FATAL_ERROR "Profile-guided build failed with the ${ENGINE} engine: ${USE_OUTPUT} ${USE_ERROR}")
+  endif()
+endforeach()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail profile test passed - both engines built with LTO and PGO")
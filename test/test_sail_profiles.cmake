@@ -0,0 +1,63 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+# A custom profile with the hardening flags, which every GCC and Clang build can take
+set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[profile.checked]\ninherits = \"dev\"\nhardening = true\n")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build --profile dev --profile release --profile checked
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE BUILD_RESULT
+  OUTPUT_VARIABLE BUILD_OUTPUT
+  ERROR_VARIABLE BUILD_ERROR
+  TIMEOUT 180
+)
+
+if(NOT BUILD_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail build with three profiles failed: ${BUILD_OUTPUT} ${BUILD_ERROR}")
+endif()
+
+foreach(PROFILE_DIR debug release checked)
+  if(NOT EXISTS "${PROJECT_DIR}/target/${PROFILE_DIR}/${PROJECT_NAME}" AND NOT EXISTS "${PROJECT_DIR}/target/${PROFILE_DIR}/${PROJECT_NAME}.exe")
+    message(FATAL_ERROR "No executable in target/${PROFILE_DIR}: ${BUILD_OUTPUT}")
+  endif()
+endforeach()
+
+string(FIND "${BUILD_OUTPUT}" "Finished profiles dev, release, checked" SUMMARY_FOUND)
+if(SUMMARY_FOUND EQUAL -1)
+  message(FATAL_ERROR "Expected a summary of the three builds, got: ${BUILD_OUTPUT}")
+endif()
+
+# An unknown profile fails before anything is built
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build --profile dev --profile staging
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE UNKNOWN_RESULT
+  OUTPUT_VARIABLE UNKNOWN_OUTPUT
+  ERROR_VARIABLE UNKNOWN_ERROR
+  TIMEOUT 60
+)
+
+if(UNKNOWN_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail build accepted an unknown profile: ${UNKNOWN_OUTPUT}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail profiles test passed - three profiles were built side by side")
@@ -0,0 +1,106 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+# First create a new project
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+
+# The first build has to configure the project
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE FIRST_BUILD_RESULT
+  OUTPUT_VARIABLE FIRST_BUILD_OUTPUT
+  ERROR_VARIABLE FIRST_BUILD_ERROR
+  TIMEOUT 60
+)
+
+if(NOT FIRST_BUILD_RESULT EQUAL 0)
+  message(FATAL_ERROR "first sail build failed: ${FIRST_BUILD_OUTPUT} ${FIRST_BUILD_ERROR}")
+endif()
+
+string(FIND "${FIRST_BUILD_OUTPUT}" "Configuring done" FIRST_CONFIGURE_FOUND)
+if(FIRST_CONFIGURE_FOUND EQUAL -1)
+  message(FATAL_ERROR "Expected the first build to configure, got: ${FIRST_BUILD_OUTPUT}")
+endif()
+
+if(NOT EXISTS "${PROJECT_DIR}/target/debug/configure.fingerprint")
+  message(FATAL_ERROR "Configure fingerprint was not written")
+endif()
+
+# A second build with unchanged inputs must skip the configure step
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE SECOND_BUILD_RESULT
+  OUTPUT_VARIABLE SECOND_BUILD_OUTPUT
+  ERROR_VARIABLE SECOND_BUILD_ERROR
+  TIMEOUT 60
+)
+
+if(NOT SECOND_BUILD_RESULT EQUAL 0)
+  message(FATAL_ERROR "second sail build failed: ${SECOND_BUILD_OUTPUT} ${SECOND_BUILD_ERROR}")
+endif()
+
+string(FIND "${SECOND_BUILD_OUTPUT}" "Configuring done" SECOND_CONFIGURE_FOUND)
+if(NOT SECOND_CONFIGURE_FOUND EQUAL -1)
+  message(FATAL_ERROR "Expected the second build to skip configure, got: ${SECOND_BUILD_OUTPUT}")
+endif()
+
+# Changing Sail.toml must trigger a new configure
+file(APPEND "${PROJECT_DIR}/Sail.toml" "\n# touched\n")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE THIRD_BUILD_RESULT
+  OUTPUT_VARIABLE THIRD_BUILD_OUTPUT
+  ERROR_VARIABLE THIRD_BUILD_ERROR
+  TIMEOUT 60
+)
+
+if(NOT THIRD_BUILD_RESULT EQUAL 0)
+  message(FATAL_ERROR "third sail build failed: ${THIRD_BUILD_OUTPUT} ${THIRD_BUILD_ERROR}")
+endif()
+
+string(FIND "${THIRD_BUILD_OUTPUT}" "Configuring done" THIRD_CONFIGURE_FOUND)
+if(THIRD_CONFIGURE_FOUND EQUAL -1)
+  message(FATAL_ERROR "Expected a changed Sail.toml to reconfigure, got: ${THIRD_BUILD_OUTPUT}")
+endif()
+
+# Another compiler first on PATH must trigger a new configure too, even with CC and CXX unset
+find_program(REAL_CXX NAMES c++ g++ clang++)
+if(NOT WIN32 AND REAL_CXX AND "$ENV{CXX}" STREQUAL "")
+  file(WRITE "${TEST_WORKING_DIR}/compiler/c++" "#!/bin/sh\nexec \"${REAL_CXX}\" \"$@\"\n")
+  file(CHMOD "${TEST_WORKING_DIR}/compiler/c++" PERMISSIONS OWNER_READ OWNER_WRITE OWNER_EXECUTE)
+  set(ENV{PATH} "${TEST_WORKING_DIR}/compiler:$ENV{PATH}")
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" build
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE FOURTH_BUILD_RESULT
+    OUTPUT_VARIABLE FOURTH_BUILD_OUTPUT
+    ERROR_VARIABLE FOURTH_BUILD_ERROR
+    TIMEOUT 60
+  )
+  string(FIND "${FOURTH_BUILD_OUTPUT}" "Configuring done" FOURTH_CONFIGURE_FOUND)
+  if(NOT FOURTH_BUILD_RESULT EQUAL 0 OR FOURTH_CONFIGURE_FOUND EQUAL -1)
+    message(FATAL_ERROR "Expected a compiler change on PATH to reconfigure, got: ${FOURTH_BUILD_OUTPUT} ${FOURTH_BUILD_ERROR}")
+  endif()
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail build reconfigure test passed - configure skipped when inputs are unchanged")
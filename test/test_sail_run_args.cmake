@@ -0,0 +1,46 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+# The program echoes its arguments in brackets and exits with a code of its own
+set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[build]\nengine = \"native\"\n")
+file(WRITE "${PROJECT_DIR}/src/main.cpp" "#include <cstdio>\nint main(int argc, char** argv) { for (int i = 1; i < argc; ++i) { std::printf(\"[%s]\", argv[i]); } std::printf(\"\\n\"); return 3; }\n")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run -- "two words" --release "\$HOME" "a;b"
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE RUN_RESULT
+  OUTPUT_VARIABLE RUN_OUTPUT
+  ERROR_VARIABLE RUN_ERROR
+  TIMEOUT 60
+)
+
+if(NOT RUN_RESULT EQUAL 3)
+  message(FATAL_ERROR "Expected the program's exit code 3, got ${RUN_RESULT}: ${RUN_OUTPUT} ${RUN_ERROR}")
+endif()
+string(FIND "${RUN_OUTPUT}" "[two words][--release][\$HOME][a;b]" ARGS_FOUND)
+if(ARGS_FOUND EQUAL -1)
+  message(FATAL_ERROR "Arguments were not forwarded as given: ${RUN_OUTPUT}")
+endif()
+if(EXISTS "${PROJECT_DIR}/target/release")
+  message(FATAL_ERROR "--release after -- was taken by sail instead of the program")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail run argument test passed - arguments and exit code went through unchanged")
@@ -0,0 +1,66 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+# First create a new project
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE FIRST_BUILD_RESULT
+  OUTPUT_VARIABLE FIRST_BUILD_OUTPUT
+  ERROR_VARIABLE FIRST_BUILD_ERROR
+  TIMEOUT 60
+)
+
+if(NOT FIRST_BUILD_RESULT EQUAL 0)
+  message(FATAL_ERROR "first sail build failed: ${FIRST_BUILD_OUTPUT} ${FIRST_BUILD_ERROR}")
+endif()
+
+set(SOURCES_FILE "${PROJECT_DIR}/target/debug/sources.cmake")
+if(NOT EXISTS "${SOURCES_FILE}")
+  message(FATAL_ERROR "Source manifest was not written to ${SOURCES_FILE}")
+endif()
+
+# Add a translation unit that main.cpp now depends on; linking fails unless it is picked up
+file(WRITE "${PROJECT_DIR}/src/greeting.cpp" "const char* greeting() { return \"Hello from a new file\"; }\n")
+file(WRITE "${PROJECT_DIR}/src/main.cpp" "#include <iostream>\nconst char* greeting();\nint main() { std::cout << greeting() << std::endl; return 0; }\n")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" run
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE RUN_RESULT
+  OUTPUT_VARIABLE RUN_OUTPUT
+  ERROR_VARIABLE RUN_ERROR
+  TIMEOUT 60
+)
+
+string(FIND "${RUN_OUTPUT}" "Hello from a new file" GREETING_FOUND)
+if(GREETING_FOUND EQUAL -1)
+  message(FATAL_ERROR "Expected the new source to be built, got: ${RUN_OUTPUT} ${RUN_ERROR}")
+endif()
+
+file(READ "${SOURCES_FILE}" SOURCES_CONTENT)
+string(FIND "${SOURCES_CONTENT}" "src/greeting.cpp" MANIFEST_ENTRY_FOUND)
+if(MANIFEST_ENTRY_FOUND EQUAL -1)
+  message(FATAL_ERROR "Source manifest does not list the new file: ${SOURCES_CONTENT}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail source manifest test passed - new sources were built")
@@ -0,0 +1,83 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+  WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+  RESULT_VARIABLE NEW_RESULT
+  OUTPUT_VARIABLE NEW_OUTPUT
+  ERROR_VARIABLE NEW_ERROR
+  TIMEOUT 30
+)
+
+if(NOT NEW_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+endif()
+
+# Both tests use the project's add(); fails_without_args only passes when given an argument
+set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[build]\nengine = \"native\"\n")
+file(WRITE "${PROJECT_DIR}/src/add.hpp" "int add(int a, int b);\n")
+file(WRITE "${PROJECT_DIR}/src/add.cpp" "#include \"add.hpp\"\nint add(int a, int b) { return a + b; }\n")
+file(WRITE "${PROJECT_DIR}/tests/adds.cpp" "#include \"add.hpp\"\nint main() { return add(2, 2) == 4 ? 0 : 1; }\n")
+file(WRITE "${PROJECT_DIR}/tests/fails_without_args.cpp" "#include \"add.hpp\"\n#include <cstdio>\nint main(int argc, char**) { std::puts(\"no arguments given\"); return argc > 1 ? 0 : add(0, 1); }\n")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" test -j 2
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE TEST_RESULT
+  OUTPUT_VARIABLE TEST_OUTPUT
+  ERROR_VARIABLE TEST_ERROR
+  TIMEOUT 120
+)
+
+if(TEST_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail test passed although a test failed: ${TEST_OUTPUT} ${TEST_ERROR}")
+endif()
+foreach(EXPECTED "test adds ... ok" "test fails_without_args ... FAILED" "no arguments given" "1 passed; 1 failed")
+  string(FIND "${TEST_OUTPUT}" "${EXPECTED}" EXPECTED_FOUND)
+  if(EXPECTED_FOUND EQUAL -1)
+    message(FATAL_ERROR "Expected '${EXPECTED}' in the output: ${TEST_OUTPUT}")
+  endif()
+endforeach()
+if(NOT EXISTS "${PROJECT_DIR}/target/debug/test-durations.txt")
+  message(FATAL_ERROR "sail test did not record the test durations")
+endif()
+
+# Arguments after -- reach every test
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" test -- pass
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE ARGS_RESULT
+  OUTPUT_VARIABLE ARGS_OUTPUT
+  ERROR_VARIABLE ARGS_ERROR
+  TIMEOUT 120
+)
+
+if(NOT ARGS_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail test -- pass failed: ${ARGS_OUTPUT} ${ARGS_ERROR}")
+endif()
+
+# The first of two shards gets the first test in name order
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" test --shard 1/2
+  WORKING_DIRECTORY "${PROJECT_DIR}"
+  RESULT_VARIABLE SHARD_RESULT
+  OUTPUT_VARIABLE SHARD_OUTPUT
+  ERROR_VARIABLE SHARD_ERROR
+  TIMEOUT 120
+)
+
+if(NOT SHARD_RESULT EQUAL 0)
+  message(FATAL_ERROR "sail test --shard 1/2 failed: ${SHARD_OUTPUT} ${SHARD_ERROR}")
+endif()
+string(FIND "${SHARD_OUTPUT}" "fails_without_args" OTHER_SHARD_FOUND)
+if(NOT OTHER_SHARD_FOUND EQUAL -1)
+  message(FATAL_ERROR "Shard 1/2 ran a test of shard 2/2: ${SHARD_OUTPUT}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail test test passed - tests ran in parallel, with arguments and in shards")
@@ -0,0 +1,61 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}")
+
+foreach(ENGINE IN ITEMS cmake native)
+  set(PROJECT_NAME "unity_${ENGINE}")
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" new "${PROJECT_NAME}"
+    WORKING_DIRECTORY "${TEST_WORKING_DIR}"
+    RESULT_VARIABLE NEW_RESULT
+    OUTPUT_VARIABLE NEW_OUTPUT
+    ERROR_VARIABLE NEW_ERROR
+    TIMEOUT 30
+  )
+
+  if(NOT NEW_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+  endif()
+
+  # Five sources in batches of two make three unity translation units
+  set(PROJECT_DIR "${TEST_WORKING_DIR}/${PROJECT_NAME}")
+  file(APPEND "${PROJECT_DIR}/Sail.toml" "\n[build]\nengine = \"${ENGINE}\"\nunity = true\nunity-batch-size = 2\n")
+  set(MAIN_CONTENT "#include <iostream>\n")
+  set(SUM_EXPRESSION "0")
+  foreach(INDEX RANGE 1 4)
+    file(WRITE "${PROJECT_DIR}/src/part${INDEX}.cpp" "int part${INDEX}() { return ${INDEX}; }\n")
+    string(APPEND MAIN_CONTENT "int part${INDEX}();\n")
+    string(APPEND SUM_EXPRESSION " + part${INDEX}()")
+  endforeach()
+  string(APPEND MAIN_CONTENT "int main() { std::cout << \"sum \" << (${SUM_EXPRESSION}) << std::endl; return 0; }\n")
+  file(WRITE "${PROJECT_DIR}/src/main.cpp" "${MAIN_CONTENT}")
+
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" run
+    WORKING_DIRECTORY "${PROJECT_DIR}"
+    RESULT_VARIABLE RUN_RESULT
+    OUTPUT_VARIABLE RUN_OUTPUT
+    ERROR_VARIABLE RUN_ERROR
+    TIMEOUT 120
+  )
+
+  string(FIND "${RUN_OUTPUT}" "sum 10" SUM_FOUND)
+  if(NOT RUN_RESULT EQUAL 0 OR SUM_FOUND EQUAL -1)
+    message(FATAL_ERROR "Unity build with the ${ENGINE} engine failed: ${RUN_OUTPUT} ${RUN_ERROR}")
+  endif()
+
+  if(ENGINE STREQUAL "native")
+    file(GLOB UNITY_SOURCES "${PROJECT_DIR}/target/debug/obj/unity/unity_*.cpp")
+  else()
+    file(GLOB_RECURSE UNITY_SOURCES "${PROJECT_DIR}/target/debug/build/CMakeFiles/unity_*.cxx")
+  endif()
+  list(LENGTH UNITY_SOURCES UNITY_COUNT)
+  if(NOT UNITY_COUNT EQUAL 3)
+    message(FATAL_ERROR "Expected 3 unity sources with the ${ENGINE} engine, found: ${UNITY_SOURCES}")
+  endif()
+endforeach()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail unity build test passed - both engines batched the sources")
@@ -0,0 +1,94 @@
+
+# Create a temporary directory for testing
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+file(MAKE_DIRECTORY "${TEST_WORKING_DIR}/apps")
+set(WORKSPACE_DIR "${TEST_WORKING_DIR}")
+file(WRITE "${WORKSPACE_DIR}/Sail.toml" "[workspace]\nmembers = [\"apps/*\", \"greet\"]\n")
+
+# A library member with its own CMakeLists.txt
+file(WRITE "${WORKSPACE_DIR}/greet/Sail.toml" "[project]\nname = \"greet\"\nversion = \"0.1.0\"\n")
+file(WRITE "${WORKSPACE_DIR}/greet/CMakeLists.txt" "cmake_minimum_required(VERSION 3.21)\nproject(greet LANGUAGES CXX)\nadd_library(greet src/greet.cpp)\ntarget_include_directories(greet PUBLIC include)\n")
+file(WRITE "${WORKSPACE_DIR}/greet/include/greet.hpp" "#pragma once\nconst char* greeting();\n")
+file(WRITE "${WORKSPACE_DIR}/greet/src/greet.cpp" "#include \"greet.hpp\"\nconst char* greeting() { return \"Hello from greet\"; }\n")
+
+# A path dependency outside the workspace used by two members, which must be added only once
+file(WRITE "${WORKSPACE_DIR}/common/CMakeLists.txt" "cmake_minimum_required(VERSION 3.21)\nproject(common LANGUAGES CXX)\nadd_library(common INTERFACE)\ntarget_include_directories(common INTERFACE include)\n")
+file(WRITE "${WORKSPACE_DIR}/common/include/common.hpp" "#pragma once\ninline int common_value() { return 7; }\n")
+
+foreach(MEMBER IN ITEMS app tool)
+  execute_process(
+    COMMAND "${SAIL_EXECUTABLE}" new ${MEMBER}
+    WORKING_DIRECTORY "${WORKSPACE_DIR}/apps"
+    RESULT_VARIABLE NEW_RESULT
+    OUTPUT_VARIABLE NEW_OUTPUT
+    ERROR_VARIABLE NEW_ERROR
+    TIMEOUT 30
+  )
+
+  if(NOT NEW_RESULT EQUAL 0)
+    message(FATAL_ERROR "sail new failed: ${NEW_OUTPUT} ${NEW_ERROR}")
+  endif()
+  file(APPEND "${WORKSPACE_DIR}/apps/${MEMBER}/Sail.toml" "common = { path = \"../../common\" }\n")
+endforeach()
+file(APPEND "${WORKSPACE_DIR}/apps/app/Sail.toml" "greet = { path = \"../../greet\" }\n")
+file(WRITE "${WORKSPACE_DIR}/apps/app/src/main.cpp" "#include <iostream>\n#include \"common.hpp\"\n#include \"greet.hpp\"\nint main() { std::cout << greeting() << ' ' << common_value() << std::endl; return 0; }\n")
+
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${WORKSPACE_DIR}"
+  RESULT_VARIABLE BUILD_RESULT
+  OUTPUT_VARIABLE BUILD_OUTPUT
+  ERROR_VARIABLE BUILD_ERROR
+  TIMEOUT 180
+)
+
+if(NOT BUILD_RESULT EQUAL 0)
+  message(FATAL_ERROR "Workspace build failed: ${BUILD_OUTPUT} ${BUILD_ERROR}")
+endif()
+
+# Both executables come out of the one build tree at the workspace root
+execute_process(
+  COMMAND "${WORKSPACE_DIR}/target/debug/app${CMAKE_EXECUTABLE_SUFFIX}"
+  RESULT_VARIABLE APP_RESULT
+  OUTPUT_VARIABLE APP_OUTPUT
+  TIMEOUT 30
+)
+string(FIND "${APP_OUTPUT}" "Hello from greet 7" APP_FOUND)
+if(NOT APP_RESULT EQUAL 0 OR APP_FOUND EQUAL -1)
+  message(FATAL_ERROR "The app member did not link the greet member: ${APP_OUTPUT}")
+endif()
+if(NOT EXISTS "${WORKSPACE_DIR}/target/debug/tool${CMAKE_EXECUTABLE_SUFFIX}")
+  message(FATAL_ERROR "The tool member was not built")
+endif()
+if(EXISTS "${WORKSPACE_DIR}/apps/app/target/debug/build" OR EXISTS "${WORKSPACE_DIR}/apps/tool/target/debug/build")
+  message(FATAL_ERROR "Members got build trees of their own")
+endif()
+
+file(READ "${WORKSPACE_DIR}/target/debug/dependencies.cmake" SHARED_DEPENDENCIES)
+string(REGEX MATCHALL "add_subdirectory" ADDED "${SHARED_DEPENDENCIES}")
+list(LENGTH ADDED ADDED_COUNT)
+if(NOT ADDED_COUNT EQUAL 1)
+  message(FATAL_ERROR "The shared dependency was added ${ADDED_COUNT} times: ${SHARED_DEPENDENCIES}")
+endif()
+
+# Members must agree on what a dependency is
+file(READ "${WORKSPACE_DIR}/apps/tool/Sail.toml" TOOL_MANIFEST)
+string(REPLACE "common\" }" "common\", targets = [\"common\"] }" TOOL_MANIFEST "${TOOL_MANIFEST}")
+file(WRITE "${WORKSPACE_DIR}/apps/tool/Sail.toml" "${TOOL_MANIFEST}")
+execute_process(
+  COMMAND "${SAIL_EXECUTABLE}" build
+  WORKING_DIRECTORY "${WORKSPACE_DIR}"
+  RESULT_VARIABLE CONFLICT_RESULT
+  OUTPUT_VARIABLE CONFLICT_OUTPUT
+  ERROR_VARIABLE CONFLICT_ERROR
+  TIMEOUT 60
+)
+
+string(FIND "${CONFLICT_OUTPUT}" "differently" CONFLICT_FOUND)
+if(CONFLICT_RESULT EQUAL 0 OR CONFLICT_FOUND EQUAL -1)
+  message(FATAL_ERROR "Conflicting dependencies of two members were not reported: ${CONFLICT_OUTPUT} ${CONFLICT_ERROR}")
+endif()
+
+# Clean up
+file(REMOVE_RECURSE "${TEST_WORKING_DIR}")
+message(STATUS "sail workspace test passed - members were built in one tree")
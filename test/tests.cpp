@@ -1,5 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 
+#include <cstdint>
+#include <vector>
+
 
 #include <sail/sample_library.hpp>
 
@@ -12,3 +15,23 @@ TEST_CASE("Factorials are computed", "[factorial]")
   REQUIRE(factorial(3) == 6);
   REQUIRE(factorial(10) == 3628800);
 }
+
+TEST_CASE("Factorials that do not fit are reported as 0", "[factorial]")
+{
+  REQUIRE(factorial(12) == 479001600);
+  REQUIRE(factorial(13) == 0);
+  REQUIRE(factorial(-1) == 0);
+}
+
+TEST_CASE("Factorials are computed in batches", "[factorial]")
+{
+  const std::vector<int> inputs{ 0, 5, 20, 21, -3, 12, 1000 };
+  std::vector<std::uint64_t> results(inputs.size(), 42);
+  factorial(inputs, results);
+  REQUIRE(results == std::vector<std::uint64_t>{ 1, 120, 2432902008176640000ULL, 0, 0, 479001600, 0 });
+
+  // Only as many results as there is room for
+  std::vector<std::uint64_t> shorter(2, 42);
+  factorial(inputs, shorter);
+  REQUIRE(shorter == std::vector<std::uint64_t>{ 1, 120 });
+}
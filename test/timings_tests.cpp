@@ -0,0 +1,78 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "timings.hpp"
+
+
+namespace {
+
+std::filesystem::path make_test_dir(const char* name)
+{
+  const std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  return directory;
+}
+
+}// namespace
+
+TEST_CASE("Only the jobs of the current build are read from the Ninja log", "[timings]")
+{
+  const std::filesystem::path build_dir = make_test_dir("sail_timings_ninja_test");
+  const std::string previous_build = "# ninja log v5\n0\t900\t0\tCMakeFiles/app.dir/src/old.cpp.o\t1\n";
+  {
+    std::ofstream log(build_dir / ".ninja_log", std::ios::binary);
+    log << previous_build
+        << "0\t10\t0\tbuild.ninja\t2\n"
+        << "10\t400\t0\tCMakeFiles/app.dir/src/main.cpp.o\t3\n"
+        << "10\t250\t0\tCMakeFiles/app.dir/src/util.cpp.o\t4\n"
+        << "400\t450\t0\tapp\t5\n";
+  }
+
+  BuildTimings timings;
+  REQUIRE(timings.import_ninja_log(build_dir, previous_build.size(), BuildTimings::Clock::now()));
+
+  const auto spans = timings.spans();
+  REQUIRE(spans.size() == 3);
+  REQUIRE(spans[0].category == "compile");
+  REQUIRE(spans[1].category == "compile");
+  REQUIRE(spans[0].lane != spans[1].lane);
+  REQUIRE(spans[2].name == "app");
+  REQUIRE(spans[2].category == "link");
+  REQUIRE(std::chrono::duration_cast<std::chrono::milliseconds>(spans[2].duration).count() == 50);
+
+  bool found_main = false;
+  for (const auto& span : spans) {
+    found_main = found_main || span.name == "src/main.cpp";
+    REQUIRE(span.name != "src/old.cpp");
+  }
+  REQUIRE(found_main);
+}
+
+TEST_CASE("Builds without a Ninja log are reported", "[timings]")
+{
+  BuildTimings timings;
+  REQUIRE_FALSE(timings.import_ninja_log(make_test_dir("sail_timings_no_log_test"), 0, BuildTimings::Clock::now()));
+}
+
+TEST_CASE("Chrome traces contain every span", "[timings]")
+{
+  const std::filesystem::path directory = make_test_dir("sail_timings_trace_test");
+  BuildTimings timings;
+  const auto start = BuildTimings::Clock::now();
+  timings.record("configure", "phase", start, start + std::chrono::milliseconds(5));
+  timings.record("src/\"quoted\".cpp", "compile", start, start + std::chrono::milliseconds(2), 1);
+  timings.write_chrome_trace(directory / "trace.json");
+
+  std::ifstream trace_file(directory / "trace.json");
+  const std::string trace((std::istreambuf_iterator<char>(trace_file)), std::istreambuf_iterator<char>());
+  REQUIRE(trace.find("\"traceEvents\"") != std::string::npos);
+  REQUIRE(trace.find("\"name\":\"configure\"") != std::string::npos);
+  REQUIRE(trace.find("\"dur\":5000") != std::string::npos);
+  REQUIRE(trace.find("src/\\\"quoted\\\".cpp") != std::string::npos);
+}